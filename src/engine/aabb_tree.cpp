@@ -0,0 +1,231 @@
+// Dynamic AABB tree (insertion by perimeter heuristic, AVL balancing)
+#include "aabb_tree.h"
+
+#include <algorithm>
+
+namespace collision {
+
+Aabb Aabb::merge(const Aabb &a, const Aabb &b)
+{
+    return Aabb{std::min(a.x0, b.x0), std::min(a.y0, b.y0), std::max(a.x1, b.x1), std::max(a.y1, b.y1)};
+}
+
+AabbTree::AabbTree(double margin) : margin_(margin) {}
+
+void AabbTree::clear()
+{
+    nodes_.clear();
+    root_ = -1;
+    freeList_ = -1;
+}
+
+int AabbTree::allocateNode()
+{
+    if (freeList_ < 0)
+    {
+        nodes_.push_back(Node{});
+        freeList_ = static_cast<int>(nodes_.size()) - 1;
+        nodes_[freeList_].parent = -1;
+    }
+    const int id = freeList_;
+    freeList_ = nodes_[id].parent; // free nodes chain through parent
+    Node &n = nodes_[id];
+    n.parent = n.left = n.right = -1;
+    n.height = 0;
+    n.userData = 0;
+    return id;
+}
+
+void AabbTree::freeNode(int id)
+{
+    nodes_[id].parent = freeList_;
+    nodes_[id].height = -1;
+    freeList_ = id;
+}
+
+Aabb AabbTree::fatten(const Aabb &tight, double dx, double dy) const
+{
+    Aabb fat{tight.x0 - margin_, tight.y0 - margin_, tight.x1 + margin_, tight.y1 + margin_};
+    // Predict a few ticks ahead along the motion
+    const double ahead = 2.0;
+    if (dx < 0.0) fat.x0 += ahead * dx;
+    else fat.x1 += ahead * dx;
+    if (dy < 0.0) fat.y0 += ahead * dy;
+    else fat.y1 += ahead * dy;
+    return fat;
+}
+
+int AabbTree::createProxy(const Aabb &tight, std::uint32_t userData)
+{
+    const int id = allocateNode();
+    nodes_[id].box = fatten(tight, 0.0, 0.0);
+    nodes_[id].userData = userData;
+    insertLeaf(id);
+    return id;
+}
+
+void AabbTree::destroyProxy(int proxy)
+{
+    removeLeaf(proxy);
+    freeNode(proxy);
+}
+
+bool AabbTree::moveProxy(int proxy, const Aabb &tight, double dx, double dy)
+{
+    if (nodes_[proxy].box.contains(tight)) return false;
+    removeLeaf(proxy);
+    nodes_[proxy].box = fatten(tight, dx, dy);
+    insertLeaf(proxy);
+    ++reinserts_;
+    return true;
+}
+
+void AabbTree::insertLeaf(int leaf)
+{
+    if (root_ < 0)
+    {
+        root_ = leaf;
+        nodes_[leaf].parent = -1;
+        return;
+    }
+
+    // Walk down choosing the child whose enlargement costs least
+    const Aabb box = nodes_[leaf].box;
+    int index = root_;
+    while (nodes_[index].left >= 0)
+    {
+        const Node &n = nodes_[index];
+        const double area = n.box.perimeter();
+        const double combined = Aabb::merge(n.box, box).perimeter();
+        const double cost = 2.0 * combined;
+        const double inherit = 2.0 * (combined - area);
+
+        auto descendCost = [&](int child) {
+            const Aabb merged = Aabb::merge(box, nodes_[child].box);
+            if (nodes_[child].left < 0) return merged.perimeter() + inherit;
+            return merged.perimeter() - nodes_[child].box.perimeter() + inherit;
+        };
+        const double costLeft = descendCost(n.left);
+        const double costRight = descendCost(n.right);
+
+        if (cost < costLeft && cost < costRight) break;
+        index = costLeft < costRight ? n.left : n.right;
+    }
+
+    // New parent joins the sibling and the leaf
+    const int sibling = index;
+    const int oldParent = nodes_[sibling].parent;
+    const int newParent = allocateNode();
+    nodes_[newParent].parent = oldParent;
+    nodes_[newParent].box = Aabb::merge(box, nodes_[sibling].box);
+    nodes_[newParent].height = nodes_[sibling].height + 1;
+    nodes_[newParent].left = sibling;
+    nodes_[newParent].right = leaf;
+    nodes_[sibling].parent = newParent;
+    nodes_[leaf].parent = newParent;
+    if (oldParent < 0)
+        root_ = newParent;
+    else if (nodes_[oldParent].left == sibling)
+        nodes_[oldParent].left = newParent;
+    else
+        nodes_[oldParent].right = newParent;
+
+    // Refit and rebalance up to the root
+    for (index = nodes_[leaf].parent; index >= 0; index = nodes_[index].parent)
+    {
+        index = balance(index);
+        const Node &n = nodes_[index];
+        nodes_[index].height = 1 + std::max(nodes_[n.left].height, nodes_[n.right].height);
+        nodes_[index].box = Aabb::merge(nodes_[n.left].box, nodes_[n.right].box);
+    }
+}
+
+void AabbTree::removeLeaf(int leaf)
+{
+    if (leaf == root_)
+    {
+        root_ = -1;
+        return;
+    }
+
+    const int parent = nodes_[leaf].parent;
+    const int grandParent = nodes_[parent].parent;
+    const int sibling = nodes_[parent].left == leaf ? nodes_[parent].right : nodes_[parent].left;
+
+    if (grandParent < 0)
+    {
+        root_ = sibling;
+        nodes_[sibling].parent = -1;
+        freeNode(parent);
+        return;
+    }
+
+    if (nodes_[grandParent].left == parent)
+        nodes_[grandParent].left = sibling;
+    else
+        nodes_[grandParent].right = sibling;
+    nodes_[sibling].parent = grandParent;
+    freeNode(parent);
+
+    for (int index = grandParent; index >= 0; index = nodes_[index].parent)
+    {
+        index = balance(index);
+        const Node &n = nodes_[index];
+        nodes_[index].height = 1 + std::max(nodes_[n.left].height, nodes_[n.right].height);
+        nodes_[index].box = Aabb::merge(nodes_[n.left].box, nodes_[n.right].box);
+    }
+}
+
+// Rotate the taller grandchild up when a's children differ in height by more than one
+int AabbTree::balance(int a)
+{
+    Node &A = nodes_[a];
+    if (A.left < 0 || A.height < 2) return a;
+
+    const int b = A.left;
+    const int c = A.right;
+    const int diff = nodes_[c].height - nodes_[b].height;
+
+    auto rotate = [&](int up, int down, bool upIsRight) {
+        // up is a's child being promoted; down is a's other child
+        Node &U = nodes_[up];
+        const int f = U.left;
+        const int g = U.right;
+
+        U.left = a;
+        U.parent = nodes_[a].parent;
+        nodes_[a].parent = up;
+        if (U.parent >= 0)
+        {
+            if (nodes_[U.parent].left == a)
+                nodes_[U.parent].left = up;
+            else
+                nodes_[U.parent].right = up;
+        }
+        else
+            root_ = up;
+
+        // The taller grandchild stays under up; the shorter one moves to a
+        const bool fTaller = nodes_[f].height > nodes_[g].height;
+        const int keep = fTaller ? f : g;
+        const int give = fTaller ? g : f;
+        U.right = keep;
+        if (upIsRight)
+            nodes_[a].right = give;
+        else
+            nodes_[a].left = give;
+        nodes_[give].parent = a;
+
+        nodes_[a].box = Aabb::merge(nodes_[down].box, nodes_[give].box);
+        nodes_[a].height = 1 + std::max(nodes_[down].height, nodes_[give].height);
+        U.box = Aabb::merge(nodes_[a].box, nodes_[keep].box);
+        U.height = 1 + std::max(nodes_[a].height, nodes_[keep].height);
+        return up;
+    };
+
+    if (diff > 1) return rotate(c, b, true);
+    if (diff < -1) return rotate(b, c, false);
+    return a;
+}
+
+} // namespace collision
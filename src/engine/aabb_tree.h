@@ -0,0 +1,103 @@
+// Incrementally updated bounding volume hierarchy of fattened boxes
+#ifndef AABB_TREE_H
+#define AABB_TREE_H
+
+#include <cstdint>
+#include <vector>
+
+namespace collision {
+
+struct Aabb
+{
+    double x0, y0, x1, y1;
+
+    bool overlaps(const Aabb &o) const { return x0 < o.x1 && x1 > o.x0 && y0 < o.y1 && y1 > o.y0; }
+    bool contains(const Aabb &o) const { return x0 <= o.x0 && y0 <= o.y0 && x1 >= o.x1 && y1 >= o.y1; }
+    double perimeter() const { return 2.0 * ((x1 - x0) + (y1 - y0)); }
+    static Aabb merge(const Aabb &a, const Aabb &b);
+};
+
+// Leaves hold boxes grown by a margin, so small moves stay inside the stored box and cost nothing.
+// Insertion picks the sibling by perimeter cost and AVL rotations keep the tree balanced.
+class AabbTree
+{
+public:
+    explicit AabbTree(double margin);
+
+    int createProxy(const Aabb &tight, std::uint32_t userData);
+    void destroyProxy(int proxy);
+    // Reinserts only when tight leaves the stored box; the new box is grown along (dx, dy) as
+    // well so a body keeping its velocity stays inside for several ticks. Returns true on reinsert.
+    bool moveProxy(int proxy, const Aabb &tight, double dx = 0.0, double dy = 0.0);
+    void clear();
+
+    const Aabb &getFatAabb(int proxy) const { return nodes_[proxy].box; }
+    std::uint32_t getUserData(int proxy) const { return nodes_[proxy].userData; }
+    int getHeight() const { return root_ < 0 ? 0 : nodes_[root_].height; }
+    std::uint64_t getReinsertCount() const { return reinserts_; }
+
+    // Call fn(proxy) for every leaf whose stored box overlaps box; thread-safe against other queries
+    template <typename Fn>
+    void query(const Aabb &box, Fn &&fn) const
+    {
+        if (root_ < 0) return;
+        int stackBuffer[64];
+        std::vector<int> overflow;
+        int top = 0;
+        stackBuffer[top++] = root_;
+        while (top > 0 || !overflow.empty())
+        {
+            int id;
+            if (!overflow.empty())
+            {
+                id = overflow.back();
+                overflow.pop_back();
+            }
+            else
+                id = stackBuffer[--top];
+
+            const Node &n = nodes_[id];
+            if (!n.box.overlaps(box)) continue;
+            if (n.left < 0)
+            {
+                fn(id);
+                continue;
+            }
+            for (int child : {n.left, n.right})
+            {
+                if (top < 64)
+                    stackBuffer[top++] = child;
+                else
+                    overflow.push_back(child);
+            }
+        }
+    }
+
+private:
+    struct Node
+    {
+        Aabb box;
+        int parent;
+        int left;  // -1 for leaves
+        int right;
+        int height; // 0 for leaves, -1 for free nodes
+        std::uint32_t userData;
+    };
+
+    int allocateNode();
+    void freeNode(int id);
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    int balance(int a);
+    Aabb fatten(const Aabb &tight, double dx, double dy) const;
+
+    std::vector<Node> nodes_;
+    int root_ = -1;
+    int freeList_ = -1;
+    double margin_;
+    std::uint64_t reinserts_ = 0;
+};
+
+} // namespace collision
+
+#endif
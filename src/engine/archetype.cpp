@@ -0,0 +1,76 @@
+// Archetype registry implementation
+#include "archetype.h"
+
+#include "entity.h"
+
+namespace ecs {
+
+void ArchetypeRegistry::clear()
+{
+    tables_.clear();
+    locations_.clear();
+}
+
+void ArchetypeRegistry::sync(const std::vector<Entity> &entities)
+{
+    if (entities.size() < locations_.size())
+    {
+        clear();
+    }
+
+    // Existing entities: only move the ones whose components changed
+    const std::uint32_t known = static_cast<std::uint32_t>(locations_.size());
+    for (std::uint32_t i = 0; i < known; ++i)
+    {
+        const Signature sig = entities[i].getComponents();
+        if (sig != locations_[i].signature)
+        {
+            remove(i);
+            insert(i, sig);
+        }
+    }
+
+    append(entities);
+}
+
+void ArchetypeRegistry::append(const std::vector<Entity> &entities)
+{
+    locations_.reserve(entities.size());
+    for (std::uint32_t i = static_cast<std::uint32_t>(locations_.size()); i < entities.size(); ++i)
+    {
+        locations_.push_back(Location{0, 0, 0});
+        insert(i, entities[i].getComponents());
+    }
+}
+
+std::uint32_t ArchetypeRegistry::tableFor(Signature sig)
+{
+    for (std::uint32_t t = 0; t < tables_.size(); ++t)
+    {
+        if (tables_[t].signature == sig)
+            return t;
+    }
+    tables_.push_back(ArchetypeTable{sig, {}});
+    return static_cast<std::uint32_t>(tables_.size() - 1);
+}
+
+void ArchetypeRegistry::insert(std::uint32_t entity, Signature sig)
+{
+    const std::uint32_t t = tableFor(sig);
+    std::vector<std::uint32_t> &rows = tables_[t].rows;
+    locations_[entity] = Location{sig, t, static_cast<std::uint32_t>(rows.size())};
+    rows.push_back(entity);
+}
+
+void ArchetypeRegistry::remove(std::uint32_t entity)
+{
+    // Swap-remove keeps tables dense; patch the moved row's slot
+    const Location loc = locations_[entity];
+    std::vector<std::uint32_t> &rows = tables_[loc.table].rows;
+    const std::uint32_t last = rows.back();
+    rows[loc.slot] = last;
+    locations_[last].slot = loc.slot;
+    rows.pop_back();
+}
+
+} // namespace ecs
@@ -0,0 +1,98 @@
+// Archetype tables grouping entities by their role components
+#ifndef ARCHETYPE_H
+#define ARCHETYPE_H
+
+#include <cstdint>
+#include <vector>
+
+class Entity;
+
+namespace ecs {
+
+using Signature = std::uint32_t;
+
+// Role components; an entity's signature is the OR of the components it carries
+enum Component : Signature
+{
+    Movable = 1u << 0,
+    Controllable = 1u << 1,
+    Gravity = 1u << 2,
+    Enemy = 1u << 3,
+    Platform = 1u << 4,
+    Collidable = 1u << 5,
+    PathFollower = 1u << 6, // has a valid path vector cursor
+    Animated = 1u << 7,     // has more than one sprite frame and a delay
+    Disabled = 1u << 8,
+    Culled = 1u << 9, // outside the view; skipped by visual-only systems
+    Trigger = 1u << 10, // reports overlaps but never blocks movement
+    Navigator = 1u << 11, // steers along the world's flow field instead of path vectors
+};
+
+// One table per distinct signature; rows are indices into the engine's entity list
+struct ArchetypeTable
+{
+    Signature signature;
+    std::vector<std::uint32_t> rows;
+};
+
+class ArchetypeRegistry
+{
+public:
+    // Re-file entities whose signature changed since the last sync and append new ones
+    void sync(const std::vector<Entity> &entities);
+    // File only the entities added since the last sync or append; the others are not looked at
+    void append(const std::vector<Entity> &entities);
+
+    // Drop all tables (entity list was rebuilt or cleared)
+    void clear();
+
+    // Visit tables that carry every bit in include and none in exclude
+    template <typename Fn>
+    void forEachTable(Signature include, Signature exclude, Fn &&fn) const
+    {
+        for (const ArchetypeTable &t : tables_)
+        {
+            if ((t.signature & include) == include && (t.signature & exclude) == 0 && !t.rows.empty())
+                fn(t);
+        }
+    }
+
+    // Visit matching entities table by table
+    template <typename Fn>
+    void forEach(std::vector<Entity> &entities, Signature include, Signature exclude, Fn &&fn) const
+    {
+        forEachTable(include, exclude, [&](const ArchetypeTable &t) {
+            for (std::uint32_t row : t.rows)
+                fn(entities[row]);
+        });
+    }
+
+    // Entities carrying every bit in include and none in exclude
+    std::size_t count(Signature include, Signature exclude) const
+    {
+        std::size_t n = 0;
+        forEachTable(include, exclude, [&n](const ArchetypeTable &t) { n += t.rows.size(); });
+        return n;
+    }
+
+    std::size_t tableCount() const { return tables_.size(); }
+
+private:
+    struct Location
+    {
+        Signature signature;
+        std::uint32_t table;
+        std::uint32_t slot;
+    };
+
+    std::uint32_t tableFor(Signature sig);
+    void insert(std::uint32_t entity, Signature sig);
+    void remove(std::uint32_t entity);
+
+    std::vector<ArchetypeTable> tables_;
+    std::vector<Location> locations_;
+};
+
+} // namespace ecs
+
+#endif
@@ -0,0 +1,475 @@
+// Parallel image decoding and the decoded-pixel cache file
+#include "asset_cache.h"
+
+#include <SDL3_image/SDL_image.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "metrics.h"
+#include "worker_pool.h"
+
+namespace assets {
+
+namespace {
+
+// Cache file: header, entry table, then each image's pixels on a 64-byte boundary. Written in
+// native byte order; a file from a machine with the other order fails the magic check.
+constexpr std::uint32_t kMagic = 0x43544c46u; // "FLTC"
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint32_t kFlagPremultiplied = 1u;
+constexpr std::size_t kDataAlignment = 64;
+
+struct FileHeader
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t count;
+    std::uint32_t reserved;
+};
+
+struct FileEntry
+{
+    std::uint64_t hash; // of the source file's bytes
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t flags;
+    std::uint32_t reserved;
+    std::uint64_t offset; // of the pixels from the start of the file
+};
+
+static_assert(sizeof(FileHeader) == 16 && sizeof(FileEntry) == 32, "cache layout is part of the file format");
+
+// FNV-1a: enough to tell edited assets apart, and fast next to decoding
+std::uint64_t hashBytes(const std::vector<std::uint8_t> &bytes)
+{
+    std::uint64_t h = 0xcbf29ce484222325ull;
+    for (std::uint8_t b : bytes)
+    {
+        h ^= b;
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+std::size_t alignUp(std::size_t v, std::size_t a) { return (v + a - 1) / a * a; }
+
+bool readFile(const std::string &path, std::vector<std::uint8_t> &out)
+{
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    const std::streamoff size = in.tellg();
+    if (size < 0) return false;
+    out.resize(static_cast<std::size_t>(size));
+    in.seekg(0);
+    return in.read(reinterpret_cast<char *>(out.data()), size).good() || size == 0;
+}
+
+// Items differ wildly in cost (a sprite sheet against a single tile), so the shared pool's
+// threads pull one index at a time instead of taking fixed chunks
+template <typename Fn>
+void parallelEach(std::size_t count, int threads, Fn &&fn)
+{
+    WorkerPool::shared().forEach(count, fn, threads);
+}
+
+// Decode from memory into tightly packed RGBA32 rows
+bool decode(const std::string &path, const std::vector<std::uint8_t> &bytes, bool premultiply, std::vector<std::uint8_t> &pixels,
+            int &width, int &height)
+{
+    SDL_IOStream *io = SDL_IOFromConstMem(bytes.data(), bytes.size());
+    SDL_Surface *loaded = io ? IMG_Load_IO(io, true) : nullptr;
+    if (!loaded)
+    {
+        SDL_Log("Failed to decode %s: %s", path.c_str(), SDL_GetError());
+        return false;
+    }
+    SDL_Surface *rgba = SDL_ConvertSurface(loaded, SDL_PIXELFORMAT_RGBA32);
+    SDL_DestroySurface(loaded);
+    if (!rgba)
+    {
+        SDL_Log("Failed to convert %s: %s", path.c_str(), SDL_GetError());
+        return false;
+    }
+    if (premultiply)
+        SDL_PremultiplySurfaceAlpha(rgba, false);
+
+    width = rgba->w;
+    height = rgba->h;
+    const std::size_t row = static_cast<std::size_t>(width) * 4;
+    pixels.resize(row * static_cast<std::size_t>(height));
+    const std::uint8_t *src = static_cast<const std::uint8_t *>(rgba->pixels);
+    for (int y = 0; y < height; ++y)
+        std::memcpy(pixels.data() + row * static_cast<std::size_t>(y), src + static_cast<std::size_t>(rgba->pitch) * static_cast<std::size_t>(y), row);
+    SDL_DestroySurface(rgba);
+    return true;
+}
+
+// Entry table of a mapped cache file, or nullptr if the file is missing, foreign or truncated
+const FileEntry *entriesOf(const MappedFile &file, std::uint32_t &count)
+{
+    count = 0;
+    if (file.size() < sizeof(FileHeader)) return nullptr;
+    FileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != kMagic || header.version != kVersion) return nullptr;
+    if (file.size() < sizeof(FileHeader) + static_cast<std::size_t>(header.count) * sizeof(FileEntry)) return nullptr;
+
+    const FileEntry *entries = reinterpret_cast<const FileEntry *>(file.data() + sizeof(FileHeader));
+    for (std::uint32_t i = 0; i < header.count; ++i)
+    {
+        const std::uint64_t bytes = static_cast<std::uint64_t>(entries[i].width) * entries[i].height * 4;
+        if (entries[i].offset > file.size() || bytes > file.size() - entries[i].offset) return nullptr;
+    }
+    count = header.count;
+    return entries;
+}
+
+bool replaceFile(const std::string &from, const std::string &to)
+{
+    if (std::rename(from.c_str(), to.c_str()) == 0) return true;
+    // Some platforms refuse to rename over an existing file
+    std::remove(to.c_str());
+    return std::rename(from.c_str(), to.c_str()) == 0;
+}
+
+} // namespace
+
+// The new cache file's layout, worked out at load, and how far writing it has got
+struct ImageSet::CacheWrite
+{
+    std::string path;
+    std::string temp;
+    std::uint32_t flags = 0;
+    std::vector<FileEntry> table;
+    std::vector<std::size_t> source;  // image each table entry is written from
+    std::vector<std::size_t> entryOf; // table entry of each image
+    std::vector<std::uint64_t> hashes;
+    std::vector<std::uint8_t> fromCache;
+    std::ofstream out;
+    std::size_t next = 0; // table entry to write next
+    std::size_t at = 0;   // bytes in the file so far
+};
+
+bool MappedFile::open(const std::string &path)
+{
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view)
+    {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    file_ = file;
+    mapping_ = mapping;
+    data_ = static_cast<const std::uint8_t *>(view);
+    size_ = static_cast<std::size_t>(size.QuadPart);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    void *view = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file alive
+    if (view == MAP_FAILED) return false;
+    data_ = static_cast<const std::uint8_t *>(view);
+    size_ = static_cast<std::size_t>(st.st_size);
+#endif
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (!data_) return;
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+    CloseHandle(static_cast<HANDLE>(mapping_));
+    CloseHandle(static_cast<HANDLE>(file_));
+    file_ = mapping_ = nullptr;
+#else
+    munmap(const_cast<std::uint8_t *>(data_), size_);
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
+
+ImageSet::ImageSet() = default;
+
+ImageSet::~ImageSet()
+{
+    clear();
+}
+
+void ImageSet::clear()
+{
+    if (pending_)
+    {
+        // An unfinished write leaves no partial file behind
+        pending_->out.close();
+        std::remove(pending_->temp.c_str());
+        pending_.reset();
+    }
+    images_.clear();
+    decoded_.clear();
+    cache_.close();
+    stats_ = LoadStats();
+}
+
+const Image *ImageSet::find(const std::string &path) const
+{
+    for (const Image &image : images_)
+    {
+        if (image.path == path && image.pixels) return &image;
+    }
+    return nullptr;
+}
+
+bool ImageSet::load(const std::vector<std::string> &paths, const std::string &cachePath, const LoadOptions &options)
+{
+    const auto start = std::chrono::steady_clock::now();
+    clear();
+
+    const std::size_t n = paths.size();
+    const std::uint32_t flags = options.premultiply ? kFlagPremultiplied : 0u;
+    images_.resize(n);
+    decoded_.resize(n);
+    std::vector<std::vector<std::uint8_t>> sources(n);
+    std::vector<std::uint64_t> hashes(n, 0);
+    std::vector<std::uint8_t> readable(n, 0);
+    std::vector<std::uint8_t> fromCache(n, 0);
+
+    // Reading and hashing is cheap next to decoding but still worth spreading out
+    parallelEach(n, options.threads, [&](std::size_t i) {
+        images_[i].path = paths[i];
+        images_[i].premultiplied = options.premultiply;
+        if (!readFile(paths[i], sources[i]))
+        {
+            SDL_Log("Failed to read %s", paths[i].c_str());
+            return;
+        }
+        readable[i] = 1;
+        hashes[i] = hashBytes(sources[i]);
+    });
+
+    // Unchanged images come straight from the mapping
+    std::vector<std::size_t> misses;
+    std::uint32_t cachedCount = 0;
+    const FileEntry *entries = cache_.open(cachePath) ? entriesOf(cache_, cachedCount) : nullptr;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (!readable[i]) continue;
+        const FileEntry *hit = nullptr;
+        for (std::uint32_t e = 0; e < cachedCount && !hit; ++e)
+        {
+            if (entries[e].hash == hashes[i] && entries[e].flags == flags) hit = &entries[e];
+        }
+        if (hit)
+        {
+            images_[i].width = static_cast<int>(hit->width);
+            images_[i].height = static_cast<int>(hit->height);
+            images_[i].pixels = cache_.data() + hit->offset;
+            fromCache[i] = 1;
+            sources[i].clear();
+            ++stats_.cached;
+        }
+        else
+        {
+            misses.push_back(i);
+        }
+    }
+
+    // Files with the same content are decoded once and share the pixels
+    std::vector<std::size_t> unique;
+    std::vector<std::size_t> leader(n, static_cast<std::size_t>(-1));
+    for (std::size_t i : misses)
+    {
+        for (std::size_t u : unique)
+        {
+            if (hashes[u] == hashes[i]) leader[i] = u;
+        }
+        if (leader[i] == static_cast<std::size_t>(-1)) unique.push_back(i);
+    }
+    parallelEach(unique.size(), options.threads, [&](std::size_t m) {
+        const std::size_t i = unique[m];
+        Image &image = images_[i];
+        if (decode(paths[i], sources[i], options.premultiply, decoded_[i], image.width, image.height))
+            image.pixels = decoded_[i].data();
+        std::vector<std::uint8_t>().swap(sources[i]);
+    });
+    for (std::size_t i : misses)
+    {
+        if (leader[i] != static_cast<std::size_t>(-1))
+        {
+            const Image &first = images_[leader[i]];
+            images_[i].width = first.width;
+            images_[i].height = first.height;
+            images_[i].pixels = first.pixels;
+        }
+        if (images_[i].pixels) ++stats_.decoded;
+    }
+    stats_.failed = static_cast<int>(n) - stats_.cached - stats_.decoded;
+
+    // Rewrite the cache with exactly this set, so stale entries don't pile up. Images with the same
+    // content share one copy of their pixels.
+    if (stats_.decoded > 0)
+    {
+        pending_ = std::make_unique<CacheWrite>();
+        CacheWrite &w = *pending_;
+        w.path = cachePath;
+        w.temp = cachePath + ".tmp";
+        w.flags = flags;
+        w.entryOf.assign(n, static_cast<std::size_t>(-1));
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            if (!images_[i].pixels) continue;
+            for (std::size_t e = 0; e < w.table.size(); ++e)
+            {
+                if (w.table[e].hash == hashes[i]) w.entryOf[i] = e;
+            }
+            if (w.entryOf[i] != static_cast<std::size_t>(-1)) continue;
+            w.entryOf[i] = w.table.size();
+            w.table.push_back(FileEntry{hashes[i], static_cast<std::uint32_t>(images_[i].width), static_cast<std::uint32_t>(images_[i].height),
+                                        flags, 0u, 0u});
+            w.source.push_back(i);
+        }
+        std::size_t offset = alignUp(sizeof(FileHeader) + w.table.size() * sizeof(FileEntry), kDataAlignment);
+        for (std::size_t e = 0; e < w.table.size(); ++e)
+        {
+            w.table[e].offset = offset;
+            offset = alignUp(offset + images_[w.source[e]].bytes(), kDataAlignment);
+        }
+        w.hashes = std::move(hashes);
+        w.fromCache = std::move(fromCache);
+        if (!options.deferCacheWrite) writeCache(UINT64_MAX);
+    }
+
+    stats_.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats_.failed == 0;
+}
+
+bool ImageSet::writeCache(std::uint64_t deadlineNS)
+{
+    if (!pending_) return false;
+    CacheWrite &w = *pending_;
+    if (!w.out.is_open())
+    {
+        w.out.open(w.temp, std::ios::binary | std::ios::trunc);
+        const FileHeader header{kMagic, kVersion, static_cast<std::uint32_t>(w.table.size()), 0u};
+        w.out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        w.out.write(reinterpret_cast<const char *>(w.table.data()), static_cast<std::streamsize>(w.table.size() * sizeof(FileEntry)));
+        w.at = sizeof(FileHeader) + w.table.size() * sizeof(FileEntry);
+    }
+    static const char zeros[kDataAlignment] = {};
+    while (w.out && w.next < w.table.size())
+    {
+        const FileEntry &entry = w.table[w.next];
+        const Image &image = images_[w.source[w.next]];
+        w.out.write(zeros, static_cast<std::streamsize>(entry.offset - w.at));
+        w.out.write(reinterpret_cast<const char *>(image.pixels), static_cast<std::streamsize>(image.bytes()));
+        w.at = entry.offset + image.bytes();
+        ++w.next;
+        if (metrics::nowNS() >= deadlineNS) break;
+    }
+    if (w.out && w.next < w.table.size()) return true;
+    finishCacheWrite();
+    return false;
+}
+
+bool ImageSet::writeCacheSlice(void *set, std::uint64_t deadlineNS)
+{
+    return static_cast<ImageSet *>(set)->writeCache(deadlineNS);
+}
+
+void ImageSet::finishCacheWrite()
+{
+    CacheWrite &w = *pending_;
+    w.out.close();
+    const std::size_t n = images_.size();
+
+    // Swap the new file in and point every image at it. The old mapping has to go first: some
+    // platforms cannot replace a mapped file.
+    if (!w.out.fail())
+    {
+        cache_.close();
+        if (replaceFile(w.temp, w.path) && cache_.open(w.path))
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (images_[i].pixels) images_[i].pixels = cache_.data() + w.table[w.entryOf[i]].offset;
+            }
+            decoded_.clear();
+            stats_.cacheWritten = true;
+        }
+        else
+        {
+            SDL_Log("Failed to replace image cache %s", w.path.c_str());
+            // Cached images pointed into the old mapping; reload it (offsets are unchanged)
+            std::uint32_t count = 0;
+            const FileEntry *old = cache_.open(w.path) ? entriesOf(cache_, count) : nullptr;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (!w.fromCache[i]) continue;
+                images_[i].pixels = nullptr;
+                for (std::uint32_t e = 0; e < count; ++e)
+                {
+                    if (old[e].hash == w.hashes[i] && old[e].flags == w.flags) images_[i].pixels = cache_.data() + old[e].offset;
+                }
+                if (!images_[i].pixels)
+                {
+                    --stats_.cached;
+                    ++stats_.failed;
+                }
+            }
+        }
+    }
+    else
+    {
+        SDL_Log("Failed to write image cache %s", w.temp.c_str());
+        std::remove(w.temp.c_str());
+    }
+    pending_.reset();
+}
+
+SDL_Texture *createTexture(SDL_Renderer *renderer, const Image &image)
+{
+    if (!renderer || !image.pixels) return nullptr;
+    SDL_Texture *texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, image.width, image.height);
+    if (!texture)
+    {
+        SDL_Log("Failed to create texture for %s: %s", image.path.c_str(), SDL_GetError());
+        return nullptr;
+    }
+    SDL_UpdateTexture(texture, nullptr, image.pixels, image.width * 4);
+    SDL_SetTextureBlendMode(texture, image.premultiplied ? SDL_BLENDMODE_BLEND_PREMULTIPLIED : SDL_BLENDMODE_BLEND);
+    return texture;
+}
+
+} // namespace assets
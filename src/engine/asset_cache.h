@@ -0,0 +1,109 @@
+// Startup image loading: parallel decode and a memory-mapped cache of decoded pixels
+#ifndef ASSET_CACHE_H
+#define ASSET_CACHE_H
+
+#include <SDL3/SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace assets {
+
+// Decoded RGBA32 pixels (tightly packed rows), either in the mapped cache or owned by the set
+struct Image
+{
+    std::string path;
+    int width = 0;
+    int height = 0;
+    const std::uint8_t *pixels = nullptr;
+    bool premultiplied = false;
+
+    std::size_t bytes() const { return static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 4; }
+};
+
+struct LoadOptions
+{
+    int threads = 0;          // decode workers; <= 0 uses every hardware thread
+    bool premultiply = false; // store colour premultiplied by alpha (uploaded with the matching blend mode)
+    bool deferCacheWrite = false; // leave rewriting the cache file to writeCache(), e.g. from a background job
+};
+
+struct LoadStats
+{
+    int cached = 0;  // mapped straight from the cache file
+    int decoded = 0; // decoded from the source file this time
+    int failed = 0;
+    bool cacheWritten = false;
+    double seconds = 0.0;
+};
+
+// Read-only view of a whole file, mapped into memory
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const std::string &path);
+    void close();
+    const std::uint8_t *data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    const std::uint8_t *data_ = nullptr;
+    std::size_t size_ = 0;
+#ifdef _WIN32
+    void *file_ = nullptr;
+    void *mapping_ = nullptr;
+#endif
+};
+
+// A fixed list of images loaded together at startup. Each source file is hashed; images whose
+// hash (and premultiply setting) is in the cache file are used in place from the mapping, the
+// rest are decoded in parallel and the cache is rewritten for the next launch.
+class ImageSet
+{
+public:
+    ImageSet();
+    ~ImageSet();
+    ImageSet(const ImageSet &) = delete;
+    ImageSet &operator=(const ImageSet &) = delete;
+
+    // Returns false if any image failed to load; the others are still available
+    bool load(const std::vector<std::string> &paths, const std::string &cachePath, const LoadOptions &options = LoadOptions());
+    void clear();
+
+    // After a load with deferCacheWrite: write the new cache file one image at a time until
+    // deadlineNS (metrics::nowNS clock), at least one per call, then swap it in and point the
+    // images at it. Returns true while more remains. Pixel pointers change when it finishes, so
+    // nothing may read them meanwhile; textures already made from them are unaffected.
+    bool writeCache(std::uint64_t deadlineNS);
+    bool cacheWritePending() const { return pending_ != nullptr; }
+    // writeCache as a jobs::Slice, with the set as its context
+    static bool writeCacheSlice(void *set, std::uint64_t deadlineNS);
+
+    const Image *find(const std::string &path) const;
+    const std::vector<Image> &images() const { return images_; }
+    const LoadStats &stats() const { return stats_; }
+
+private:
+    std::vector<Image> images_;
+    std::vector<std::vector<std::uint8_t>> decoded_; // pixels that are not (yet) in the mapping
+    MappedFile cache_;
+    LoadStats stats_;
+
+    struct CacheWrite;
+    void finishCacheWrite();
+    std::unique_ptr<CacheWrite> pending_; // a cache file still to be written
+};
+
+// Upload an image as a static texture with the blend mode matching its alpha format
+SDL_Texture *createTexture(SDL_Renderer *renderer, const Image &image);
+
+} // namespace assets
+
+#endif
@@ -0,0 +1,115 @@
+// Behaviour registry and batched dispatch
+#include "behaviour.h"
+
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+#include "entity.h"
+#include "frame_arena.h"
+
+namespace behaviour {
+
+namespace {
+
+constexpr std::size_t kMaxBehaviours = 1024;
+
+struct Entry
+{
+    std::atomic<Callback> callback{nullptr};
+    std::atomic<BatchCallback> batch{nullptr};
+};
+
+// Append-only table: writers fill an entry under the mutex, then publish it by bumping the count,
+// so dispatch reads without locking. Id 0 is the empty behaviour.
+std::mutex gMutex;
+Entry gEntries[kMaxBehaviours];
+std::atomic<std::size_t> gCount{1};
+
+Callback loadCallback(Id id)
+{
+    return id < gCount.load(std::memory_order_acquire) ? gEntries[id].callback.load(std::memory_order_relaxed) : nullptr;
+}
+
+} // namespace
+
+Id intern(Callback callback)
+{
+    if (!callback) return kNone;
+    std::lock_guard<std::mutex> lock(gMutex);
+    const std::size_t count = gCount.load(std::memory_order_relaxed);
+    for (std::size_t i = 1; i < count; ++i)
+    {
+        if (gEntries[i].callback.load(std::memory_order_relaxed) == callback) return static_cast<Id>(i);
+    }
+    if (count == kMaxBehaviours)
+    {
+        SDL_Log("Too many behaviours registered (max %d)", static_cast<int>(kMaxBehaviours));
+        return kNone;
+    }
+    gEntries[count].callback.store(callback, std::memory_order_relaxed);
+    gCount.store(count + 1, std::memory_order_release);
+    return static_cast<Id>(count);
+}
+
+void setBatch(Id id, BatchCallback batch)
+{
+    if (id != kNone && id < gCount.load(std::memory_order_acquire)) gEntries[id].batch.store(batch, std::memory_order_release);
+}
+
+Callback callbackOf(Id id)
+{
+    return loadCallback(id);
+}
+
+void invoke(Id id, Entity &entity)
+{
+    if (id == kNone) return;
+    if (Callback callback = loadCallback(id)) callback(entity);
+}
+
+void Dispatcher::build(std::vector<Entity> &entities, mem::FrameArena &scratch)
+{
+    const std::size_t ids = gCount.load(std::memory_order_acquire);
+
+    auto runs = [ids](const Entity &e) { return e.getBehaviour() != kNone && e.getBehaviour() < ids && !e.isDisabled(); };
+
+    start_.assign(ids + 1, 0);
+    for (const Entity &e : entities)
+    {
+        if (runs(e)) ++start_[e.getBehaviour() + 1];
+    }
+    for (std::size_t b = 1; b <= ids; ++b)
+        start_[b] += start_[b - 1];
+
+    entities_.resize(start_[ids]);
+    std::uint32_t *cursor = scratch.allocateArray<std::uint32_t>(ids);
+    std::copy(start_.begin(), start_.end() - 1, cursor);
+    for (Entity &e : entities)
+    {
+        if (runs(e)) entities_[cursor[e.getBehaviour()]++] = &e;
+    }
+}
+
+void Dispatcher::run() const
+{
+    // Behaviours registered after build() (e.g. by a callback) join on the next tick
+    for (std::size_t b = 1; b + 1 < start_.size(); ++b)
+    {
+        const std::uint32_t first = start_[b];
+        const std::uint32_t count = start_[b + 1] - first;
+        if (count == 0) continue;
+        if (const BatchCallback batch = gEntries[b].batch.load(std::memory_order_acquire))
+        {
+            batch(entities_.data() + first, count);
+            continue;
+        }
+        // One target per batch: the indirect call predicts perfectly
+        const Callback callback = gEntries[b].callback.load(std::memory_order_relaxed);
+        for (std::uint32_t i = first; i < first + count; ++i)
+            callback(*entities_[i]);
+    }
+}
+
+} // namespace behaviour
@@ -0,0 +1,52 @@
+// Entity behaviours: callbacks registered once per type, referenced by a small id
+#ifndef BEHAVIOUR_H
+#define BEHAVIOUR_H
+
+#include <cstdint>
+#include <vector>
+
+class Entity;
+
+namespace mem {
+class FrameArena;
+}
+
+namespace behaviour {
+
+using Id = std::uint16_t;
+constexpr Id kNone = 0;
+
+// Per-entity callback; captureless lambdas convert to this
+using Callback = void (*)(Entity &);
+// Optional whole-batch form: every enabled entity carrying the behaviour in one call
+using BatchCallback = void (*)(Entity *const *entities, std::size_t count);
+
+// Register (or look up) the behaviour for a callback. The same callback always maps to the same id,
+// so entities built from one lambda share a behaviour. nullptr maps to kNone.
+Id intern(Callback callback);
+// Attach a batch form to an existing behaviour; the dispatcher then calls it instead of looping
+void setBatch(Id id, BatchCallback batch);
+
+Callback callbackOf(Id id);
+
+// Call the behaviour for one entity (collision responses); kNone does nothing
+void invoke(Id id, Entity &entity);
+
+// Entities grouped by behaviour, rebuilt once per tick by a counting sort over ids
+class Dispatcher
+{
+public:
+    // Group enabled entities with a behaviour; disabled ones and kNone are skipped.
+    // Sort cursors come from scratch, so a steady entity count means no allocation.
+    void build(std::vector<Entity> &entities, mem::FrameArena &scratch);
+    // Run every behaviour over its batch, in id order and entity order within a batch
+    void run() const;
+
+private:
+    std::vector<std::uint32_t> start_; // batch of id b: entities_[start_[b]..start_[b + 1])
+    std::vector<Entity *> entities_;
+};
+
+} // namespace behaviour
+
+#endif
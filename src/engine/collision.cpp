@@ -2,135 +2,478 @@
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_rect.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <utility>
 
 #include "entity.h"
-#include "engine.h"
+#include "world.h"
 #include "collision.h"
 
 // Move until contact using overlap depth on each axis to avoid overlaps at high speed.
 
-// Global engine instance from main.cpp
-extern Engine engine;
-
 // Move entity towards target while resolving collisions; zeroes velocity on blocked axes
 // Optionally returns max penetration along X/Y at the probe position using motion directions
-inline bool wouldCollideWithAny(Entity* moving, float newX, float newY,
-                                float* outMaxPenX = nullptr, float* outMaxPenY = nullptr,
-                                float dirX = 0.0f, float dirY = 0.0f);
+// outSupport receives the entity pushed into deepest when moving down (-1 for terrain or none)
+template <typename Real>
+static bool wouldCollideWithAny(World& world, Entity* moving, Real newX, Real newY,
+                                Real* outMaxPenX = nullptr, Real* outMaxPenY = nullptr,
+                                int dirX = 0, int dirY = 0, int* outSupport = nullptr);
+
+template <typename Real>
+static bool restOnSupport(World& world, Entity& e, Real x, Real startY, Real targetY, Real& y);
+
+// Compact helper to build a Box from an Entity (no heap allocations)
+template <typename Real>
+static inline Box<Real> makeBox(const Entity &e) {
+    return Box<Real>{ Real(e.getX()), Real(e.getY()), Real(e.getWidth() * e.getScale()), Real(e.getHeight() * e.getScale()) };
+}
+
+// The mover at (x, y) with its extents as of the tick's collider sync, so probing never reads
+// the entity's cold row; one added since the sync has no box yet
+template <typename Real>
+static inline Box<Real> probeBox(const World &world, const Entity &e, Real x, Real y) {
+    const collision::ColliderSet &colliders = world.getColliders();
+    const std::size_t self = static_cast<std::size_t>(&e - world.getEntities().data());
+    if (self >= colliders.size()) return Box<Real>{ x, y, Real(e.getWidth() * e.getScale()), Real(e.getHeight() * e.getScale()) };
+    const Box<sim::Real> &b = colliders.box(self);
+    return Box<Real>{ x, y, Real(b.w), Real(b.h) };
+}
+
+template <typename Real>
+static inline Box<Real> makeBox(const SDL_FRect &r) {
+    return Box<Real>{ Real(r.x), Real(r.y), Real(r.w), Real(r.h) };
+}
+
+template <typename Real>
+static inline bool overlaps(const Box<Real> &a, const Box<Real> &b) {
+    return (a.x < b.x + b.w) && (a.x + a.w > b.x) && (a.y < b.y + b.h) && (a.y + a.h > b.y);
+}
+
+// Track the deepest overlap of probe box pr into orc along the motion direction
+template <typename Real>
+static inline void accumulatePenetration(const Box<Real>& pr, const Box<Real>& orc, int dirX, int dirY,
+                                         Real& maxPenX, Real& maxPenY) {
+    if (dirX != 0) {
+        const Real penX = (dirX > 0) ? ((pr.x + pr.w) - orc.x) : ((orc.x + orc.w) - pr.x);
+        if (penX > maxPenX) maxPenX = penX;
+    }
+    if (dirY != 0) {
+        const Real penY = (dirY > 0) ? ((pr.y + pr.h) - orc.y) : ((orc.y + orc.h) - pr.y);
+        if (penY > maxPenY) maxPenY = penY;
+    }
+}
+
+// Terrain: merged solid tile rects behave like one static platform. The float query is padded
+// by a pixel so rounding cannot drop a candidate; the exact test happens in Real. Posts nothing:
+// a hit lands a controllable mover only if the caller acts on it.
+template <typename Real>
+static bool probeTerrain(World& world, const Entity& moving, const Box<Real>& pr, int dirX, int dirY, Real& maxPenX, Real& maxPenY) {
+    TileLayer* terrain = world.getTerrain();
+    if (!terrain || !(moving.getCollisionMask() & collision::LayerTerrain)) return false;
+    bool collided = false;
+    const SDL_FRect query{ sim::toFloat(pr.x) - 1.0f, sim::toFloat(pr.y) - 1.0f,
+                           sim::toFloat(pr.w) + 2.0f, sim::toFloat(pr.h) + 2.0f };
+    terrain->forEachSolidOverlapping(query, [&](const SDL_FRect& rect) {
+        const Box<Real> orc = makeBox<Real>(rect);
+        if (!overlaps(pr, orc)) return;
+        collided = true;
+        accumulatePenetration(pr, orc, dirX, dirY, maxPenX, maxPenY);
+    });
+    return collided;
+}
+
+// Resting contact kept from earlier ticks: when the supporting body is the only candidate near
+// the mover, land on its top directly instead of probing every neighbour again. Returns false
+// (and leaves y alone) whenever the full probe could answer differently.
+template <typename Real>
+static bool restOnSupport(World& world, Entity& e, Real x, Real startY, Real targetY, Real& y) {
+    const int support = e.getSupport();
+    if (support < 0) return false;
+    const auto& entities = world.getEntities();
+    const collision::ColliderSet& colliders = world.getColliders();
+    const std::uint32_t self = static_cast<std::uint32_t>(&e - entities.data());
+    const collision::IndexRange near = colliders.candidates(self);
+    const std::uint32_t* found = std::find(near.begin(), near.end(), static_cast<std::uint32_t>(support));
+    if (found == near.end()) return false;
 
-// Compact helper to build an SDL_FRect from an Entity (no heap allocations)
-static inline SDL_FRect makeRect(const Entity &e) {
-    return SDL_FRect{ e.getX(), e.getY(), e.getWidth() * e.getScale(), e.getHeight() * e.getScale() };
+    const std::uint8_t flags = colliders.flags(static_cast<std::size_t>(support));
+    if (e.isControllable() && (flags & collision::ColliderEnemy)) return false;
+
+    const Box<sim::Real>& b = colliders.box(static_cast<std::size_t>(support));
+    const Box<Real> orc{ Real(b.x), Real(b.y), Real(b.w), Real(b.h) };
+    const Box<Real> landing = probeBox<Real>(world, e, x, targetY);
+    // Anything else at the landing spot means the full probe has to decide. Candidates are only
+    // a superset from fattened boxes that depend on history, so test them exactly instead of
+    // counting them: a restored state must take the same path as the original run.
+    world.countProbes(static_cast<std::uint32_t>(near.end() - near.begin()));
+    for (std::uint32_t i : near) {
+        if (i == static_cast<std::uint32_t>(support)) continue;
+        const Box<sim::Real>& ob = colliders.box(i);
+        if (overlaps(landing, Box<Real>{ Real(ob.x), Real(ob.y), Real(ob.w), Real(ob.h) })) return false;
+    }
+    const Real top = orc.y - landing.h;
+    // Walked off the edge, falling short of the surface, or already sunk into it
+    if (!(x < orc.x + orc.w && x + landing.w > orc.x)) return false;
+    if (!(targetY > top) || startY > top || targetY >= orc.y + orc.h) return false;
+
+    // Terrain under the landing spot still counts; a hit means the full probe has to decide
+    Real penX = Real(0);
+    Real penY = Real(0);
+    if (probeTerrain(world, e, landing, 0, 1, penX, penY)) return false;
+
+    if (e.isControllable() && (flags & collision::ColliderPlatform)) {
+        world.getEvents().post(events::Landed{ self });
+    }
+    world.getEvents().post(events::Contact{ static_cast<std::uint32_t>(support), self });
+    y = top;
+    return true;
 }
 
-void handle_collision(Entity& e, float targetX, float targetY, float targetVx, float targetVy) {
-    float x = e.getX();
-    float y = e.getY();
-    const float prevVx = e.getVelocityX();
-    const float prevVy = e.getVelocityY();
+template <typename Real>
+void handle_collision(World& world, Entity& e, Real targetX, Real targetY, Real targetVx, Real targetVy) {
+    const Real startX = Real(e.getX());
+    const Real startY = Real(e.getY());
+    Real x = startX;
+    Real y = startY;
+    const Real prevVx = Real(e.getVelocityX());
+    const Real prevVy = Real(e.getVelocityY());
 
     // X axis: move to target or to contact using max penetration, clamped to avoid reversing
-    float dx = targetX - x;
-    const float dirX = (dx > 0.0f) ? 1.0f : (dx < 0.0f ? -1.0f : 0.0f);
+    const Real dx = targetX - x;
+    const int dirX = (dx > Real(0)) ? 1 : (dx < Real(0) ? -1 : 0);
     bool collidedX = false;
-    if (dirX != 0.0f) {
-        float maxPenX = 0.0f;
-        collidedX = wouldCollideWithAny(&e, targetX, y, &maxPenX, nullptr, dirX, 0.0f);
+    if (dirX != 0) {
+        Real maxPenX = Real(0);
+        collidedX = wouldCollideWithAny<Real>(world, &e, targetX, y, &maxPenX, nullptr, dirX, 0);
         if (!collidedX) {
             x = targetX;
         } else {
-            const float backoff = SDL_min(SDL_fabsf(dx), maxPenX);
-            const float candidate = targetX - dirX * backoff;
+            const Real backoff = sim::minimum(sim::absolute(dx), maxPenX);
+            const Real candidate = dirX > 0 ? targetX - backoff : targetX + backoff;
             // Clamp to not pass the starting point
-            x = (dirX > 0.0f) ? SDL_max(candidate, e.getX()) : SDL_min(candidate, e.getX());
+            x = (dirX > 0) ? sim::maximum(candidate, startX) : sim::minimum(candidate, startX);
         }
     }
 
     // Y axis: move to target or to contact similarly, using updated X
-    float dy = targetY - y;
-    const float dirY = (dy > 0.0f) ? 1.0f : (dy < 0.0f ? -1.0f : 0.0f);
+    const Real dy = targetY - y;
+    const int dirY = (dy > Real(0)) ? 1 : (dy < Real(0) ? -1 : 0);
     bool collidedY = false;
-    if (dirY != 0.0f) {
-        float maxPenY = 0.0f;
-        collidedY = wouldCollideWithAny(&e, x, targetY, nullptr, &maxPenY, 0.0f, dirY);
+    int support = -1;
+    if (dirY > 0 && restOnSupport<Real>(world, e, x, startY, targetY, y)) {
+        collidedY = true;
+        support = e.getSupport();
+    } else if (dirY != 0) {
+        Real maxPenY = Real(0);
+        collidedY = wouldCollideWithAny<Real>(world, &e, x, targetY, nullptr, &maxPenY, 0, dirY, &support);
         if (!collidedY) {
             y = targetY;
         } else {
-            const float backoff = SDL_min(SDL_fabsf(dy), maxPenY);
-            const float candidate = targetY - dirY * backoff;
-            y = (dirY > 0.0f) ? SDL_max(candidate, e.getY()) : SDL_min(candidate, e.getY());
+            const Real backoff = sim::minimum(sim::absolute(dy), maxPenY);
+            const Real candidate = dirY > 0 ? targetY - backoff : targetY + backoff;
+            y = (dirY > 0) ? sim::maximum(candidate, startY) : sim::minimum(candidate, startY);
         }
     }
+    // The contact is kept while the body keeps landing on it; no vertical motion leaves it as is
+    if (dirY != 0) e.setSupport(collidedY && dirY > 0 ? support : -1);
 
     // Commit. Keep previous velocity on axes that collided; otherwise take target velocity
-    e.setX(x);
-    e.setY(y);
+    e.setX(sim::Real(x));
+    e.setY(sim::Real(y));
     if(e.isControllable()) {
-        e.setVelocityX(collidedX ? 0 : targetVx);
-        e.setVelocityY(collidedY ? 0 : targetVy);
+        e.setVelocityX(sim::Real(collidedX ? Real(0) : targetVx));
+        e.setVelocityY(sim::Real(collidedY ? Real(0) : targetVy));
     } else {
-        e.setVelocityX(collidedX ? prevVx : targetVx);
-        e.setVelocityY(collidedY ? prevVy : targetVy);
+        e.setVelocityX(sim::Real(collidedX ? prevVx : targetVx));
+        e.setVelocityY(sim::Real(collidedY ? prevVy : targetVy));
     }
 }
 
 
 // Check if moving entity to (newX, newY) would collide with any other entity
-inline bool wouldCollideWithAny(Entity* moving, float newX, float newY,
-                                float* outMaxPenX, float* outMaxPenY,
-                                float dirX, float dirY) {
+template <typename Real>
+static bool wouldCollideWithAny(World& world, Entity* moving, Real newX, Real newY,
+                                Real* outMaxPenX, Real* outMaxPenY,
+                                int dirX, int dirY, int* outSupport) {
     if (!moving) return false;
-    Entity next = *moving; // lightweight copy with proposed position
-    next.setX(newX);
-    next.setY(newY);
+    const auto& entities = world.getEntities();
+    const std::uint32_t self = static_cast<std::uint32_t>(moving - entities.data());
 
-    const SDL_FRect pr = makeRect(next);
+    const Box<Real> pr = probeBox<Real>(world, *moving, newX, newY);
     bool collided = false;
-    float maxPenX = 0.0f;
-    float maxPenY = 0.0f;
-
-    const auto& entities = engine.getEntities();
-    for (const auto& other : entities) {
-        if(other.isDisabled()) continue;
-        if (&other == moving) continue;
-        auto [xOverlap, yOverlap] = areEntitiesColliding(next, other);
-        if (!(xOverlap && yOverlap) || !other.isCollidable()) continue;
-        
-        const SDL_FRect orc = makeRect(other);
-
-        if(other.isEnemy() && moving->isControllable()) {
-            moving->setReset(true);
+    Real maxPenX = Real(0);
+    Real maxPenY = Real(0);
+
+    const bool controllable = moving->isControllable();
+    bool hitEnemy = false;
+    bool landed = false;
+    int support = -1;
+    Real supportPen = Real(0);
+
+    // Candidates come from the tick's pair pass: already layer/mask filtered, triggers excluded
+    const collision::ColliderSet& colliders = world.getColliders();
+    const collision::IndexRange near = colliders.candidates(self);
+    world.countProbes(static_cast<std::uint32_t>(near.end() - near.begin()));
+    for (std::uint32_t i : near) {
+        const std::uint8_t flags = colliders.flags(i);
+        const Box<sim::Real>& b = colliders.box(i);
+        const Box<Real> orc{ Real(b.x), Real(b.y), Real(b.w), Real(b.h) };
+        if (!overlaps(pr, orc)) continue;
+        // Riders move with this body after it steps, so they never block it
+        if (entities[i].getSupport() == static_cast<int>(self)) continue;
+
+        if (controllable && (flags & collision::ColliderEnemy)) {
+            world.getEvents().post(events::PlayerHit{ self, i });
+            hitEnemy = true;
             break;
-        } 
-        
-        if(other.isPlatform() && moving->isControllable()) {
-            moving->setJumping(false);
         }
 
-        other.getUpdateFunction()(const_cast<Entity&>(other)); // Call on-collision update function
+        if (controllable && (flags & collision::ColliderPlatform)) {
+            landed = true;
+        }
+
+        world.getEvents().post(events::Contact{ i, self }); // Touched entity's on-collision update runs after the movers
 
         collided = true;
-        if (outMaxPenX && dirX != 0.0f) {
-            const float penX = (dirX > 0.0f) ? ((pr.x + pr.w) - orc.x) : ((orc.x + orc.w) - pr.x);
-            if (penX > maxPenX) maxPenX = penX;
-        }
-        if (outMaxPenY && dirY != 0.0f) {
-            const float penY = (dirY > 0.0f) ? ((pr.y + pr.h) - orc.y) : ((orc.y + orc.h) - pr.y);
-            if (penY > maxPenY) maxPenY = penY;
+        accumulatePenetration(pr, orc, dirX, dirY, maxPenX, maxPenY);
+        if (dirY > 0 && maxPenY > supportPen) {
+            support = static_cast<int>(i);
+            supportPen = maxPenY;
         }
     }
 
+    if (!hitEnemy && probeTerrain(world, *moving, pr, dirX, dirY, maxPenX, maxPenY)) {
+        collided = true;
+        if (controllable) landed = true;
+        if (maxPenY > supportPen) support = -1; // standing on terrain: nothing to ride
+    }
+    // One landing per probe, whether platforms, terrain or both were hit
+    if (landed) {
+        world.getEvents().post(events::Landed{ self });
+    }
+
     if (outMaxPenX) *outMaxPenX = maxPenX;
     if (outMaxPenY) *outMaxPenY = maxPenY;
+    if (outSupport) *outSupport = support;
     
     return collided;
 }
 
 std::pair<bool, bool> areEntitiesColliding(const Entity &a, const Entity &b) {
-    const SDL_FRect ra = makeRect(a);
-    const SDL_FRect rb = makeRect(b);
+    const Box<sim::Real> ra = makeBox<sim::Real>(a);
+    const Box<sim::Real> rb = makeBox<sim::Real>(b);
     const bool xOverlap = (ra.x < rb.x + rb.w) && (ra.x + ra.w > rb.x);
     const bool yOverlap = (ra.y < rb.y + rb.h) && (ra.y + ra.h > rb.y);
     return {xOverlap, yOverlap};
-}
\ No newline at end of file
+}
+
+template void handle_collision<sim::Real>(World&, Entity&, sim::Real, sim::Real, sim::Real, sim::Real);
+
+void carry_with_support(World& world, Entity& rider, unsigned long long tick) {
+    const int support = rider.getSupport();
+    if (support < 0) return;
+    const auto& entities = world.getEntities();
+    if (static_cast<std::size_t>(support) >= entities.size() || entities[support].isDisabled()) {
+        rider.setSupport(-1);
+        return;
+    }
+    const Entity& s = entities[support];
+    if (s.getLastStepTick() != tick) return; // the support did not move this tick
+
+    // The contact holds while the rider sits on the support's top as it was before it moved
+    const Box<sim::Real> r = probeBox<sim::Real>(world, rider, rider.getX(), rider.getY());
+    const sim::Real sx = s.getPreviousX();
+    const sim::Real sy = s.getPreviousY();
+    const sim::Real sw = probeBox<sim::Real>(world, s, sx, sy).w;
+    const sim::Real gap = sim::absolute(sim::Real(r.y + r.h) - sy);
+    if (!(r.x < sx + sw && r.x + r.w > sx) || gap > sim::Real(1)) {
+        rider.setSupport(-1);
+        return;
+    }
+
+    const sim::Real dx = s.getX() - sx;
+    const sim::Real dy = s.getY() - sy;
+    if (dx == sim::Real(0) && dy == sim::Real(0)) return;
+
+    // Resolve the carry against everything else; the rider's own velocity is left as it was
+    const sim::Real vx = rider.getVelocityX();
+    const sim::Real vy = rider.getVelocityY();
+    handle_collision<sim::Real>(world, rider, rider.getX() + dx, rider.getY() + dy, vx, vy);
+    rider.setVelocityX(vx);
+    rider.setVelocityY(vy);
+    rider.setSupport(support);
+}
+
+namespace collision {
+
+namespace {
+
+// Boxes in the trees are conservative doubles; exact tests always use the sim::Real boxes
+Aabb toAabb(const Box<sim::Real> &b) {
+    const double x = static_cast<double>(b.x);
+    const double y = static_cast<double>(b.y);
+    return Aabb{ x, y, x + static_cast<double>(b.w), y + static_cast<double>(b.h) };
+}
+
+// Static geometry gets a sliver of margin to absorb rounding; movers get room to travel
+constexpr double kStaticMargin = 0.5;
+constexpr double kDynamicMargin = 16.0;
+// Pairs are found from exact swept boxes grown by this much, not from the fattened proxies
+constexpr double kPairSlack = 1.0;
+
+} // namespace
+
+ColliderSet::ColliderSet() : static_(kStaticMargin), dynamicTree_(kDynamicMargin) {}
+
+void ColliderSet::clear() {
+    layer_.clear();
+    mask_.clear();
+    flags_.clear();
+    behaviours_.clear();
+    box_.clear();
+    swept_.clear();
+    proxy_.clear();
+    dynamic_.clear();
+    static_.clear();
+    dynamicTree_.clear();
+    triggers_.clear();
+    contacts_.clear();
+    pairStart_.clear();
+    others_.clear();
+}
+
+void ColliderSet::sync(const std::vector<Entity> &entities) {
+    if (entities.size() < flags_.size()) clear(); // list was rebuilt
+    const std::size_t n = entities.size();
+    layer_.resize(n, 0);
+    mask_.resize(n, 0);
+    flags_.resize(n, 0);
+    behaviours_.resize(n, behaviour::kNone);
+    box_.resize(n, Box<sim::Real>{});
+    swept_.resize(n, Aabb{});
+    proxy_.resize(n, -1);
+    dynamic_.resize(n, 0);
+    triggers_.clear();
+
+    for (std::uint32_t i = 0; i < n; ++i) {
+        const Entity &e = entities[i];
+        const bool enabled = !e.isDisabled();
+        const bool target = enabled && (e.isCollidable() || e.isTrigger());
+        const bool mover = enabled && e.isMovable();
+
+        std::uint8_t flags = 0;
+        if (target) flags |= ColliderTarget;
+        if (e.isTrigger()) flags |= ColliderTrigger;
+        if (e.isEnemy()) flags |= ColliderEnemy;
+        if (e.isPlatform()) flags |= ColliderPlatform;
+        flags_[i] = flags;
+        behaviours_[i] = e.getBehaviour();
+        layer_[i] = e.getCollisionLayer();
+        mask_[i] = e.getCollisionMask();
+        box_[i] = makeBox<sim::Real>(e);
+        swept_[i] = toAabb(box_[i]);
+        if (target && (flags & ColliderTrigger)) triggers_.push_back(i);
+
+        // Proxy lifetime: movers probe, targets are probed; switching trees means a fresh proxy
+        const bool want = target || mover;
+        if (proxy_[i] >= 0 && (!want || dynamic_[i] != static_cast<std::uint8_t>(mover))) {
+            (dynamic_[i] ? dynamicTree_ : static_).destroyProxy(proxy_[i]);
+            proxy_[i] = -1;
+        }
+        if (!want) continue;
+        AabbTree &tree = mover ? dynamicTree_ : static_;
+        if (proxy_[i] < 0) {
+            proxy_[i] = tree.createProxy(toAabb(box_[i]), i);
+            dynamic_[i] = static_cast<std::uint8_t>(mover);
+        } else {
+            tree.moveProxy(proxy_[i], toAabb(box_[i])); // no-op while inside the fat box
+        }
+    }
+}
+
+void ColliderSet::sweep(std::uint32_t entity, sim::Real targetX, sim::Real targetY) {
+    if (entity >= proxy_.size() || proxy_[entity] < 0 || !dynamic_[entity]) return;
+    const Box<sim::Real> &from = box_[entity];
+    const Aabb start = toAabb(from);
+    const Aabb end = toAabb(Box<sim::Real>{ targetX, targetY, from.w, from.h });
+    swept_[entity] = Aabb::merge(start, end);
+    dynamicTree_.moveProxy(proxy_[entity], swept_[entity], end.x0 - start.x0, end.y0 - start.y0);
+}
+
+void ColliderSet::findPairs() {
+    const std::uint32_t n = static_cast<std::uint32_t>(flags_.size());
+    pairStart_.assign(n + 1, 0);
+    others_.clear();
+
+    for (std::uint32_t m = 0; m < n; ++m) {
+        pairStart_[m] = static_cast<std::uint32_t>(others_.size());
+        if (proxy_[m] < 0 || !dynamic_[m]) continue;
+
+        // The trees' fattened boxes depend on how bodies moved before, which a restored state
+        // doesn't carry, so they only narrow the search: a pair is decided on the swept boxes
+        const Aabb &swept = swept_[m];
+        const Aabb query{ swept.x0 - kPairSlack, swept.y0 - kPairSlack, swept.x1 + kPairSlack, swept.y1 + kPairSlack };
+        auto visit = [&](const AabbTree &tree, int proxy) {
+            const std::uint32_t other = tree.getUserData(proxy);
+            if (other == m) return;
+            // Bit filters first; no box math for pairs that can never interact
+            if ((flags_[other] & (ColliderTarget | ColliderTrigger)) != ColliderTarget) return;
+            if (!canCollide(layer_[m], mask_[m], layer_[other], mask_[other])) return;
+            if (!query.overlaps(swept_[other])) return;
+            others_.push_back(other);
+        };
+        dynamicTree_.query(query, [&](int proxy) { visit(dynamicTree_, proxy); });
+        static_.query(query, [&](int proxy) { visit(static_, proxy); });
+
+        // Entity order keeps results independent of tree shape (which differs after a rollback)
+        std::sort(others_.begin() + pairStart_[m], others_.end());
+    }
+    pairStart_[n] = static_cast<std::uint32_t>(others_.size());
+}
+
+IndexRange ColliderSet::candidates(std::uint32_t mover) const {
+    if (mover + 1 >= pairStart_.size()) return IndexRange{ nullptr, nullptr };
+    const std::uint32_t *base = others_.data();
+    return IndexRange{ base + pairStart_[mover], base + pairStart_[mover + 1] };
+}
+
+void ColliderSet::update(std::uint32_t entity, const Entity &e) {
+    if (entity >= box_.size()) return;
+    box_[entity].x = e.getX();
+    box_[entity].y = e.getY();
+}
+
+void ColliderSet::queryBox(const Box<sim::Real> &box, LayerMask mask, std::vector<std::uint32_t> &out, bool includeTriggers) const {
+    out.clear();
+    const Aabb query = toAabb(box);
+    auto visit = [&](const AabbTree &tree, int proxy) {
+        const std::uint32_t i = tree.getUserData(proxy);
+        if (!(flags_[i] & ColliderTarget) || (layer_[i] & mask) == 0) return;
+        if (!includeTriggers && (flags_[i] & ColliderTrigger)) return;
+        if (overlaps(box, box_[i])) out.push_back(i);
+    };
+    dynamicTree_.query(query, [&](int proxy) { visit(dynamicTree_, proxy); });
+    static_.query(query, [&](int proxy) { visit(static_, proxy); });
+    std::sort(out.begin(), out.end());
+}
+
+void ColliderSet::collectTriggerContacts() {
+    contacts_.clear();
+    for (std::uint32_t t : triggers_) {
+        const std::size_t first = contacts_.size();
+        auto visit = [&](const AabbTree &tree, int proxy) {
+            const std::uint32_t i = tree.getUserData(proxy);
+            if ((flags_[i] & (ColliderTarget | ColliderTrigger)) != ColliderTarget) return;
+            if (!canCollide(layer_[t], mask_[t], layer_[i], mask_[i])) return;
+            if (overlaps(box_[t], box_[i])) contacts_.push_back(TriggerContact{ t, i });
+        };
+        const Aabb query = toAabb(box_[t]);
+        dynamicTree_.query(query, [&](int proxy) { visit(dynamicTree_, proxy); });
+        static_.query(query, [&](int proxy) { visit(static_, proxy); });
+        std::sort(contacts_.begin() + first, contacts_.end(),
+                  [](const TriggerContact &a, const TriggerContact &b) { return a.other < b.other; });
+    }
+}
+
+} // namespace collision
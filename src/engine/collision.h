@@ -3,14 +3,128 @@
 #define COLLISION_H
 
 #include <SDL3/SDL.h>
+#include <cstdint>
 #include <utility>
+#include <vector>
 
 #include "entity.h"
+#include "collision_layers.h"
+#include "aabb_tree.h"
+
+class World;
+
+// Axis-aligned box in simulation units
+template <typename Real>
+struct Box {
+    Real x, y, w, h;
+};
+
+namespace collision {
+
+// Role bits resolved once per sync so the movement test never reads the entity
+enum ColliderFlag : std::uint8_t
+{
+    ColliderEnemy = 1u << 0,    // resets a controllable mover on contact
+    ColliderPlatform = 1u << 1, // lands a controllable mover
+    ColliderTrigger = 1u << 2,  // reported, never blocks
+    ColliderTarget = 1u << 3,   // Collidable or Trigger: other bodies can touch it
+};
+
+// A trigger and a non-trigger collider overlapping after the physics pass
+struct TriggerContact
+{
+    std::uint32_t trigger;
+    std::uint32_t other;
+};
+
+// Contiguous run of entity indices
+struct IndexRange
+{
+    const std::uint32_t *first;
+    const std::uint32_t *last;
+    const std::uint32_t *begin() const { return first; }
+    const std::uint32_t *end() const { return last; }
+};
+
+// Broadphase for every enabled collider and mover, indexed by entity. Layer, mask and role
+// flags sit in parallel arrays next to the exact boxes so filtered pairs are rejected before any
+// rect math. Movable entities live in a dynamic AABB tree with fattened boxes; everything else in
+// a separate static tree that is only touched when static geometry actually changes.
+class ColliderSet
+{
+public:
+    ColliderSet();
+
+    // Add, remove and refit proxies to match the entities (once per tick, before physics)
+    void sync(const std::vector<Entity> &entities);
+    void clear();
+    // Grow a mover's proxy to cover its path from the current box to (targetX, targetY) this tick
+    void sweep(std::uint32_t entity, sim::Real targetX, sim::Real targetY);
+    // Enumerate every mover/target pair whose swept boxes overlap, once for the whole tick
+    void findPairs();
+    // Targets a mover may touch this tick, in entity order (valid after findPairs)
+    IndexRange candidates(std::uint32_t mover) const;
+    template <typename Fn>
+    void forEachPair(Fn &&fn) const
+    {
+        for (std::uint32_t m = 0; m + 1 < pairStart_.size(); ++m)
+            for (std::uint32_t other : candidates(m))
+                fn(m, other);
+    }
+    std::size_t pairCount() const { return others_.size(); }
+
+    // Refresh one entity's exact box after it moved; its proxy already covers the sweep
+    void update(std::uint32_t entity, const Entity &e);
+
+    // Entities whose layer is in mask and whose box overlaps the query, in entity order
+    void queryBox(const Box<sim::Real> &box, LayerMask mask, std::vector<std::uint32_t> &out, bool includeTriggers = false) const;
+
+    // Fill the contact list from the current boxes; triggers obey layers and masks like blockers
+    void collectTriggerContacts();
+    const std::vector<TriggerContact> &getTriggerContacts() const { return contacts_; }
+
+    // Per-entity data; only entries with ColliderTarget can be touched
+    std::size_t size() const { return flags_.size(); }
+    LayerMask layer(std::size_t i) const { return layer_[i]; }
+    LayerMask mask(std::size_t i) const { return mask_[i]; }
+    std::uint8_t flags(std::size_t i) const { return flags_[i]; }
+    behaviour::Id behaviourOf(std::size_t i) const { return behaviours_[i]; }
+    const Box<sim::Real> &box(std::size_t i) const { return box_[i]; }
+
+    const AabbTree &getStaticTree() const { return static_; }
+    const AabbTree &getDynamicTree() const { return dynamicTree_; }
+
+private:
+    std::vector<LayerMask> layer_;
+    std::vector<LayerMask> mask_;
+    std::vector<std::uint8_t> flags_;
+    std::vector<behaviour::Id> behaviours_; // on-collision response, called without touching the Entity
+    std::vector<Box<sim::Real>> box_;
+    std::vector<Aabb> swept_;           // box_ merged with this tick's predicted end (movers)
+    std::vector<std::int32_t> proxy_;   // -1 when the entity has no proxy
+    std::vector<std::uint8_t> dynamic_; // which tree proxy_ lives in
+    AabbTree static_;
+    AabbTree dynamicTree_;
+    std::vector<std::uint32_t> triggers_;
+    std::vector<TriggerContact> contacts_;
+    std::vector<std::uint32_t> pairStart_; // candidates of mover m: others_[pairStart_[m]..pairStart_[m + 1])
+    std::vector<std::uint32_t> others_;
+};
+
+} // namespace collision
 
 // Returns which axes overlap: {xOverlap, yOverlap}
 std::pair<bool, bool> areEntitiesColliding(const Entity &a, const Entity &b);
 
-// Move entity to target while resolving collisions; updates position and velocity
-void handle_collision(Entity& e, float targetX, float targetY, float targetVx, float targetVy);
+// Move entity to target while resolving collisions; updates position and velocity.
+// Instantiated for the configured simulation type (sim::Real).
+template <typename Real>
+void handle_collision(World& world, Entity& e, Real targetX, Real targetY, Real targetVx, Real targetVy);
+
+extern template void handle_collision<sim::Real>(World&, Entity&, sim::Real, sim::Real, sim::Real, sim::Real);
+
+// Move a rider by its support's displacement over tick (resolved like any other move) before
+// the rider's own step. Drops the contact when the rider no longer sits on the support.
+void carry_with_support(World& world, Entity& rider, unsigned long long tick);
 
 #endif // COLLISION_H
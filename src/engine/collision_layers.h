@@ -0,0 +1,31 @@
+// Collision layer and mask bits
+#ifndef COLLISION_LAYERS_H
+#define COLLISION_LAYERS_H
+
+#include <cstdint>
+
+namespace collision {
+
+using LayerMask = std::uint32_t;
+
+// An entity sits on one or more layers and collides with the layers in its mask.
+// Bits above LayerTerrain are free for game-specific layers.
+enum Layer : LayerMask
+{
+    LayerDefault = 1u << 0,
+    LayerPlayer = 1u << 1,
+    LayerEnemy = 1u << 2,
+    LayerPlatform = 1u << 3,
+    LayerTerrain = 1u << 4, // the static tile layer
+    LayerAll = 0xffffffffu,
+};
+
+// A pair is tested only when each side's layer is in the other's mask
+inline bool canCollide(LayerMask layerA, LayerMask maskA, LayerMask layerB, LayerMask maskB)
+{
+    return (layerA & maskB) != 0 && (layerB & maskA) != 0;
+}
+
+} // namespace collision
+
+#endif
@@ -1,13 +1,12 @@
 #include "engine.h"
 
-#include "physics.h"
-#include "collision.h"
 #include "../input.h"
 #include "../input_handler.h"
+#include <thread>
 #include <utility>
 
 Engine::Engine()
-    : window_(nullptr), renderer_(nullptr) {}
+    : window_(nullptr), renderer_(nullptr), surface_(nullptr), running_(false), renderNS_(0), drawCalls_(0) {}
 
 Engine::~Engine()
 {
@@ -30,174 +29,248 @@ bool Engine::init(const char *title, int width, int height)
     }
 
     SDL_SetWindowResizable(window_, true);
+    // Present waits for vsync on the render thread only; simulation keeps its own pace
+    SDL_SetRenderVSync(renderer_, 1);
     // Initialize logical render size baseline and default scaling mode (delegated)
-    scaler_.init(window_, renderer_, width, height, entities_);
-    // Register scaling controller with input to handle key toggles
-    input_handler::setScalingController(&scaler_, renderer_, &entities_);
+    scaler_.init(window_, renderer_, width, height, world_.getEntities());
+    world_.setViewSize(width, height);
     return true;
 }
 
+bool Engine::initHeadless(int width, int height)
+{
+    if (!SDL_Init(0))
+    {
+        SDL_Log("Couldn't initialize SDL: %s", SDL_GetError());
+        return false;
+    }
 
-void handleSpriteSheetAnimation(Entity &e, unsigned long long frame)
+    // Logical size still defines the view used for LOD culling
+    scaler_.logical_w = width;
+    scaler_.logical_h = height;
+    world_.setViewSize(width, height);
+    return true;
+}
+
+bool Engine::initOffscreen(int width, int height, int outputScale)
 {
-    const int frameRowCount = e.getFrameRowCount();
-    const int frameColumnCount = e.getFrameColumnCount();
-    const int animationDelay = e.getAnimationDelay();
+    if (!SDL_Init(0))
+    {
+        SDL_Log("Couldn't initialize SDL: %s", SDL_GetError());
+        return false;
+    }
 
-    if (frameColumnCount > 0 && animationDelay > 0 && frame % animationDelay == 0)
+    const int scale = outputScale > 0 ? outputScale : 1;
+    surface_ = SDL_CreateSurface(width * scale, height * scale, SDL_PIXELFORMAT_ARGB8888);
+    if (!surface_ || !(renderer_ = SDL_CreateSoftwareRenderer(surface_)))
     {
-        int currentFrameColumn = e.getCurrentFrameColumn();
-        int currentFrameRow = e.getCurrentFrameRow();
+        SDL_Log("Couldn't create software renderer: %s", SDL_GetError());
+        cleanup();
+        return false;
+    }
+
+    // The surface plays the window: logical size as in init(), output window_scale times larger
+    scaler_.init(nullptr, renderer_, width, height, world_.getEntities());
+    scaler_.window_scale = scale;
+    world_.setViewSize(width, height);
+    return true;
+}
 
-        if (currentFrameColumn + 1 >= frameColumnCount)
+void Engine::renderOffscreen(double phase)
+{
+    // Time is pinned to the snapshot so the same tick and phase always give the same image
+    snapshots_.acquire();
+    const Uint64 sinceNS = static_cast<Uint64>(phase * static_cast<double>(scheduler_.getTickPeriodNS()));
+    render(snapshots_.current().timeNS + sinceNS);
+}
+
+void Engine::run()
+{
+    if (!window_ || !renderer_)
+    {
+        return;
+    }
+
+    running_ = true;
+    snapshots_.reset();
+    publishSnapshot();
+    // Flow fields are built in the simulation thread's spare time rather than on their own thread
+    world_.getNavigation().setJobs(&jobs_);
+
+    // SDL wants rendering and event pumping on the thread that created the window, so the
+    // calling thread renders and the simulation moves to a worker
+    std::thread simulation(&Engine::simulationLoop, this);
+
+    SDL_Event event;
+    while (running_)
+    {
+        while (SDL_PollEvent(&event))
         {
-            currentFrameColumn = 0;
-            currentFrameRow++;
-            if (currentFrameRow >= frameRowCount)
+            if (event.type == SDL_EVENT_QUIT)
             {
-                currentFrameRow = 0;
+                running_ = false;
             }
+            else if (event.type == SDL_EVENT_MOUSE_WHEEL)
+            {
+                scaler_.onMouseWheel(event, window_);
+            }
+            else if (event.type == SDL_EVENT_KEY_DOWN)
+            {
+                input::keyDown(event.key.scancode);
+            }
+            // Forward discrete events (mouse, keydown) to input module
+            input_handler::handleEvent(event, scaler_, renderer_, snapshots_.current());
         }
-        else
-        {
-            currentFrameColumn++;
-        }
+        // Hand this frame's keyboard state to the simulation thread
+        input::capture();
 
-        e.setCurrentFrameColumn(currentFrameColumn);
-        e.setCurrentFrameRow(currentFrameRow);
+        snapshots_.acquire();
+        render(SDL_GetTicksNS());
     }
+
+    simulation.join();
+    world_.getNavigation().setJobs(nullptr);
 }
 
-void handleAutoMovingEntityUpdate(Entity &e)
+void Engine::simulationLoop()
 {
-    if (e.isControllable() or !e.isMovable() or !e.hasPathVectors())
-        return;
-
-    int updatesRemaining = e.getPathVectorUpdatesRemaining();
-    if (updatesRemaining <= 0)
+    scheduler_.start();
+    while (running_)
     {
-        int nextIndex = e.getNextPathVectorIndex();
-        const std::vector<Entity::PathVector> &pathVectors = e.getPathVectors();
-        const Entity::PathVector &pv = pathVectors[nextIndex];
-        e.setVelocityX(pv.vx);
-        e.setVelocityY(pv.vy);
-        e.setPathVectors(pathVectors); // Refresh to update internal state
-        e.setNextPathVectorIndex((nextIndex + 1) % pathVectors.size());
-        e.setPathVectorUpdatesRemaining(pv.updates);
+        simulateTick();
+        // Deferred work fills the time until the next tick is due
+        const Uint64 nowNS = SDL_GetTicksNS();
+        const Uint64 dueNS = scheduler_.getNextTickNS();
+        jobs_.run(dueNS > nowNS ? dueNS - nowNS : 0);
+        scheduler_.waitForNextTick();
     }
-    else
+}
+
+void Engine::simulateTick()
+{
+    // Detect input snapshot for this tick and handle gameplay input
+    const std::uint64_t inputStartNS = metrics::nowNS();
+    input::detect();
+    world_.getControls().handleInput();
+    const std::uint64_t inputNS = metrics::nowNS() - inputStartNS;
+
+    world_.step();
+    publishSnapshot();
+
+    if (metrics_.isOpen())
     {
-        e.setPathVectorUpdatesRemaining(updatesRemaining - 1);
+        metrics::Frame frame = world_.getFrameMetrics();
+        frame.stageNS[metrics::StageInput] = static_cast<std::uint32_t>(inputNS);
+        frame.renderNS = renderNS_.load(std::memory_order_relaxed);
+        frame.drawCalls = drawCalls_.load(std::memory_order_relaxed);
+        metrics_.publish(frame);
     }
 }
 
-void Engine::run()
+bool Engine::enableMetrics(const std::string &name)
 {
-    if (!window_ || !renderer_)
+    metrics_.close();
+    if (name.empty()) return true;
+    if (!metrics_.open(name))
     {
-        return;
+        SDL_Log("Couldn't create metrics ring '%s'", name.c_str());
+        return false;
     }
+    return true;
+}
 
-    bool running = true;
-    SDL_Event event;
-    unsigned long long tick = 0ULL;
-    unsigned long long frame = 0ULL;
-    while (running)
+void Engine::publishSnapshot()
+{
+    render::Snapshot &snap = snapshots_.beginWrite();
+    snap.sprites.clear();
+    snap.tick = world_.getTick();
+    snap.paused = world_.getControls().isPaused();
+
+    // Capture in insertion order so layering stays stable
+    const std::vector<Entity> &entities = world_.getEntities();
+    for (std::uint32_t i = 0; i < entities.size(); ++i)
     {
-        ++tick;
-        if (tick % 10000000 == 0)
+        const Entity &e = entities[i];
+        if (e.isDisabled() || !e.getTexture()) continue;
+
+        // Source rectangle from spritesheet
+        SDL_FRect src{static_cast<float>(e.getCurrentFrameColumn()) * e.getWidth(), e.getCurrentFrameRow() * e.getHeight(), e.getWidth(), e.getHeight()};
+
+        // Destination rectangle on screen, before and after the entity's last step
+        const float scale = e.getScale();
+        SDL_FRect dst{sim::toFloat(e.getX()), sim::toFloat(e.getY()), e.getWidth() * scale, e.getHeight() * scale};
+        SDL_FRect prevDst = dst;
+        if (e.isMovable())
         {
-            frame++;
+            prevDst.x = sim::toFloat(e.getPreviousX());
+            prevDst.y = sim::toFloat(e.getPreviousY());
+        }
 
-            // Detect input snapshot for this frame and handle gameplay input
-            input::detect();
+        snap.sprites.push_back(render::Sprite{i, e.getTexture(), src, prevDst, dst, e.getLastStepTick(), e.getLastStepSpan()});
+    }
 
-            // Scaling toggles are handled in input_handler now
-            input_handler::handleInput();
-            while (SDL_PollEvent(&event))
-            {
-                if (event.type == SDL_EVENT_QUIT)
-                {
-                    running = false;
-                }
-                else if (event.type == SDL_EVENT_MOUSE_WHEEL)
-                {
-                    scaler_.onMouseWheel(event, window_);
-                }
-                // Forward discrete events (mouse, keydown) to input module
-                input_handler::handleEvent(event);
-            }
+    snap.particles.clear();
+    world_.getParticles().capture(snap.particles);
 
-            // Clear frame
-            SDL_SetRenderDrawColor(renderer_, 0, 0, 255, 255);
-            SDL_RenderClear(renderer_);
-
-            // Update, animate and render entities
-            for (auto &e : entities_)
-            {   
-                if(e.isDisabled()) continue;
-                if (!input_handler::isPaused()) {
-
-                    if(e.isControllable() && e.isReset()) {
-                        e.setX(500);
-                        e.setY(-100);
-                        e.setVelocityX(0);
-                        e.setVelocityY(0);
-                        e.setReset(false);
-                    }
-
-                    handleSpriteSheetAnimation(e, frame);
-                    handleAutoMovingEntityUpdate(e);
-                    
-                    // // Allow custom per-entity updates
-                    // e.update();
-
-                    // Apply physics (velocity, acceleration, collisions)
-                    std::pair<std::pair<float, float>, std::pair<float, float>> targetVectors = Physics::applyPhysics(e);
-
-                    handle_collision(e, targetVectors.first.first, targetVectors.first.second, targetVectors.second.first, targetVectors.second.second);
-                }
-
-                // Source rectangle from spritesheet
-                SDL_FRect src{static_cast<float>(e.getCurrentFrameColumn()) * e.getWidth(), e.getCurrentFrameRow() * e.getHeight(), e.getWidth(), e.getHeight()};
-
-                // Destination rectangle on screen
-                const float scale = e.getScale();
-                SDL_FRect dst{e.getX(), e.getY(), e.getWidth() * scale, e.getHeight() * scale};
-
-                // Draw
-                if (SDL_Texture *tex = e.getTexture())
-                {
-                    SDL_RenderTexture(renderer_, tex, &src, &dst);
-                }
-            }
+    snap.timeNS = SDL_GetTicksNS();
+    snapshots_.publish();
+}
 
-            // If paused, draw a translucent overlay with a pause icon
-            if (input_handler::isPaused()) {
-                int irw = 0, irh = 0;
-                SDL_GetRenderOutputSize(renderer_, &irw, &irh);
-                const float rw = static_cast<float>(irw);
-                const float rh = static_cast<float>(irh);
-                SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_BLEND);
-                SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 160);
-                SDL_FRect fade{0.0f, 0.0f, rw, rh};
-                SDL_RenderFillRect(renderer_, &fade);
-            }
+void Engine::render(Uint64 nowNS)
+{
+    const std::uint64_t startNS = metrics::nowNS();
+    const render::Snapshot &curr = snapshots_.current();
+    std::size_t drawCalls = 0;
 
-            SDL_RenderPresent(renderer_);
-        }
+    // Clear frame
+    SDL_SetRenderDrawColor(renderer_, 0, 0, 255, 255);
+    SDL_RenderClear(renderer_);
+
+    // Terrain first: one cached texture per chunk instead of one draw per tile
+    if (TileLayer *terrain = world_.getTerrain())
+    {
+        drawCalls += static_cast<std::size_t>(terrain->render(renderer_));
+    }
+
+    for (std::size_t i = 0; i < curr.sprites.size(); ++i)
+    {
+        const render::Sprite &s = curr.sprites[i];
+
+        // Draw one step behind each entity, blending across its last step; paused frames hold still
+        const unsigned long long ticksAgo = curr.tick > s.stateTick ? curr.tick - s.stateTick : 0ULL;
+        const float alpha = curr.paused ? 1.0f : scheduler_.alpha(nowNS, curr.timeNS, ticksAgo, s.span);
+        const SDL_FRect dst = render::lerp(s.prevDst, s.dst, alpha);
+
+        // Draw
+        SDL_RenderTexture(renderer_, s.texture, &s.src, &dst);
     }
+    drawCalls += curr.sprites.size();
+
+    // Particles step every tick, so they blend across the last one
+    drawCalls += particles_.draw(renderer_, curr.particles, curr.paused ? 1.0f : scheduler_.alpha(nowNS, curr.timeNS, 0ULL, 1));
+
+    // If paused, draw a translucent overlay with a pause icon
+    if (curr.paused) {
+        int irw = 0, irh = 0;
+        SDL_GetRenderOutputSize(renderer_, &irw, &irh);
+        const float rw = static_cast<float>(irw);
+        const float rh = static_cast<float>(irh);
+        SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 160);
+        SDL_FRect fade{0.0f, 0.0f, rw, rh};
+        SDL_RenderFillRect(renderer_, &fade);
+        ++drawCalls;
+    }
+
+    SDL_RenderPresent(renderer_);
+    drawCalls_.store(static_cast<std::uint32_t>(drawCalls), std::memory_order_relaxed);
+    renderNS_.store(static_cast<std::uint32_t>(metrics::nowNS() - startNS), std::memory_order_relaxed);
 }
 
 void Engine::cleanup()
 {
-    for (auto &e : entities_)
-    {
-        if (SDL_Texture *tex = e.getTexture())
-        {
-            SDL_DestroyTexture(tex);
-        }
-    }
+    world_.releaseTextures();
+    metrics_.close(); // readers see the writer go away
 
     if (renderer_)
     {
@@ -209,11 +282,17 @@ void Engine::cleanup()
         SDL_DestroyWindow(window_);
         window_ = nullptr;
     }
+    if (surface_)
+    {
+        SDL_DestroySurface(surface_);
+        surface_ = nullptr;
+    }
     SDL_Quit();
 }
 
-Entity *Engine::addEntity(const Entity &entity)
+void Engine::setSimulationRate(double hz)
 {
-    entities_.push_back(entity);
-    return &entities_.back();
+    if (hz <= 0.0) return;
+    scheduler_.setTickRate(hz);
+    world_.getPhysics().setDeltaTime(sim::Real(1.0 / hz));
 }
@@ -1,13 +1,19 @@
 #ifndef ENGINE_H
 #define ENGINE_H
 
-#include "entity.h"
+#include "world.h"
+#include "render_snapshot.h"
+#include "frame_scheduler.h"
 #include "scaling.h"
+#include "particles.h"
+#include "metrics.h"
+#include "jobs.h"
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_main.h>
 #include <SDL3_image/SDL_image.h>
+#include <atomic>
 #include <iostream>
-#include <functional>
+#include <memory>
 #include <vector>
 
 class Engine
@@ -15,24 +21,95 @@ class Engine
 private:
     SDL_Window *window_;
     SDL_Renderer *renderer_;
-    std::vector<Entity> entities_;
+    SDL_Surface *surface_;       // Offscreen target of the software renderer (no window)
+    World world_;                // Everything the simulation owns
     scaling::Controller scaler_; // Rendering scaling controller
 
+    // Simulation runs on its own thread and hands frames to the render thread through snapshots
+    std::atomic<bool> running_;
+    render::SnapshotBuffer snapshots_;
+    FrameScheduler scheduler_; // Paces simulation ticks and supplies interpolation alpha
+    fx::ParticleRenderer particles_; // Batched quads for the snapshot's particles (render thread)
+    jobs::TimeSlicer jobs_;          // Deferrable work, run on the simulation thread between ticks
+
+    // Per-tick counters for external tools; only the simulation thread writes the ring, so the
+    // render thread hands its numbers over through these
+    metrics::Publisher metrics_;
+    std::atomic<std::uint32_t> renderNS_;
+    std::atomic<std::uint32_t> drawCalls_;
+
+    void simulationLoop();
+    void publishSnapshot();
+    void render(Uint64 nowNS);
+
 public:
     Engine();
     ~Engine();
 
     bool init(const char* title, int width, int height);
+    // No window or renderer: for servers, benchmarks and tools that drive step() themselves
+    bool initHeadless(int width, int height);
+    bool isHeadless() const { return renderer_ == nullptr; }
+    // No window: SDL's software renderer draws into a surface of width x height times
+    // outputScale, through the same draw path as run(). For render benchmarks on GPU-less machines.
+    bool initOffscreen(int width, int height, int outputScale = 1);
+    SDL_Surface* getOffscreenSurface() const { return surface_; }
+    // Draw the latest simulated tick offscreen, phase (0..1) of a tick after it was published
+    void renderOffscreen(double phase);
     void run();
     void cleanup();
 
-    Entity* addEntity(const Entity &entity);
+    // The simulation this engine renders; headless tools can drive it directly
+    World& getWorld() { return world_; }
+    const World& getWorld() const { return world_; }
+
+    // Advance the simulation by exactly one tick on the calling thread
+    void step() { world_.step(); }
+    // One iteration of the simulation thread: input, step() and a render snapshot
+    void simulateTick();
+
+    // Remove all entities and terrain and restart the tick count (not while run() is active)
+    void reset() { world_.reset(); }
+
+    Entity* addEntity(const Entity &entity) { return world_.addEntity(entity); }
+    Entity* getEntity(std::size_t index) { return world_.getEntity(index); }
+    const std::vector<Entity>& getEntities() const { return world_.getEntities(); }
+
+    // Create (or replace) the static terrain layer; tiles are added through the returned layer
+    TileLayer* createTerrain(int tileWidth, int tileHeight, int columns, int rows, float originX, float originY)
+    {
+        return world_.createTerrain(tileWidth, tileHeight, columns, rows, originX, originY);
+    }
+    TileLayer* getTerrain() const { return world_.getTerrain(); }
+
+    // Distance tiers for reduced update rates (call before run)
+    void setLodConfig(const lod::Config &config) { world_.setLodConfig(config); }
+
+    // Work that can wait a few frames (custom entity updates, cache upkeep, tool refreshes): run()
+    // gives it a budget of each tick's spare time, and background jobs whatever is left. Jobs run
+    // on the simulation thread, so they may touch the world, but their timing varies from run to
+    // run: keep anything lock-step peers or golden traces depend on inside World::step(). Navigation
+    // builds its flow fields here, as a Normal job; World::step() adopts each on a fixed tick.
+    jobs::TimeSlicer& getJobs() { return jobs_; }
+
+    // Simulation tick rate in Hz (call before run); rendering interpolates so it can run faster
+    void setSimulationRate(double hz);
+
+    // Publish per-tick metrics to the named shared-memory ring (read by tools/loopy_metrics).
+    // Call before run; an empty name stops publishing.
+    bool enableMetrics(const std::string &name);
+
+    // Render time and draw calls of the last frame drawn
+    std::uint32_t getLastRenderNS() const { return renderNS_.load(std::memory_order_relaxed); }
+    std::uint32_t getLastDrawCalls() const { return drawCalls_.load(std::memory_order_relaxed); }
+
+    // Switch between scaling modes and re-apply to the renderer and entity textures (not while
+    // run() is active; its render thread toggles through handleEvent)
+    void setScalingMode(scaling::ScalingMode mode) { scaler_.setMode(mode, renderer_, world_.getEntities()); }
+    scaling::ScalingMode getScalingMode() const { return scaler_.mode; }
 
     // Expose renderer for texture creation (read-only access)
     SDL_Renderer* getRenderer() const { return renderer_; }
-
-    // Read-only access to entities for collision checks
-    const std::vector<Entity>& getEntities() const { return entities_; }
 };
 
 #endif
@@ -1,358 +1,655 @@
 #include "entity.h"
 
+#include "physics.h"
+
+// With a 4-byte simulation type the hot fields and the cold row pointer fill exactly one cache line
+static_assert(sizeof(sim::Real) != 4 || sizeof(Entity) == 64, "Entity hot record outgrew its cache line");
+
 // Constructor for the static entities
-Entity::Entity(std::string name, float x, float y, float width, float height, SDL_Texture *texture, int frameColumnCount, int frameRowCount, int animationDelay, bool isAffectedByGravity, bool isEnemy, bool isPlatform, const std::function<void(Entity &)> &updateFunction)
-    : name_(name),
-      x_(x),
+Entity::Entity(std::string name, float x, float y, float width, float height, SDL_Texture *texture, int frameColumnCount, int frameRowCount, int animationDelay, bool isAffectedByGravity, bool isEnemy, bool isPlatform, behaviour::Callback updateFunction)
+    : x_(x),
       y_(y),
-      width_(width),
-      height_(height),
       velocityX_(0.0f),
       velocityY_(0.0f),
       accelerationX_(0.0f),
       accelerationY_(0.0f),
-      isMovable_(false),
-      isControllable_(false),
-      isEnemy_(isEnemy),
-      isJumping_(false),
-      isReset_(false),
-      isPlatform_(isPlatform),
-      isDisabled_(false),
-      isCollidable_(true),
-      texture_(texture),
-      frameColumnCount_(frameColumnCount),
-      frameRowCount_(frameRowCount),
-      currentFrameRow_(0),
-      currentFrameColumn_(0),
-      animationDelay_(animationDelay),
-      scale_(1.0f),
-      isAffectedByGravity(isAffectedByGravity),
-      updateFunction_(updateFunction),
-      pathVectors_(),
-      nextPathVectorIndex_(-1),
-      pathVectorUpdatesRemaining_(0) {}
+      prevX_(x),
+      prevY_(y),
+      lastStepTick_(0),
+      components_(ecs::Collidable),
+      support_(-1),
+      behaviour_(behaviour::intern(updateFunction)),
+      lastStepSpan_(1),
+      tickDivisor_(1),
+      nextTickDivisor_(1),
+      flags_(FlagOwnsCold),
+      cold_(new Cold{0, 0, -1, 0, std::move(name), texture, width, height, 1.0f, frameColumnCount, frameRowCount, animationDelay, {}, 0, collision::LayerAll, 1, 1, sim::Real(0)})
+{
+    setComponent(ecs::Gravity, isAffectedByGravity);
+    setComponent(ecs::Enemy, isEnemy);
+    setComponent(ecs::Platform, isPlatform);
+    refreshDerivedComponents();
+}
 
 // Constructor for the Non-static entities
 Entity::Entity(std::string name, float x, float y, float width, float height, float velocityX, float velocityY, float accelerationX,
                float accelerationY, bool isMovable, bool isControllable, bool isEnemy, bool isPlatform, bool isCollidable, SDL_Texture *texture, int frameColumnCount,
-               int frameRowCount, int animationDelay, float scale, bool isAffectedByGravity, const std::function<void(Entity &)> &updateFunction)
-    : name_(name),
-      x_(x),
+               int frameRowCount, int animationDelay, float scale, bool isAffectedByGravity, behaviour::Callback updateFunction)
+    : x_(x),
       y_(y),
-      width_(width),
-      height_(height),
       velocityX_(velocityX),
       velocityY_(velocityY),
       accelerationX_(accelerationX),
       accelerationY_(accelerationY),
-      isMovable_(isMovable),
-      isControllable_(isControllable),
-      isEnemy_(isEnemy),
-      isJumping_(false),
-      isReset_(false),
-      isPlatform_(isPlatform),
-      isCollidable_(isCollidable),
-      isDisabled_(false),
-      texture_(texture),
-      frameColumnCount_(frameColumnCount),
-      frameRowCount_(frameRowCount),
-      currentFrameRow_(0),
-      currentFrameColumn_(0),
-      animationDelay_(animationDelay),
-      scale_(scale),
-      isAffectedByGravity(isAffectedByGravity),
-      updateFunction_(updateFunction),
-      pathVectors_(),
-      nextPathVectorIndex_(-1),
-      pathVectorUpdatesRemaining_(0) {}
-
-std::string Entity::getName() const
-{
-    return name_;
-}
-
-float Entity::getX() const
+      prevX_(x),
+      prevY_(y),
+      lastStepTick_(0),
+      components_(0),
+      support_(-1),
+      behaviour_(behaviour::intern(updateFunction)),
+      lastStepSpan_(1),
+      tickDivisor_(1),
+      nextTickDivisor_(1),
+      flags_(FlagOwnsCold),
+      cold_(new Cold{0, 0, -1, 0, std::move(name), texture, width, height, scale, frameColumnCount, frameRowCount, animationDelay, {}, 0, collision::LayerAll, 1, 1, sim::Real(0)})
+{
+    setComponent(ecs::Movable, isMovable);
+    setComponent(ecs::Controllable, isControllable);
+    setComponent(ecs::Gravity, isAffectedByGravity);
+    setComponent(ecs::Enemy, isEnemy);
+    setComponent(ecs::Platform, isPlatform);
+    setComponent(ecs::Collidable, isCollidable);
+    refreshDerivedComponents();
+}
+
+Entity::Entity(const Entity &other)
+    : Entity(other, new Cold(*other.cold_), true)
+{
+}
+
+Entity::Entity(const Entity &other, Cold *cold, bool owns) : cold_(cold)
+{
+    copyHot(other, owns);
+}
+
+Entity::Entity(Entity &&other) noexcept : Entity(other, other.cold_, (other.flags_ & FlagOwnsCold) != 0)
+{
+    other.flags_ = static_cast<std::uint8_t>(other.flags_ & ~FlagOwnsCold);
+}
+
+Entity &Entity::operator=(const Entity &other)
+{
+    if (this != &other)
+        *this = Entity(other);
+    return *this;
+}
+
+Entity &Entity::operator=(Entity &&other) noexcept
+{
+    if (this != &other)
+    {
+        if (flags_ & FlagOwnsCold) delete cold_;
+        copyHot(other, (other.flags_ & FlagOwnsCold) != 0);
+        cold_ = other.cold_;
+        other.flags_ = static_cast<std::uint8_t>(other.flags_ & ~FlagOwnsCold);
+    }
+    return *this;
+}
+
+void Entity::copyHot(const Entity &other, bool ownsCold)
+{
+    x_ = other.x_;
+    y_ = other.y_;
+    velocityX_ = other.velocityX_;
+    velocityY_ = other.velocityY_;
+    accelerationX_ = other.accelerationX_;
+    accelerationY_ = other.accelerationY_;
+    prevX_ = other.prevX_;
+    prevY_ = other.prevY_;
+    lastStepTick_ = other.lastStepTick_;
+    components_ = other.components_;
+    support_ = other.support_;
+    behaviour_ = other.behaviour_;
+    lastStepSpan_ = other.lastStepSpan_;
+    tickDivisor_ = other.tickDivisor_;
+    nextTickDivisor_ = other.nextTickDivisor_;
+    flags_ = static_cast<std::uint8_t>(ownsCold ? other.flags_ | FlagOwnsCold : other.flags_ & ~FlagOwnsCold);
+}
+
+Entity::~Entity()
+{
+    if (flags_ & FlagOwnsCold) delete cold_;
+}
+
+const std::string &Entity::getName() const
+{
+    return cold_->name;
+}
+
+sim::Real Entity::getX() const
 {
     return x_;
 }
 
-float Entity::getY() const
+sim::Real Entity::getY() const
 {
     return y_;
 }
 
 float Entity::getWidth() const
 {
-    return width_;
+    return cold_->width;
 }
 
 float Entity::getHeight() const
 {
-    return height_;
+    return cold_->height;
 }
 
-float Entity::getVelocityX() const
+sim::Real Entity::getVelocityX() const
 {
     return velocityX_;
 }
 
-float Entity::getVelocityY() const
+sim::Real Entity::getVelocityY() const
 {
     return velocityY_;
 }
 
-float Entity::getAccelerationX() const
+sim::Real Entity::getAccelerationX() const
 {
     return accelerationX_;
 }
 
-float Entity::getAccelerationY() const
+sim::Real Entity::getAccelerationY() const
 {
     return accelerationY_;
 }
 
 bool Entity::isMovable() const
 {
-    return isMovable_;
+    return (components_ & ecs::Movable) != 0;
 }
 
 bool Entity::isControllable() const
 {
-    return isControllable_;
+    return (components_ & ecs::Controllable) != 0;
 }
 
 bool Entity::isEnemy() const
 {
-    return isEnemy_;
+    return (components_ & ecs::Enemy) != 0;
 }
 
 bool Entity::isJumping() const
 {
-    return isJumping_;
+    return (flags_ & FlagJumping) != 0;
 }
 
 bool Entity::isPlatform() const
 {
-    return isPlatform_;
-}
-
-bool Entity::isReset() const
-{
-    return isReset_;
+    return (components_ & ecs::Platform) != 0;
 }
 
 bool Entity::isCollidable() const
 {
-    return isCollidable_;
+    return (components_ & ecs::Collidable) != 0;
 }
 
 bool Entity::isDisabled() const
 {
-    return isDisabled_;
+    return (components_ & ecs::Disabled) != 0;
 }
 
 bool Entity::getisAffectedByGravity() const
 {
-    return isAffectedByGravity;
+    return (components_ & ecs::Gravity) != 0;
 }
 
 SDL_Texture *Entity::getTexture() const
 {
-    return texture_;
+    return cold_->texture;
 }
 
 int Entity::getFrameColumnCount() const
 {
-    return frameColumnCount_;
+    return cold_->frameColumnCount;
 }
 
 int Entity::getFrameRowCount() const
 {
-    return frameRowCount_;
+    return cold_->frameRowCount;
 }
 
 int Entity::getCurrentFrameRow() const
 {
-    return currentFrameRow_;
+    return cold_->currentFrameRow;
 }
 
 int Entity::getCurrentFrameColumn() const
 {
-    return currentFrameColumn_;
+    return cold_->currentFrameColumn;
 }
 
 int Entity::getAnimationDelay() const
 {
-    return animationDelay_;
+    return cold_->animationDelay;
 }
 
 float Entity::getScale() const
 {
-    return scale_;
+    return cold_->scale;
+}
+
+behaviour::Callback Entity::getUpdateFunction() const
+{
+    return behaviour::callbackOf(behaviour_);
 }
 
-std::function<void(Entity &)> Entity::getUpdateFunction() const
+behaviour::Id Entity::getBehaviour() const
 {
-    return updateFunction_;
+    return behaviour_;
 }
 
-const std::vector<Entity::PathVector> &Entity::getPathVectors() const { return pathVectors_; }
-int Entity::getNextPathVectorIndex() const { return nextPathVectorIndex_; }
-int Entity::getPathVectorUpdatesRemaining() const { return pathVectorUpdatesRemaining_; }
-bool Entity::hasPathVectors() const { return !pathVectors_.empty() && nextPathVectorIndex_ >= 0 && nextPathVectorIndex_ < (int)pathVectors_.size(); }
+const std::vector<Entity::PathVector> &Entity::getPathVectors() const { return cold_->pathVectors; }
+int Entity::getNextPathVectorIndex() const { return cold_->nextPathVectorIndex; }
+int Entity::getPathVectorUpdatesRemaining() const { return cold_->pathVectorUpdatesRemaining; }
+bool Entity::hasPathVectors() const { return !cold_->pathVectors.empty() && cold_->nextPathVectorIndex >= 0 && cold_->nextPathVectorIndex < (int)cold_->pathVectors.size(); }
+sim::Real Entity::getPreviousX() const { return prevX_; }
+sim::Real Entity::getPreviousY() const { return prevY_; }
+int Entity::getTickDivisor() const { return tickDivisor_; }
+int Entity::getLastStepSpan() const { return lastStepSpan_; }
+unsigned long long Entity::getLastStepTick() const { return lastStepTick_; }
+bool Entity::isCulled() const { return (components_ & ecs::Culled) != 0; }
+int Entity::getSupport() const { return support_; }
+bool Entity::isTrigger() const { return (components_ & ecs::Trigger) != 0; }
+bool Entity::isNavigator() const { return (components_ & ecs::Navigator) != 0; }
+sim::Real Entity::getNavigationSpeed() const { return cold_->navigationSpeed; }
+collision::LayerMask Entity::getCollisionMask() const { return cold_->collisionMask; }
+
+collision::LayerMask Entity::getCollisionLayer() const
+{
+    if (cold_->collisionLayer != 0)
+        return cold_->collisionLayer;
+    if (components_ & ecs::Controllable)
+        return collision::LayerPlayer;
+    if (components_ & ecs::Enemy)
+        return collision::LayerEnemy;
+    if (components_ & ecs::Platform)
+        return collision::LayerPlatform;
+    return collision::LayerDefault;
+}
+ecs::Signature Entity::getComponents() const { return components_; }
+bool Entity::hasComponents(ecs::Signature mask) const { return (components_ & mask) == mask; }
 
 void Entity::setName(const std::string &name)
 {
-    name_ = name;
+    cold_->name = name;
 }
 
-void Entity::setX(float x)
+void Entity::setX(sim::Real x)
 {
     x_ = x;
 }
 
-void Entity::setY(float y)
+void Entity::setY(sim::Real y)
 {
     y_ = y;
 }
 
 void Entity::setWidth(float width)
 {
-    width_ = width;
+    cold_->width = width;
 }
 
 void Entity::setHeight(float height)
 {
-    height_ = height;
+    cold_->height = height;
 }
 
-void Entity::setVelocityX(float velocityX)
+void Entity::setVelocityX(sim::Real velocityX)
 {
     velocityX_ = velocityX;
 }
 
-void Entity::setVelocityY(float velocityY)
+void Entity::setVelocityY(sim::Real velocityY)
 {
     velocityY_ = velocityY;
 }
 
-void Entity::setAccelerationX(float accelerationX)
+void Entity::setAccelerationX(sim::Real accelerationX)
 {
     accelerationX_ = accelerationX;
 }
 
-void Entity::setAccelerationY(float accelerationY)
+void Entity::setAccelerationY(sim::Real accelerationY)
 {
     accelerationY_ = accelerationY;
 }
 
 void Entity::setTexture(SDL_Texture *texture)
 {
-    texture_ = texture;
+    cold_->texture = texture;
 }
 
 void Entity::setMovable(bool isMovable)
 {
-    isMovable_ = isMovable;
+    setComponent(ecs::Movable, isMovable);
 }
 
 void Entity::setControllable(bool isControllable)
 {
-    isControllable_ = isControllable;
+    setComponent(ecs::Controllable, isControllable);
 }
 
 void Entity::setEnemy(bool val)
 {
-    isEnemy_ = val;
+    setComponent(ecs::Enemy, val);
 }
 
 void Entity::setJumping(bool val)
 {
-    isJumping_ = val;
-}
-
-void Entity::setReset(bool val)
-{
-    isReset_ = val;
+    flags_ = static_cast<std::uint8_t>(val ? flags_ | FlagJumping : flags_ & ~FlagJumping);
 }
 
 void Entity::isPlatform(bool val)
 {
-    isPlatform_ = val;
+    setComponent(ecs::Platform, val);
 }
 
 void Entity::isCollidable(bool val)
 {
-    isCollidable_ = val;
+    setComponent(ecs::Collidable, val);
 }
 
 void Entity::setisAffectedByGravity(bool val)
 {
-    isAffectedByGravity = val;
+    setComponent(ecs::Gravity, val);
 }
 
 void Entity::setDisabled(bool val)
 {
-    isDisabled_ = val;
+    setComponent(ecs::Disabled, val);
+}
+
+void Entity::setSupport(int entityIndex)
+{
+    support_ = entityIndex;
+}
+
+void Entity::setTrigger(bool val)
+{
+    setComponent(ecs::Trigger, val);
+}
+
+void Entity::setNavigationSpeed(sim::Real speed)
+{
+    cold_->navigationSpeed = speed;
+    setComponent(ecs::Navigator, sim::Real(0) < speed);
+}
+
+void Entity::setCollisionLayer(collision::LayerMask layer)
+{
+    cold_->collisionLayer = layer;
+}
+
+void Entity::setCollisionMask(collision::LayerMask mask)
+{
+    cold_->collisionMask = mask;
 }
 
 void Entity::setFrameColumnCount(int frameColumnCount)
 {
-    frameColumnCount_ = frameColumnCount;
+    cold_->frameColumnCount = frameColumnCount;
+    refreshDerivedComponents();
 }
 
 void Entity::setFrameRowCount(int frameRowCount)
 {
-    frameRowCount_ = frameRowCount;
+    cold_->frameRowCount = frameRowCount;
 }
 
 void Entity::setCurrentFrameRow(int currentFrameRow)
 {
-    currentFrameRow_ = currentFrameRow;
+    cold_->currentFrameRow = currentFrameRow;
 }
 
 void Entity::setCurrentFrameColumn(int currentFrameColumn)
 {
-    currentFrameColumn_ = currentFrameColumn;
+    cold_->currentFrameColumn = currentFrameColumn;
 }
 
 void Entity::setAnimationDelay(int animationDelay)
 {
-    animationDelay_ = animationDelay;
+    cold_->animationDelay = animationDelay;
+    refreshDerivedComponents();
 }
 
 void Entity::setScale(float scale)
 {
-    scale_ = scale;
+    cold_->scale = scale;
+}
+
+void Entity::setUpdateFunction(behaviour::Callback updateFunction)
+{
+    behaviour_ = behaviour::intern(updateFunction);
 }
 
-void Entity::setUpdateFunction(const std::function<void(Entity &)> &updateFunction)
+void Entity::setBehaviour(behaviour::Id id)
 {
-    updateFunction_ = updateFunction;
+    behaviour_ = id;
 }
 
 void Entity::setPathVectors(const std::vector<PathVector> &vectors)
 {
-    pathVectors_ = vectors;
-    if (pathVectors_.empty())
+    cold_->pathVectors = vectors;
+    if (cold_->pathVectors.empty())
     {
-        nextPathVectorIndex_ = -1;
-        pathVectorUpdatesRemaining_ = 0;
+        cold_->nextPathVectorIndex = -1;
+        cold_->pathVectorUpdatesRemaining = 0;
     }
     else
     {
-        nextPathVectorIndex_ = 0;
-        pathVectorUpdatesRemaining_ = 0; // will be initialized on first step
+        cold_->nextPathVectorIndex = 0;
+        cold_->pathVectorUpdatesRemaining = 0; // will be initialized on first step
     }
+    refreshDerivedComponents();
 }
 
-void Entity::setNextPathVectorIndex(int index) { nextPathVectorIndex_ = index; }
-void Entity::setPathVectorUpdatesRemaining(int updates) { pathVectorUpdatesRemaining_ = updates; }
+void Entity::setNextPathVectorIndex(int index)
+{
+    cold_->nextPathVectorIndex = index;
+    refreshDerivedComponents();
+}
+void Entity::setPathVectorUpdatesRemaining(int updates) { cold_->pathVectorUpdatesRemaining = updates; }
+
+void Entity::setTickDivisor(int divisor)
+{
+    cold_->tickDivisor = divisor > 0 ? divisor : 1;
+    refreshTickDivisor();
+}
+
+void Entity::setLodTickDivisor(int divisor)
+{
+    cold_->lodTickDivisor = divisor > 0 ? divisor : 1;
+    refreshTickDivisor();
+}
+
+void Entity::setCulled(bool val)
+{
+    setComponent(ecs::Culled, val);
+}
+
+void Entity::beginStep(unsigned long long tick, int span)
+{
+    prevX_ = x_;
+    prevY_ = y_;
+    lastStepTick_ = tick;
+    lastStepSpan_ = static_cast<std::uint16_t>(span);
+    tickDivisor_ = nextTickDivisor_;
+}
+
+Entity::SimState Entity::saveState() const
+{
+    SimState s;
+    s.x = x_;
+    s.y = y_;
+    s.prevX = prevX_;
+    s.prevY = prevY_;
+    s.velocityX = velocityX_;
+    s.velocityY = velocityY_;
+    s.accelerationX = accelerationX_;
+    s.accelerationY = accelerationY_;
+    s.components = components_;
+    s.currentFrameRow = cold_->currentFrameRow;
+    s.currentFrameColumn = cold_->currentFrameColumn;
+    s.nextPathVectorIndex = cold_->nextPathVectorIndex;
+    s.pathVectorUpdatesRemaining = cold_->pathVectorUpdatesRemaining;
+    s.lodTickDivisor = cold_->lodTickDivisor;
+    s.tickDivisor = tickDivisor_;
+    s.lastStepSpan = lastStepSpan_;
+    s.lastStepTick = lastStepTick_;
+    s.support = support_;
+    s.isJumping = isJumping();
+    return s;
+}
+
+void Entity::loadState(const SimState &s)
+{
+    x_ = s.x;
+    y_ = s.y;
+    prevX_ = s.prevX;
+    prevY_ = s.prevY;
+    velocityX_ = s.velocityX;
+    velocityY_ = s.velocityY;
+    accelerationX_ = s.accelerationX;
+    accelerationY_ = s.accelerationY;
+    components_ = s.components;
+    cold_->currentFrameRow = s.currentFrameRow;
+    cold_->currentFrameColumn = s.currentFrameColumn;
+    cold_->nextPathVectorIndex = s.nextPathVectorIndex;
+    cold_->pathVectorUpdatesRemaining = s.pathVectorUpdatesRemaining;
+    cold_->lodTickDivisor = s.lodTickDivisor;
+    refreshTickDivisor();
+    tickDivisor_ = static_cast<std::uint8_t>(s.tickDivisor);
+    lastStepSpan_ = static_cast<std::uint16_t>(s.lastStepSpan);
+    lastStepTick_ = s.lastStepTick;
+    support_ = s.support;
+    setJumping(s.isJumping);
+}
 
 void Entity::update()
 {
-    if (updateFunction_)
+    behaviour::invoke(behaviour_, *this);
+}
+
+void Entity::setComponent(ecs::Signature bit, bool val)
+{
+    if (val)
+        components_ |= bit;
+    else
+        components_ &= ~bit;
+}
+
+// The step loop reads the divisor for every mover, so the effective value is kept in the hot record
+void Entity::refreshTickDivisor()
+{
+    const int divisor = cold_->tickDivisor > cold_->lodTickDivisor ? cold_->tickDivisor : cold_->lodTickDivisor;
+    nextTickDivisor_ = static_cast<std::uint8_t>(divisor < 255 ? divisor : 255);
+}
+
+// Components derived from sprite/path data so systems can select on them
+void Entity::refreshDerivedComponents()
+{
+    setComponent(ecs::Animated, cold_->frameColumnCount > 0 && cold_->animationDelay > 0);
+    setComponent(ecs::PathFollower, hasPathVectors());
+}
+
+namespace {
+
+// Hand-built replica of Entity's field order before the hot/cold split, kept only so the benchmark
+// can compare layouts; it is not the baseline class and steps a reduced copy of its physics
+struct InterleavedEntity
+{
+    std::string name;
+    sim::Real x, y, prevX, prevY;
+    float width, height;
+    sim::Real velocityX, velocityY, accelerationX, accelerationY;
+    ecs::Signature components;
+    bool isJumping, isReset;
+    SDL_Texture *texture;
+    int frameColumnCount, frameRowCount, currentFrameRow, currentFrameColumn, animationDelay;
+    float scale;
+    behaviour::Id behaviour;
+    std::vector<Entity::PathVector> pathVectors;
+    int nextPathVectorIndex, pathVectorUpdatesRemaining;
+    collision::LayerMask collisionLayer, collisionMask;
+    int support;
+    int tickDivisor, lodTickDivisor, lastStepSpan;
+    unsigned long long lastStepTick;
+};
+
+template <typename T, typename Fn>
+double nsPerEntity(std::vector<T> &entities, int passes, Fn &&step)
+{
+    const Uint64 start = SDL_GetTicksNS();
+    for (int p = 0; p < passes; ++p)
     {
-        updateFunction_(*this);
+        for (T &e : entities)
+            step(e, static_cast<unsigned long long>(p + 1));
     }
-}
\ No newline at end of file
+    return static_cast<double>(SDL_GetTicksNS() - start) / (static_cast<double>(entities.size()) * passes);
+}
+
+} // namespace
+
+LayoutBenchmarkResult benchmarkEntityLayout(std::size_t count, int passes)
+{
+    const Physics physics;
+    const sim::Real dt = physics.getDeltaTime();
+    LayoutBenchmarkResult r{count, passes, sizeof(Entity), sizeof(InterleavedEntity), 0.0, 0.0};
+
+    // Spread positions and velocities so no two movers integrate identically
+    std::vector<Entity> entities;
+    entities.reserve(count);
+    std::vector<InterleavedEntity> interleaved(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const float x = static_cast<float>(i % 4096);
+        const float y = static_cast<float>(i / 4096);
+        const float vx = static_cast<float>(i % 7) - 3.0f;
+        entities.emplace_back(std::string("Mover"), x, y, 16.0f, 16.0f, vx, 0.0f, 0.0f, 0.0f, true, false, false, false, true,
+                              nullptr, 0, 0, 0, 1.0f, i % 2 == 0, nullptr);
+        InterleavedEntity &o = interleaved[i];
+        o.x = o.prevX = x;
+        o.y = o.prevY = y;
+        o.velocityX = vx;
+        o.velocityY = o.accelerationX = o.accelerationY = 0.0f;
+        o.components = entities.back().getComponents();
+        o.support = -1;
+    }
+
+    r.entityNsPerEntity = nsPerEntity(entities, passes, [&physics, dt](Entity &e, unsigned long long tick) {
+        if (!e.isMovable() || e.isDisabled()) return;
+        e.beginStep(tick, 1);
+        const std::pair<Physics::Vector, Physics::Vector> t = physics.applyPhysics(e, dt);
+        e.setX(t.first.first);
+        e.setY(t.first.second);
+        e.setVelocityX(t.second.first);
+        e.setVelocityY(t.second.second);
+    });
+    r.interleavedNsPerEntity = nsPerEntity(interleaved, passes, [&physics, dt](InterleavedEntity &e, unsigned long long tick) {
+        if (!(e.components & ecs::Movable) || (e.components & ecs::Disabled)) return;
+        e.prevX = e.x;
+        e.prevY = e.y;
+        e.lastStepTick = tick;
+        e.lastStepSpan = 1;
+        const std::pair<Physics::Vector, Physics::Vector> t =
+            physics.integrate({e.x, e.y}, {e.velocityX, e.velocityY}, {e.accelerationX, e.accelerationY}, (e.components & ecs::Gravity) != 0, dt);
+        e.x = t.first.first;
+        e.y = t.first.second;
+        e.velocityX = t.second.first;
+        e.velocityY = t.second.second;
+    });
+    return r;
+}
@@ -3,46 +3,71 @@
 
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_main.h>
-#include <functional>
+#include "archetype.h"
+#include "collision_layers.h"
+#include "behaviour.h"
+#include "scalar.h"
+#include <cstdint>
 #include <vector>
 #include <string>
 
-class Entity
+class alignas(64) Entity
 {
 public:
     // Constructor for static entities (matches implementation in Entity.cpp)
     Entity(std::string name, float x, float y, float width, float height, SDL_Texture *texture,
            int frameColumnCount, int frameRowCount, int animationDelay, bool isAffectedByGravity, bool isEnemy, bool isPlatform,
-           const std::function<void(Entity &)> &updateFunction);
+           behaviour::Callback updateFunction);
 
     // Constructor for Non-static entities (matches implementation in Entity.cpp)
     Entity(std::string name, float x, float y, float width, float height, float velocityX, float velocityY, float accelerationX,
            float accelerationY, bool isMovable, bool isControllable, bool isEnemy, bool isPlatform, bool isCollidable, SDL_Texture *texture,
            int frameColumnCount, int frameRowCount, int animationDelay, float scale, bool isAffectedByGravity,
-           const std::function<void(Entity &)> &updateFunction);
+           behaviour::Callback updateFunction);
+
+    // A copy always gets a cold block of its own, so it never aliases a world's row. Moves just
+    // take the block or row.
+    Entity(const Entity &other);
+    Entity &operator=(const Entity &other);
+    Entity(Entity &&other) noexcept;
+    Entity &operator=(Entity &&other) noexcept;
+    ~Entity();
 
     struct PathVector
     {
-        float vx;
-        float vy;
+        sim::Real vx;
+        sim::Real vy;
         int updates;
     };
 
+    // Everything a simulation tick can change, as plain data; saved and restored for rollback
+    struct SimState
+    {
+        sim::Real x, y, prevX, prevY;
+        sim::Real velocityX, velocityY, accelerationX, accelerationY;
+        ecs::Signature components;
+        int currentFrameRow, currentFrameColumn;
+        int nextPathVectorIndex, pathVectorUpdatesRemaining;
+        int lodTickDivisor, tickDivisor, lastStepSpan;
+        unsigned long long lastStepTick;
+        int support;
+        bool isJumping;
+    };
+
     // Getters
-    std::string getName() const;
-    float getX() const;
-    float getY() const;
+    const std::string &getName() const;
+    sim::Real getX() const;
+    sim::Real getY() const;
     float getWidth() const;
     float getHeight() const;
-    float getVelocityX() const;
-    float getVelocityY() const;
-    float getAccelerationX() const;
-    float getAccelerationY() const;
+    sim::Real getVelocityX() const;
+    sim::Real getVelocityY() const;
+    sim::Real getAccelerationX() const;
+    sim::Real getAccelerationY() const;
     bool isMovable() const;
     bool isControllable() const;
     bool isEnemy() const;
     bool isJumping() const;
-    bool isReset() const;
     bool isPlatform() const;
     bool isCollidable() const;
     bool isDisabled() const;
@@ -53,23 +78,42 @@ public:
     int getCurrentFrameRow() const;
     int getCurrentFrameColumn() const;
     int getAnimationDelay() const;
-    std::function<void(Entity &)> getUpdateFunction() const;
+    behaviour::Callback getUpdateFunction() const;
+    behaviour::Id getBehaviour() const;
     float getScale() const;
     const std::vector<PathVector> &getPathVectors() const;
     int getNextPathVectorIndex() const;
     int getPathVectorUpdatesRemaining() const;
     bool hasPathVectors() const;
+    sim::Real getPreviousX() const;
+    sim::Real getPreviousY() const;
+    // Divisor of the interval being stepped: the larger of the fixed and LOD divisors as they were at
+    // the entity's last step (at most 255). Changes wait for the next step, so no interval is cut short.
+    int getTickDivisor() const;
+    int getLastStepSpan() const;
+    unsigned long long getLastStepTick() const;
+    bool isCulled() const;
+    // Entity this one rests on, kept across ticks while the contact holds; -1 when airborne or on terrain
+    int getSupport() const;
+    bool isTrigger() const;
+    bool isNavigator() const;
+    sim::Real getNavigationSpeed() const;
+    // Layer defaults to one derived from the entity's role; mask defaults to every layer
+    collision::LayerMask getCollisionLayer() const;
+    collision::LayerMask getCollisionMask() const;
+    ecs::Signature getComponents() const;
+    bool hasComponents(ecs::Signature mask) const;
 
     // Setters
     void setName(const std::string &name);
-    void setX(float x);
-    void setY(float y);
+    void setX(sim::Real x);
+    void setY(sim::Real y);
     void setWidth(float width);
     void setHeight(float height);
-    void setVelocityX(float velocityX);
-    void setVelocityY(float velocityY);
-    void setAccelerationX(float accelerationX);
-    void setAccelerationY(float accelerationY);
+    void setVelocityX(sim::Real velocityX);
+    void setVelocityY(sim::Real velocityY);
+    void setAccelerationX(sim::Real accelerationX);
+    void setAccelerationY(sim::Real accelerationY);
     void setTexture(SDL_Texture *texture);
     void setMovable(bool isMovable);
     void setControllable(bool isControllable);
@@ -77,7 +121,6 @@ public:
     void setDisabled(bool val);
     void setEnemy(bool val);
     void setJumping(bool val);
-    void setReset(bool val);
     void isPlatform(bool val);
     void isCollidable(bool val);
     void setFrameColumnCount(int frameColumnCount);
@@ -85,53 +128,123 @@ public:
     void setCurrentFrameRow(int currentFrameRow);
     void setCurrentFrameColumn(int currentFrameColumn);
     void setAnimationDelay(int animationDelay);
-    void setUpdateFunction(const std::function<void(Entity &)> &updateFunction);
+    // The callback is registered once per distinct function and the entity keeps only its id
+    void setUpdateFunction(behaviour::Callback updateFunction);
+    void setBehaviour(behaviour::Id id);
     void setScale(float scale);
     void setPathVectors(const std::vector<PathVector> &vectors);
     void setNextPathVectorIndex(int index);
     void setPathVectorUpdatesRemaining(int updates);
+    // Step this entity every N simulation ticks with an N-times timestep (e.g. 3 = 20 Hz at 60 Hz)
+    void setTickDivisor(int divisor);
+    // Divisor picked by the LOD pass from distance to the controlled entity
+    void setLodTickDivisor(int divisor);
+    void setCulled(bool val);
+    void setSupport(int entityIndex);
+    void setTrigger(bool val);
+    // Steer along the world's flow field at speed px/s instead of following path vectors; 0 stops
+    void setNavigationSpeed(sim::Real speed);
+    void setCollisionLayer(collision::LayerMask layer);
+    void setCollisionMask(collision::LayerMask mask);
+    // Record the current position as the interpolation start before a simulation step of span ticks,
+    // and start the next interval at the divisor set since the last step
+    void beginStep(unsigned long long tick, int span);
+
+    SimState saveState() const;
+    void loadState(const SimState &state);
 
     void update();
 
 private:
-    std::string name_;
+    friend class World;
 
-    float x_;
-    float y_;
+    // Never read by the per-tick mover loop: sprite, path, layer and divisor inputs. A World keeps
+    // these in a side table, one row per entity; an entity built on its own owns a block until it
+    // is added. Probes take extents from the collider boxes instead. The animation and path
+    // cursors at the front are written by their passes every tick.
+    struct Cold
+    {
+        int currentFrameRow;
+        int currentFrameColumn;
+        int nextPathVectorIndex;
+        int pathVectorUpdatesRemaining;
 
-    float width_;
-    float height_;
+        std::string name;
+        SDL_Texture *texture;
 
-    float velocityX_;
-    float velocityY_;
+        float width;
+        float height;
+        float scale;
 
-    float accelerationX_;
-    float accelerationY_;
+        int frameColumnCount;
+        int frameRowCount;
+        int animationDelay;
 
-    bool isMovable_;
-    bool isControllable_;
-    bool isAffectedByGravity;
-    bool isEnemy_;
-    bool isJumping_;
-    bool isReset_;
-    bool isPlatform_;
-    bool isDisabled_;
-    bool isCollidable_;
+        std::vector<PathVector> pathVectors;
 
-    SDL_Texture *texture_;
+        collision::LayerMask collisionLayer; // 0 = derive from role
+        collision::LayerMask collisionMask;
 
-    int frameColumnCount_;
-    int frameRowCount_;
-    int currentFrameRow_;
-    int currentFrameColumn_;
-    int animationDelay_;
-    float scale_;
+        int tickDivisor;
+        int lodTickDivisor;
 
-    std::function<void(Entity &)> updateFunction_;
+        sim::Real navigationSpeed; // 0 = not a navigator
+    };
 
-    std::vector<PathVector> pathVectors_;
-    int nextPathVectorIndex_;
-    int pathVectorUpdatesRemaining_;
+    enum Flag : std::uint8_t
+    {
+        FlagJumping = 1u << 0,
+        FlagOwnsCold = 1u << 1, // cold_ is this entity's own block, not a world's row
+    };
+
+    // Hot record: what stepping a mover reads and writes, in one 64-byte line with a 4-byte
+    // sim::Real (two lines with 8-byte types). Everything else sits behind cold_.
+
+    // Kinematics use the configured simulation type (see scalar.h)
+    sim::Real x_;
+    sim::Real y_;
+    sim::Real velocityX_;
+    sim::Real velocityY_;
+    sim::Real accelerationX_;
+    sim::Real accelerationY_;
+
+    // Position before the last simulation step, for render interpolation
+    sim::Real prevX_;
+    sim::Real prevY_;
+    unsigned long long lastStepTick_;
+
+    // Role flags live in the component signature (see archetype.h)
+    ecs::Signature components_;
+    int support_;
+    behaviour::Id behaviour_; // runs each tick (batched by id) and on collision
+    std::uint16_t lastStepSpan_;
+    std::uint8_t tickDivisor_;     // divisor of the interval being stepped
+    std::uint8_t nextTickDivisor_; // the larger of cold_->tickDivisor and cold_->lodTickDivisor; adopted by beginStep
+    std::uint8_t flags_;
+
+    Cold *cold_;
+
+    // Copy other's hot record onto cold, which this entity owns if owns is set
+    Entity(const Entity &other, Cold *cold, bool owns);
+    void copyHot(const Entity &other, bool ownsCold);
+
+    void setComponent(ecs::Signature bit, bool val);
+    void refreshDerivedComponents();
+    void refreshTickDivisor();
+};
+
+struct LayoutBenchmarkResult
+{
+    std::size_t entities;
+    int passes;
+    std::size_t entityBytes;      // sizeof(Entity): hot record plus cold row pointer
+    std::size_t interleavedBytes; // hand-built replica of the previous field-interleaved layout
+    double entityNsPerEntity;
+    double interleavedNsPerEntity;
 };
 
+// Step physics (begin step, integrate, write back) over count movers in the current layout and in
+// a hand-built replica of the previous interleaved one, passes times each, on the calling thread
+LayoutBenchmarkResult benchmarkEntityLayout(std::size_t count, int passes);
+
 #endif
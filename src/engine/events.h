@@ -0,0 +1,187 @@
+// Gameplay events between systems: typed, bounded, lock-free multi-producer queues
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace events {
+
+// A controllable entity touched a platform or terrain; clears its jump latch
+struct Landed
+{
+    std::uint32_t entity;
+};
+
+// A controllable entity ran into an enemy; it respawns
+struct PlayerHit
+{
+    std::uint32_t entity;
+    std::uint32_t enemy;
+};
+
+// A mover touched entity; entity's behaviour runs once per contact
+struct Contact
+{
+    std::uint32_t entity;
+    std::uint32_t mover;
+};
+
+// Bounded queue: any number of threads push, one thread drains. Each cell carries a sequence
+// number, so producers claim a cell with one CAS on the tail and publish it with one release
+// store; nothing blocks and nothing allocates after construction or reserve().
+template <typename T>
+class MpscQueue
+{
+    static_assert(std::is_trivially_copyable<T>::value, "events are copied between threads as plain data");
+
+public:
+    explicit MpscQueue(std::size_t capacity = 256) { allocate(capacity); }
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    // Any thread. False (and counted) when the queue is full.
+    bool push(const T &value)
+    {
+        std::size_t pos = tail_.load(std::memory_order_relaxed);
+        Cell *cell;
+        for (;;)
+        {
+            cell = &cells_[pos & mask_];
+            const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0)
+            {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (diff < 0)
+            {
+                overflows_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else
+            {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = value;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only: hand every published event to fn in claim order; returns how many
+    template <typename Fn>
+    std::size_t drain(Fn &&fn)
+    {
+        std::size_t n = 0;
+        for (;;)
+        {
+            Cell &cell = cells_[head_ & mask_];
+            if (cell.sequence.load(std::memory_order_acquire) != head_ + 1) break;
+            const T value = cell.value;
+            cell.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+            ++head_;
+            ++n;
+            fn(value);
+        }
+        return n;
+    }
+
+    // Grow to hold at least capacity events. Only while no producer is running and the queue is
+    // drained; never shrinks, so a steady load allocates once.
+    void reserve(std::size_t capacity)
+    {
+        if (capacity > mask_ + 1) allocate(capacity);
+    }
+
+    std::size_t capacity() const { return mask_ + 1; }
+    std::uint64_t overflows() const { return overflows_.load(std::memory_order_relaxed); }
+
+private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    void allocate(std::size_t capacity)
+    {
+        std::size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+        cells_.reset(new Cell[size]);
+        for (std::size_t i = 0; i < size; ++i)
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        mask_ = size - 1;
+        head_ = 0;
+        tail_.store(0, std::memory_order_relaxed);
+    }
+
+    std::unique_ptr<Cell[]> cells_;
+    std::size_t mask_ = 0;
+    alignas(64) std::atomic<std::size_t> tail_{0}; // next cell producers claim
+    alignas(64) std::size_t head_ = 0;             // next cell the consumer reads
+    std::atomic<std::uint64_t> overflows_{0};
+};
+
+// One queue per event type. Producers post from any thread; the owner drains each type at a fixed
+// point in its pipeline. Events from different producer threads interleave in claim order, so
+// handlers must not depend on the order of events from different producers.
+template <typename... Events>
+class Bus
+{
+public:
+    template <typename T>
+    bool post(const T &event)
+    {
+        return std::get<MpscQueue<T>>(queues_).push(event);
+    }
+
+    template <typename T, typename Fn>
+    std::size_t drain(Fn &&fn)
+    {
+        return std::get<MpscQueue<T>>(queues_).drain(std::forward<Fn>(fn));
+    }
+
+    template <typename T>
+    void reserve(std::size_t capacity)
+    {
+        std::get<MpscQueue<T>>(queues_).reserve(capacity);
+    }
+
+    // Discard everything queued (world reset)
+    void clear()
+    {
+        discard(std::get<MpscQueue<Events>>(queues_)...);
+    }
+
+    std::uint64_t overflows() const
+    {
+        std::uint64_t total = 0;
+        for (std::uint64_t n : {std::get<MpscQueue<Events>>(queues_).overflows()...})
+            total += n;
+        return total;
+    }
+
+private:
+    template <typename... Queues>
+    static void discard(Queues &...queues)
+    {
+        (void)std::initializer_list<int>{(static_cast<void>(queues.drain([](const auto &) {})), 0)...};
+    }
+
+    std::tuple<MpscQueue<Events>...> queues_;
+};
+
+// Everything collision reports back to the world in one tick
+using GameplayBus = Bus<Landed, PlayerHit, Contact>;
+
+} // namespace events
+
+#endif
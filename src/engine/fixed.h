@@ -0,0 +1,85 @@
+// Binary fixed-point numbers for bit-exact simulation across compilers and CPUs
+#ifndef FIXED_H
+#define FIXED_H
+
+#include <cstdint>
+#include <type_traits>
+
+// Storage holds the raw value, Wide must fit the product of two raws, FracBits is the binary point.
+// Every operation is plain integer arithmetic, so results never depend on FPU mode, contraction
+// or the SIMD path the compiler picked.
+template <typename Storage, typename Wide, int FracBits>
+class Fixed
+{
+public:
+    using storage_type = Storage;
+    static constexpr int kFracBits = FracBits;
+
+    constexpr Fixed() : raw_(0) {}
+
+    // Implicit from arithmetic types so literals and tuning constants read naturally
+    template <typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+    constexpr Fixed(T v) : raw_(static_cast<Storage>(static_cast<Wide>(v) * kOne)) {}
+
+    template <typename T, typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0>
+    constexpr Fixed(T v) : raw_(fromDouble(static_cast<double>(v))) {}
+
+    static constexpr Fixed fromRaw(Storage raw)
+    {
+        Fixed f;
+        f.raw_ = raw;
+        return f;
+    }
+    constexpr Storage raw() const { return raw_; }
+
+    // Leaving fixed point is always explicit (rendering, logging)
+    explicit constexpr operator float() const { return static_cast<float>(static_cast<double>(raw_) / kOne); }
+    explicit constexpr operator double() const { return static_cast<double>(raw_) / kOne; }
+    explicit constexpr operator int() const { return static_cast<int>(raw_ / static_cast<Storage>(kOne)); }
+
+    friend constexpr Fixed operator+(Fixed a, Fixed b) { return fromRaw(static_cast<Storage>(a.raw_ + b.raw_)); }
+    friend constexpr Fixed operator-(Fixed a, Fixed b) { return fromRaw(static_cast<Storage>(a.raw_ - b.raw_)); }
+    friend constexpr Fixed operator*(Fixed a, Fixed b)
+    {
+        return fromRaw(static_cast<Storage>((static_cast<Wide>(a.raw_) * b.raw_) >> FracBits));
+    }
+    friend constexpr Fixed operator/(Fixed a, Fixed b)
+    {
+        return fromRaw(static_cast<Storage>((static_cast<Wide>(a.raw_) * kOne) / b.raw_));
+    }
+    constexpr Fixed operator-() const { return fromRaw(static_cast<Storage>(-raw_)); }
+
+    Fixed &operator+=(Fixed b) { return *this = *this + b; }
+    Fixed &operator-=(Fixed b) { return *this = *this - b; }
+    Fixed &operator*=(Fixed b) { return *this = *this * b; }
+    Fixed &operator/=(Fixed b) { return *this = *this / b; }
+
+    friend constexpr bool operator==(Fixed a, Fixed b) { return a.raw_ == b.raw_; }
+    friend constexpr bool operator!=(Fixed a, Fixed b) { return a.raw_ != b.raw_; }
+    friend constexpr bool operator<(Fixed a, Fixed b) { return a.raw_ < b.raw_; }
+    friend constexpr bool operator>(Fixed a, Fixed b) { return a.raw_ > b.raw_; }
+    friend constexpr bool operator<=(Fixed a, Fixed b) { return a.raw_ <= b.raw_; }
+    friend constexpr bool operator>=(Fixed a, Fixed b) { return a.raw_ >= b.raw_; }
+
+private:
+    static constexpr Wide kOne = static_cast<Wide>(1) << FracBits;
+
+    // Round to nearest; conversion happens at load time, not per tick
+    static constexpr Storage fromDouble(double v)
+    {
+        const double scaled = v * static_cast<double>(kOne);
+        return static_cast<Storage>(scaled >= 0.0 ? scaled + 0.5 : scaled - 0.5);
+    }
+
+    Storage raw_;
+};
+
+using Q16_16 = Fixed<std::int32_t, std::int64_t, 16>;
+
+#if defined(__SIZEOF_INT128__)
+#define FIXED_HAS_Q32_32 1
+__extension__ typedef __int128 fixed_int128;
+using Q32_32 = Fixed<std::int64_t, fixed_int128, 32>;
+#endif
+
+#endif
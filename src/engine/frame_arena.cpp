@@ -0,0 +1,101 @@
+// Frame arena and the optional global allocation counter
+#include "frame_arena.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace mem {
+
+namespace {
+
+std::size_t alignUp(std::size_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace
+
+FrameArena::FrameArena(std::size_t capacity) : block_(new unsigned char[capacity]), capacity_(capacity) {}
+
+void *FrameArena::allocate(std::size_t bytes, std::size_t alignment)
+{
+    if (bytes == 0) bytes = 1;
+    // new[] storage is aligned for max_align_t; stricter requests are padded by hand
+    const std::size_t start = alignUp(offset_, alignment);
+    used_ += bytes + (start - offset_);
+    highWater_ = std::max(highWater_, used_);
+    if (start + bytes <= capacity_)
+    {
+        offset_ = start + bytes;
+        return block_.get() + start;
+    }
+
+    ++spills_;
+    spill_.emplace_back(new unsigned char[bytes + alignment]);
+    unsigned char *raw = spill_.back().get();
+    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(raw);
+    return raw + (alignUp(address, alignment) - address);
+}
+
+void FrameArena::reset()
+{
+    if (!spill_.empty())
+    {
+        spill_.clear();
+        // Room for the worst tick seen plus slack for alignment padding
+        capacity_ = alignUp(highWater_ + highWater_ / 4, 4096);
+        block_.reset(new unsigned char[capacity_]);
+    }
+    offset_ = 0;
+    used_ = 0;
+}
+
+#ifdef FEELINGLOOPY_COUNT_ALLOCS
+
+namespace {
+std::atomic<std::uint64_t> gAllocations{0};
+} // namespace
+
+std::uint64_t allocationCount() { return gAllocations.load(std::memory_order_relaxed); }
+bool countingAllocations() { return true; }
+
+} // namespace mem
+
+// The nothrow overloads forward to these, so every heap allocation is counted once
+void *operator new(std::size_t size)
+{
+    mem::gAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    mem::gAllocations.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t align = static_cast<std::size_t>(alignment);
+    if (void *p = std::aligned_alloc(align, (std::max<std::size_t>(size, 1) + align - 1) / align * align)) return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) { return ::operator new(size); }
+void *operator new[](std::size_t size, std::align_val_t alignment) { return ::operator new(size, alignment); }
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+#else
+
+std::uint64_t allocationCount() { return 0; }
+bool countingAllocations() { return false; }
+
+} // namespace mem
+
+#endif
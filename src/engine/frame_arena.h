@@ -0,0 +1,55 @@
+// Per-tick scratch memory and allocation accounting
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace mem {
+
+// Bump allocator for data that only lives for one simulation tick; reset() frees it all at once.
+// A tick that outgrows the block spills to the heap, and the next reset() grows the block to the
+// high-water mark, so once the frame loop has warmed up it never touches the allocator.
+class FrameArena
+{
+public:
+    explicit FrameArena(std::size_t capacity = 64 * 1024);
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    void *allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t));
+    // Uninitialised storage for count objects; nothing is destroyed on reset
+    template <typename T>
+    T *allocateArray(std::size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "arena memory is released without running destructors");
+        return static_cast<T *>(allocate(sizeof(T) * count, alignof(T)));
+    }
+    void reset();
+
+    std::size_t capacity() const { return capacity_; }
+    std::size_t used() const { return used_; }
+    std::size_t highWater() const { return highWater_; }
+    std::uint64_t spillCount() const { return spills_; }
+
+private:
+    std::unique_ptr<unsigned char[]> block_;
+    std::size_t capacity_;
+    std::size_t offset_ = 0;
+    std::size_t used_ = 0; // bytes handed out this tick, spills included
+    std::size_t highWater_ = 0;
+    std::uint64_t spills_ = 0;
+    std::vector<std::unique_ptr<unsigned char[]>> spill_;
+};
+
+// Global operator new calls so far. Counting is compiled in only with FEELINGLOOPY_COUNT_ALLOCS
+// (CMake option of the same name); otherwise this stays 0 and countingAllocations() is false.
+std::uint64_t allocationCount();
+bool countingAllocations();
+
+} // namespace mem
+
+#endif
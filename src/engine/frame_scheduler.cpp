@@ -0,0 +1,58 @@
+// Frame scheduler implementation
+#include "frame_scheduler.h"
+
+FrameScheduler::FrameScheduler(double tickRateHz)
+    : periodNS_(0), nextTickNS_(0)
+{
+    setTickRate(tickRateHz);
+}
+
+void FrameScheduler::setTickRate(double tickRateHz)
+{
+    if (tickRateHz <= 0.0) return;
+    periodNS_ = static_cast<Uint64>(static_cast<double>(SDL_NS_PER_SECOND) / tickRateHz);
+}
+
+double FrameScheduler::getTickRate() const
+{
+    return static_cast<double>(SDL_NS_PER_SECOND) / static_cast<double>(periodNS_.load());
+}
+
+Uint64 FrameScheduler::getTickPeriodNS() const
+{
+    return periodNS_.load();
+}
+
+void FrameScheduler::start()
+{
+    nextTickNS_ = SDL_GetTicksNS();
+}
+
+void FrameScheduler::waitForNextTick()
+{
+    const Uint64 period = periodNS_.load();
+    nextTickNS_ += period;
+    const Uint64 now = SDL_GetTicksNS();
+    if (now < nextTickNS_)
+    {
+        SDL_DelayNS(nextTickNS_ - now);
+    }
+    else if (now - nextTickNS_ > 4 * period)
+    {
+        // Fell far behind (debugger, suspend); don't try to catch up in a burst
+        nextTickNS_ = now;
+    }
+}
+
+Uint64 FrameScheduler::getNextTickNS() const
+{
+    return nextTickNS_ + periodNS_.load();
+}
+
+float FrameScheduler::alpha(Uint64 nowNS, Uint64 snapshotTimeNS, unsigned long long stateTicksAgo, int span) const
+{
+    const float period = static_cast<float>(periodNS_.load());
+    const float sinceSnapshot = nowNS > snapshotTimeNS ? static_cast<float>(nowNS - snapshotTimeNS) / period : 0.0f;
+    const float a = (sinceSnapshot + static_cast<float>(stateTicksAgo)) / static_cast<float>(span > 0 ? span : 1);
+    return SDL_clamp(a, 0.0f, 1.0f);
+}
@@ -0,0 +1,34 @@
+// Fixed-rate simulation pacing and render interpolation factors
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include <SDL3/SDL.h>
+#include <atomic>
+
+class FrameScheduler
+{
+public:
+    explicit FrameScheduler(double tickRateHz = 60.0);
+
+    // Simulation rate; safe to read from the render thread while the simulation runs
+    void setTickRate(double tickRateHz);
+    double getTickRate() const;
+    Uint64 getTickPeriodNS() const;
+
+    // Simulation thread: reset the deadline, then sleep until each following tick is due
+    void start();
+    void waitForNextTick();
+    // Simulation thread: when the next waitForNextTick() will return (SDL_GetTicksNS clock)
+    Uint64 getNextTickNS() const;
+
+    // Render thread: how far (0..1) to blend from an entity's previous state to its current one.
+    // stateTicksAgo is how many ticks before the snapshot the state was produced; span is how many
+    // ticks the entity advanced in that step (its tick divisor).
+    float alpha(Uint64 nowNS, Uint64 snapshotTimeNS, unsigned long long stateTicksAgo, int span) const;
+
+private:
+    std::atomic<Uint64> periodNS_;
+    Uint64 nextTickNS_;
+};
+
+#endif
@@ -0,0 +1,417 @@
+// Golden trajectory recording and checking
+#include "golden.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+#include "frame_arena.h"
+#include "world.h"
+
+namespace golden {
+
+namespace {
+
+constexpr int kFormatVersion = 2;
+constexpr int kLimitsVersion = 2;
+
+std::uint64_t bits(sim::Real v)
+{
+    std::uint64_t b = 0;
+    std::memcpy(&b, &v, sizeof(v));
+    return b;
+}
+
+float fromBits(std::uint64_t b)
+{
+    sim::Real v;
+    std::memcpy(static_cast<void *>(&v), &b, sizeof(v)); // Fixed is trivially copyable
+    return sim::toFloat(v);
+}
+
+// FNV-1a over everything that decides where entities go next
+struct Hasher
+{
+    std::uint64_t h = 1469598103934665603ull;
+    void add(std::uint64_t v)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            h ^= (v >> (i * 8)) & 0xffu;
+            h *= 1099511628211ull;
+        }
+    }
+};
+
+int stageByName(const char *name)
+{
+    for (int s = 0; s < metrics::StageCount; ++s)
+    {
+        if (std::strcmp(metrics::stageName(s), name) == 0) return s;
+    }
+    return -1;
+}
+
+std::uint64_t medianOf(std::vector<std::uint64_t> &values)
+{
+    if (values.empty()) return 0;
+    const auto middle = values.begin() + static_cast<std::ptrdiff_t>(values.size() / 2);
+    std::nth_element(values.begin(), middle, values.end());
+    return *middle;
+}
+
+// A tick's state hash with the trigger overlaps found at its end folded in
+std::uint64_t hashTick(const World &world)
+{
+    Hasher hasher{hashState(world.getEntities())};
+    for (const collision::TriggerContact &c : world.getTriggerContacts())
+        hasher.add(static_cast<std::uint64_t>(c.trigger) << 32 | c.other);
+    return hasher.h;
+}
+
+Trace record(World &world, const std::string &scene, int ticks, InputScript input, Advance advance, void *context, int sampleInterval,
+             int warmupTicks);
+
+std::string overBy(const char *what, std::uint64_t actualNS, std::uint64_t budgetNS)
+{
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-10s %9.1f us  budget %9.1f us", what, static_cast<double>(actualNS) / 1e3, static_cast<double>(budgetNS) / 1e3);
+    return line;
+}
+
+} // namespace
+
+std::uint64_t hashState(const std::vector<Entity> &entities)
+{
+    Hasher hasher;
+    for (const Entity &e : entities)
+    {
+        const Entity::SimState s = e.saveState();
+        for (sim::Real v : {s.x, s.y, s.prevX, s.prevY, s.velocityX, s.velocityY, s.accelerationX, s.accelerationY})
+            hasher.add(bits(v));
+        hasher.add(static_cast<std::uint64_t>(s.components));
+        hasher.add(static_cast<std::uint64_t>(static_cast<std::uint32_t>(s.support)) | static_cast<std::uint64_t>(s.isJumping) << 32);
+        hasher.add(static_cast<std::uint64_t>(static_cast<std::uint32_t>(s.currentFrameRow)) << 32 | static_cast<std::uint32_t>(s.currentFrameColumn));
+        hasher.add(static_cast<std::uint64_t>(static_cast<std::uint32_t>(s.nextPathVectorIndex)) << 32 |
+                   static_cast<std::uint32_t>(s.pathVectorUpdatesRemaining));
+    }
+    return hasher.h;
+}
+
+const char *scalarName()
+{
+#if defined(FEELINGLOOPY_SCALAR_DOUBLE)
+    return "double";
+#elif defined(FEELINGLOOPY_SCALAR_Q16_16)
+    return "q16_16";
+#elif defined(FEELINGLOOPY_SCALAR_Q32_32)
+    return "q32_32";
+#else
+    return "float";
+#endif
+}
+
+Trace run(World &world, const std::string &scene, int ticks, InputScript input, int sampleInterval, int warmupTicks)
+{
+    return record(world, scene, ticks, input, nullptr, nullptr, sampleInterval, warmupTicks);
+}
+
+Trace run(World &world, const std::string &scene, int ticks, Advance advance, void *context, int sampleInterval, int warmupTicks)
+{
+    return record(world, scene, ticks, nullptr, advance, context, sampleInterval, warmupTicks);
+}
+
+namespace {
+
+Trace record(World &world, const std::string &scene, int ticks, InputScript input, Advance advance, void *context, int sampleInterval,
+             int warmupTicks)
+{
+    Trace trace;
+    trace.scene = scene;
+    trace.scalar = scalarName();
+    trace.ticks = ticks;
+    trace.sampleInterval = std::max(sampleInterval, 1);
+    trace.hashes.reserve(static_cast<std::size_t>(std::max(ticks, 0)));
+
+    // Per-tick times, for medians: a tick the OS preempts shouldn't move the budget
+    std::vector<std::uint64_t> stageTimes[metrics::StageCount];
+    std::vector<std::uint64_t> stepTimes;
+    const std::size_t timedTicks = static_cast<std::size_t>(std::max(ticks - warmupTicks, 0));
+    for (std::vector<std::uint64_t> &times : stageTimes)
+        times.reserve(timedTicks);
+    stepTimes.reserve(timedTicks);
+    std::uint8_t held = 0;
+    for (int t = 1; t <= ticks; ++t)
+    {
+        // Input goes through the same controls path the engine uses, pressed edges included
+        const std::uint64_t inputStart = metrics::nowNS();
+        if (input)
+        {
+            const std::uint8_t now = input(world.getTick() + 1);
+            if (Entity *controlled = world.getControls().getControlledEntity())
+                world.getControls().applyButtons(controlled, now, static_cast<std::uint8_t>(now & ~held));
+            held = now;
+        }
+        const std::uint64_t inputNS = metrics::nowNS() - inputStart;
+
+        const std::uint64_t stepStart = metrics::nowNS();
+        if (advance)
+            advance(context, world);
+        else
+            world.step();
+        const std::uint64_t advanceNS = metrics::nowNS() - stepStart;
+
+        if (t > warmupTicks)
+        {
+            const metrics::Frame &f = world.getFrameMetrics();
+            for (int s = 0; s < metrics::StageCount; ++s)
+                stageTimes[s].push_back(s == metrics::StageInput ? f.stageNS[s] + inputNS : f.stageNS[s]);
+            stepTimes.push_back((advance ? advanceNS : f.stepNS) + inputNS);
+            trace.budget.allocations = std::max(trace.budget.allocations, f.allocations);
+        }
+
+        const std::vector<Entity> &entities = world.getEntities();
+        trace.hashes.push_back(hashTick(world));
+        if (t % trace.sampleInterval == 0)
+        {
+            for (std::size_t i = 0; i < entities.size(); ++i)
+            {
+                const Entity &e = entities[i];
+                trace.samples.push_back(Sample{world.getTick(), static_cast<std::uint32_t>(i), bits(e.getX()), bits(e.getY()), bits(e.getVelocityX()),
+                                               bits(e.getVelocityY())});
+            }
+        }
+    }
+
+    for (int s = 0; s < metrics::StageCount; ++s)
+        trace.budget.stageNS[s] = medianOf(stageTimes[s]);
+    trace.budget.stepNS = medianOf(stepTimes);
+    return trace;
+}
+
+} // namespace
+
+bool save(const Trace &trace, const std::string &path)
+{
+    std::FILE *out = std::fopen(path.c_str(), "w");
+    if (!out) return false;
+    std::fprintf(out, "feelingloopy-golden %d\n", kFormatVersion);
+    std::fprintf(out, "scene %s\nscalar %s\nticks %d\ninterval %d\n", trace.scene.c_str(), trace.scalar.c_str(), trace.ticks, trace.sampleInterval);
+    for (std::size_t i = 0; i < trace.hashes.size(); ++i)
+        std::fprintf(out, "hash %zu %016" PRIx64 "\n", i + 1, trace.hashes[i]);
+    for (const Sample &s : trace.samples)
+        std::fprintf(out, "sample %llu %u %" PRIx64 " %" PRIx64 " %" PRIx64 " %" PRIx64 "\n", s.tick, s.entity, s.x, s.y, s.velocityX, s.velocityY);
+    const bool ok = std::ferror(out) == 0;
+    return std::fclose(out) == 0 && ok;
+}
+
+bool load(const std::string &path, Trace &trace)
+{
+    std::FILE *in = std::fopen(path.c_str(), "r");
+    if (!in) return false;
+    trace = Trace();
+    char line[256];
+    char word[64];
+    int version = 0;
+    bool valid = std::fgets(line, sizeof(line), in) && std::sscanf(line, "feelingloopy-golden %d", &version) == 1 && version == kFormatVersion;
+    while (valid && std::fgets(line, sizeof(line), in))
+    {
+        unsigned long long a = 0;
+        Sample s{};
+        if (std::sscanf(line, "hash %llu %" SCNx64, &a, &s.x) == 2)
+            trace.hashes.push_back(s.x);
+        else if (std::sscanf(line, "sample %llu %u %" SCNx64 " %" SCNx64 " %" SCNx64 " %" SCNx64, &s.tick, &s.entity, &s.x, &s.y, &s.velocityX, &s.velocityY) == 6)
+            trace.samples.push_back(s);
+        else if (std::sscanf(line, "scene %63s", word) == 1)
+            trace.scene = word;
+        else if (std::sscanf(line, "scalar %63s", word) == 1)
+            trace.scalar = word;
+        else if (std::sscanf(line, "ticks %d", &trace.ticks) == 1 || std::sscanf(line, "interval %d", &trace.sampleInterval) == 1)
+            continue;
+        else
+            valid = false;
+    }
+    std::fclose(in);
+    return valid && trace.ticks > 0 && trace.hashes.size() == static_cast<std::size_t>(trace.ticks);
+}
+
+Budget median(const std::vector<Budget> &runs)
+{
+    Budget result{};
+    std::vector<std::uint64_t> values;
+    values.reserve(runs.size());
+    for (int s = 0; s < metrics::StageCount; ++s)
+    {
+        values.clear();
+        for (const Budget &b : runs)
+            values.push_back(b.stageNS[s]);
+        result.stageNS[s] = medianOf(values);
+    }
+    values.clear();
+    for (const Budget &b : runs)
+    {
+        values.push_back(b.stepNS);
+        result.allocations = std::max(result.allocations, b.allocations);
+    }
+    result.stepNS = medianOf(values);
+    return result;
+}
+
+bool saveLimits(const Budget &measured, int runs, std::uint64_t referenceNS, const std::string &path, double slack, std::uint64_t floorNS)
+{
+    std::FILE *out = std::fopen(path.c_str(), "w");
+    if (!out) return false;
+    auto limit = [&](std::uint64_t ns) { return static_cast<unsigned long long>(std::max(static_cast<double>(ns) * slack, static_cast<double>(floorNS))); };
+
+    // Plain numbers (median ns per tick); edit them by hand to tighten or relax a stage
+    std::fprintf(out, "feelingloopy-budget %d\nruns %d\nreference %llu\n", kLimitsVersion, runs, static_cast<unsigned long long>(referenceNS));
+    for (int s = 0; s < metrics::StageCount; ++s)
+        std::fprintf(out, "budget %s %llu\n", metrics::stageName(s), limit(measured.stageNS[s]));
+    std::fprintf(out, "budget step %llu\n", limit(measured.stepNS));
+    std::fprintf(out, "budget allocations %u\n", measured.allocations);
+    const bool ok = std::ferror(out) == 0;
+    return std::fclose(out) == 0 && ok;
+}
+
+bool loadLimits(const std::string &path, Limits &limits)
+{
+    std::FILE *in = std::fopen(path.c_str(), "r");
+    if (!in) return false;
+    limits = Limits();
+    char line[256];
+    char word[64];
+    int version = 0;
+    bool valid = std::fgets(line, sizeof(line), in) && std::sscanf(line, "feelingloopy-budget %d", &version) == 1 &&
+                 version >= 1 && version <= kLimitsVersion; // version 1 had no reference line
+    while (valid && std::fgets(line, sizeof(line), in))
+    {
+        unsigned long long b = 0;
+        if (std::sscanf(line, "runs %d", &limits.runs) == 1)
+            continue;
+        if (std::sscanf(line, "reference %llu", &b) == 1)
+        {
+            limits.referenceNS = b;
+            continue;
+        }
+        if (std::sscanf(line, "budget %63s %llu", word, &b) != 2)
+        {
+            valid = false;
+            continue;
+        }
+        const int stage = stageByName(word);
+        if (stage >= 0)
+            limits.budget.stageNS[stage] = b;
+        else if (std::strcmp(word, "step") == 0)
+            limits.budget.stepNS = b;
+        else if (std::strcmp(word, "allocations") == 0)
+            limits.budget.allocations = static_cast<std::uint32_t>(b);
+        else
+            valid = false;
+    }
+    std::fclose(in);
+    return valid && limits.runs > 0;
+}
+
+std::uint64_t referenceNS()
+{
+    // Small enough to stay in cache, so it measures the core rather than the memory system
+    std::vector<std::uint32_t> values(1u << 14);
+    std::uint64_t fastest = UINT64_MAX;
+    std::uint64_t sum = 0;
+    for (int run = 0; run < 15; ++run)
+    {
+        std::uint32_t seed = 12345u;
+        for (std::uint32_t &v : values)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            v = seed;
+        }
+        const std::uint64_t start = metrics::nowNS();
+        std::sort(values.begin(), values.end());
+        for (std::uint32_t v : values)
+            sum = sum * 31u + v;
+        fastest = std::min(fastest, metrics::nowNS() - start);
+    }
+    static volatile std::uint64_t sink;
+    sink = sum; // keeps the work from being optimised away
+    return fastest;
+}
+
+Budget scaled(const Budget &limits, double factor)
+{
+    Budget result = limits;
+    for (std::uint64_t &ns : result.stageNS)
+        ns = static_cast<std::uint64_t>(static_cast<double>(ns) * factor);
+    result.stepNS = static_cast<std::uint64_t>(static_cast<double>(limits.stepNS) * factor);
+    return result;
+}
+
+Report verify(const Trace &golden, const Trace &actual)
+{
+    Report report;
+    char text[256];
+    if (golden.scene != actual.scene || golden.scalar != actual.scalar || golden.ticks != actual.ticks || golden.sampleInterval != actual.sampleInterval)
+    {
+        std::snprintf(text, sizeof(text), "recorded %s/%s/%d ticks, ran %s/%s/%d ticks", golden.scene.c_str(), golden.scalar.c_str(), golden.ticks,
+                      actual.scene.c_str(), actual.scalar.c_str(), actual.ticks);
+        report.trajectoryMatches = false;
+        report.trajectory = text;
+        return report;
+    }
+
+    const std::size_t ticks = std::min(golden.hashes.size(), actual.hashes.size());
+    for (std::size_t i = 0; i < ticks && report.trajectoryMatches; ++i)
+    {
+        if (golden.hashes[i] != actual.hashes[i])
+        {
+            report.trajectoryMatches = false;
+            report.firstTick = static_cast<long long>(i + 1);
+        }
+    }
+    if (!report.trajectoryMatches)
+    {
+        // Name the first sampled entity that is off, at or after the first differing tick
+        std::snprintf(text, sizeof(text), "state differs from tick %lld", report.firstTick);
+        report.trajectory = text;
+        if (golden.samples.size() != actual.samples.size())
+        {
+            report.trajectory += "; entity count differs too";
+        }
+        else
+        {
+            for (std::size_t i = 0; i < golden.samples.size(); ++i)
+            {
+                const Sample &g = golden.samples[i];
+                const Sample &a = actual.samples[i];
+                if (static_cast<long long>(g.tick) < report.firstTick) continue;
+                if (g.x == a.x && g.y == a.y && g.velocityX == a.velocityX && g.velocityY == a.velocityY) continue;
+                std::snprintf(text, sizeof(text), "; at tick %llu entity %u is at (%.4f, %.4f) moving (%.4f, %.4f), expected (%.4f, %.4f) moving (%.4f, %.4f)",
+                              a.tick, a.entity, fromBits(a.x), fromBits(a.y), fromBits(a.velocityX), fromBits(a.velocityY), fromBits(g.x), fromBits(g.y),
+                              fromBits(g.velocityX), fromBits(g.velocityY));
+                report.trajectory += text;
+                break;
+            }
+        }
+    }
+
+    return report;
+}
+
+void checkBudget(const Budget &limits, const Budget &measured, Report &report)
+{
+    for (int s = 0; s < metrics::StageCount; ++s)
+    {
+        if (measured.stageNS[s] > limits.stageNS[s])
+            report.overBudget.push_back(overBy(metrics::stageName(s), measured.stageNS[s], limits.stageNS[s]));
+    }
+    if (measured.stepNS > limits.stepNS) report.overBudget.push_back(overBy("step", measured.stepNS, limits.stepNS));
+    if (mem::countingAllocations() && measured.allocations > limits.allocations)
+    {
+        char text[128];
+        std::snprintf(text, sizeof(text), "%-10s %9u per tick  budget %9u", "allocs", measured.allocations, limits.allocations);
+        report.overBudget.push_back(text);
+    }
+}
+
+} // namespace golden
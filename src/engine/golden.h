@@ -0,0 +1,111 @@
+// Golden trajectories: a scene's entity states, recorded once and checked later, and the stage
+// time budgets of one machine, kept apart so the trajectory files can be shared
+#ifndef GOLDEN_H
+#define GOLDEN_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "metrics.h"
+
+class Entity;
+class World;
+
+namespace golden {
+
+// Buttons (input_handler::Button bits) the controlled entity holds on a tick
+using InputScript = std::uint8_t (*)(unsigned long long tick);
+
+// Advance a scene by one tick its own way, e.g. through a netcode session that may step the world
+// several times, rewinds included
+using Advance = void (*)(void *context, World &world);
+
+// Median time per tick for every stage and the whole step, plus the most heap allocations any
+// tick made (only meaningful in a FEELINGLOOPY_COUNT_ALLOCS build)
+struct Budget
+{
+    std::uint64_t stageNS[metrics::StageCount];
+    std::uint64_t stepNS;
+    std::uint32_t allocations;
+};
+
+// Exact state of one entity on a sampled tick: the bit patterns of sim::Real values
+struct Sample
+{
+    unsigned long long tick;
+    std::uint32_t entity;
+    std::uint64_t x, y, velocityX, velocityY;
+};
+
+struct Trace
+{
+    std::string scene;
+    std::string scalar; // sim::Real of the build that recorded it; other builds can't compare
+    int ticks = 0;
+    int sampleInterval = 0;
+    std::vector<std::uint64_t> hashes; // whole simulation state after every tick
+    std::vector<Sample> samples;       // every entity, every sampleInterval ticks
+    Budget budget{};                   // measured by run()
+};
+
+// Step world ticks times, feeding input (may be null) to the controlled entity, and record
+// its trajectory. Times and allocations of the first warmupTicks ticks are left out of the budget.
+// Trigger contacts are part of each tick's hash.
+Trace run(World &world, const std::string &scene, int ticks, InputScript input, int sampleInterval = 10, int warmupTicks = 60);
+// The same with advance(context, world) in place of each step. Its step time covers the whole
+// call; stage times and allocations are those of the last step it ran.
+Trace run(World &world, const std::string &scene, int ticks, Advance advance, void *context, int sampleInterval = 10, int warmupTicks = 60);
+
+// Trajectory only: the same on every machine for a given scalar type
+bool save(const Trace &trace, const std::string &path);
+bool load(const std::string &path, Trace &trace);
+
+// Per-stage median over several runs of a scene (the most allocations of any run), so one slow
+// run doesn't decide a budget
+Budget median(const std::vector<Budget> &runs);
+
+// Limits for one machine: each stage's measured median times slack, but never below floorNS
+// (sub-microsecond stages would fail on noise). runs is how many runs verification takes the
+// median of; the limits are plain numbers that can be edited by hand. referenceNS is the
+// recording machine's referenceNS(): verifying elsewhere scales the times by the ratio of the two,
+// so one checked-in file serves every machine. 0 keeps the limits absolute.
+struct Limits
+{
+    Budget budget{};
+    int runs = 5;
+    std::uint64_t referenceNS = 0;
+};
+bool saveLimits(const Budget &measured, int runs, std::uint64_t referenceNS, const std::string &path, double slack = 1.5,
+                std::uint64_t floorNS = 2000);
+bool loadLimits(const std::string &path, Limits &limits);
+
+// Fastest of several runs of a fixed workload that runs no engine code (sorting a pseudo-random
+// array), as a measure of how fast this machine is
+std::uint64_t referenceNS();
+// Limits whose times are multiplied by factor; allocations stay as they are
+Budget scaled(const Budget &limits, double factor);
+
+struct Report
+{
+    bool trajectoryMatches = true;
+    long long firstTick = -1;          // first tick whose state differs
+    std::string trajectory;            // what differs there
+    std::vector<std::string> overBudget; // one line per stage over its limit
+    bool passed() const { return trajectoryMatches && overBudget.empty(); }
+};
+
+// Compare a fresh run against a golden trace loaded from a file
+Report verify(const Trace &golden, const Trace &actual);
+// Add a line to the report for every stage whose measured time is over its limit
+void checkBudget(const Budget &limits, const Budget &measured, Report &report);
+
+// Hash of every entity's simulation state, as stored in traces for each tick
+std::uint64_t hashState(const std::vector<Entity> &entities);
+
+// Name of the build's simulation scalar, as stored in traces
+const char *scalarName();
+
+} // namespace golden
+
+#endif
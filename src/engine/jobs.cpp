@@ -0,0 +1,309 @@
+// Time-sliced job runner
+#include "jobs.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "metrics.h"
+#include "navigation.h"
+
+namespace jobs {
+
+void TimeSlicer::configure(const Config &config)
+{
+    config_ = config;
+}
+
+std::uint32_t TimeSlicer::post(Priority priority, Slice slice, void *context, bool repeat)
+{
+    std::lock_guard<std::mutex> lock(inboxMutex_);
+    const std::uint32_t id = nextId_++;
+    inbox_.emplace_back(priority, Job{slice, context, id, 0, repeat});
+    return id;
+}
+
+void TimeSlicer::remove(std::uint32_t id)
+{
+    std::lock_guard<std::mutex> lock(inboxMutex_);
+    removed_.push_back(id);
+}
+
+void TimeSlicer::clear()
+{
+    std::lock_guard<std::mutex> lock(inboxMutex_);
+    inbox_.clear();
+    removed_.clear();
+    for (Queue &q : queues_)
+    {
+        q.jobs.clear();
+        q.next = 0;
+    }
+}
+
+std::size_t TimeSlicer::pending() const
+{
+    std::size_t n = 0;
+    for (const Queue &q : queues_)
+        n += q.jobs.size();
+    std::lock_guard<std::mutex> lock(inboxMutex_);
+    return n + inbox_.size();
+}
+
+// Drop jobs whose slice was cleared, keeping order and the round-robin position
+void TimeSlicer::compact(Queue &queue)
+{
+    std::size_t kept = 0;
+    std::size_t keptBeforeNext = 0;
+    for (std::size_t i = 0; i < queue.jobs.size(); ++i)
+    {
+        if (!queue.jobs[i].slice) continue;
+        if (i < queue.next) ++keptBeforeNext;
+        queue.jobs[kept++] = queue.jobs[i];
+    }
+    queue.jobs.resize(kept);
+    queue.next = keptBeforeNext < kept ? keptBeforeNext : 0;
+}
+
+void TimeSlicer::adoptPosted()
+{
+    std::lock_guard<std::mutex> lock(inboxMutex_);
+    for (const std::pair<Priority, Job> &posted : inbox_)
+        queues_[static_cast<int>(posted.first)].jobs.push_back(posted.second);
+    inbox_.clear();
+    if (removed_.empty()) return;
+    for (Queue &q : queues_)
+    {
+        for (Job &job : q.jobs)
+        {
+            if (std::find(removed_.begin(), removed_.end(), job.id) != removed_.end()) job.slice = nullptr;
+        }
+        compact(q);
+    }
+    removed_.clear();
+}
+
+std::uint64_t TimeSlicer::runQueue(Queue &queue, std::uint64_t deadlineNS, bool force)
+{
+    const std::size_t n = queue.jobs.size();
+    if (n == 0) return 0;
+    const std::uint64_t start = metrics::nowNS();
+    std::uint64_t now = start;
+    std::size_t lastRan = n;
+    bool finished = false;
+    for (std::size_t k = 0; k < n; ++k)
+    {
+        const std::size_t i = (queue.next + k) % n;
+        Job &job = queue.jobs[i];
+        if (now >= deadlineNS)
+        {
+            // Out of time: only a job that has waited too long gets its slice
+            if (!force || job.deferred < static_cast<std::uint32_t>(std::max(config_.maxDeferFrames, 0)))
+            {
+                ++job.deferred;
+                continue;
+            }
+            ++stats_.forced;
+        }
+        const bool more = job.slice(job.context, std::max(deadlineNS, now));
+        now = metrics::nowNS();
+        ++stats_.slices;
+        job.deferred = 0;
+        lastRan = i;
+        if (!more && !job.repeat)
+        {
+            job.slice = nullptr;
+            finished = true;
+            ++stats_.completed;
+        }
+    }
+    if (lastRan < n) queue.next = (lastRan + 1) % n;
+    if (finished) compact(queue);
+    return now - start;
+}
+
+std::uint64_t TimeSlicer::run(std::uint64_t availableNS)
+{
+    adoptPosted();
+    ++stats_.frames;
+    const std::uint64_t start = metrics::nowNS();
+    const std::uint64_t budget = std::min(config_.budgetNS, availableNS);
+
+    // Foreground: priorities in order, one shared budget
+    std::uint64_t foreground = 0;
+    for (int p = 0; p < static_cast<int>(Priority::Background); ++p)
+        foreground += runQueue(queues_[p], start + budget, true);
+    stats_.foregroundNS += foreground;
+    if (foreground > budget) stats_.overrunNS += foreground - budget;
+
+    // Background: the rest of the frame, less the reserve
+    std::uint64_t background = 0;
+    if (availableNS > config_.reserveNS)
+        background = runQueue(queues_[static_cast<int>(Priority::Background)], start + availableNS - config_.reserveNS, false);
+    stats_.backgroundNS += background;
+    return foreground + background;
+}
+
+namespace {
+
+constexpr int kGridColumns = 96;
+constexpr int kGridRows = 64;
+
+// Walls with gaps, so builds are real searches around obstacles
+std::vector<std::uint8_t> makeGrid(int columns, int rows)
+{
+    std::vector<std::uint8_t> blocked(static_cast<std::size_t>(columns) * static_cast<std::size_t>(rows), 0);
+    for (int c = 8; c < columns; c += 12)
+    {
+        for (int r = 0; r < rows; ++r)
+        {
+            if ((r + c) % 23 > 3) blocked[static_cast<std::size_t>(r) * columns + c] = 1;
+        }
+    }
+    return blocked;
+}
+
+struct FieldRequest
+{
+    const std::vector<std::uint8_t> *blocked;
+    nav::FlowField *result; // where the finished field goes
+    int goal;
+    int postedFrame;
+    int doneFrame;
+    const int *frame;
+    bool started;
+    nav::FlowField field; // the build in progress
+};
+
+// A build stops at the deadline and picks up where it left off on the next slice
+bool buildRequest(void *context, std::uint64_t deadlineNS)
+{
+    FieldRequest &r = *static_cast<FieldRequest *>(context);
+    if (!r.started)
+    {
+        r.field.start(kGridColumns, kGridRows, r.goal);
+        r.started = true;
+    }
+    if (r.field.step(*r.blocked, deadlineNS)) return true;
+    *r.result = std::move(r.field);
+    r.doneFrame = *r.frame;
+    return false;
+}
+
+struct Sweep
+{
+    std::vector<std::uint8_t> blocked;
+    nav::FlowField field;
+    int columns;
+    int rows;
+    int goal = 0;
+    std::uint64_t builds = 0;
+};
+
+// Background: rebuild toward one goal after another while the deadline allows
+bool sweepFields(void *context, std::uint64_t deadlineNS)
+{
+    Sweep &s = *static_cast<Sweep *>(context);
+    while (!s.field.step(s.blocked, deadlineNS))
+    {
+        ++s.builds;
+        s.goal = (s.goal + 97) % (s.columns * s.rows);
+        s.field.start(s.columns, s.rows, s.goal);
+        if (metrics::nowNS() >= deadlineNS) break;
+    }
+    return true;
+}
+
+// Requests arriving on frame f: usually one, a burst of sixteen every 30th frame
+int arrivals(int frame)
+{
+    return frame % 30 == 29 ? 16 : (frame % 3 == 0 ? 1 : 0);
+}
+
+double percentile(std::vector<double> values, double p)
+{
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    const std::size_t i = static_cast<std::size_t>(std::ceil(p * static_cast<double>(values.size()))) - 1;
+    return values[std::min(i, values.size() - 1)];
+}
+
+} // namespace
+
+SlicingBenchmarkResult benchmarkTimeSlicing(int frames, double budgetMs, double frameMs)
+{
+    SlicingBenchmarkResult result{};
+    result.frames = frames;
+    const std::vector<std::uint8_t> blocked = makeGrid(kGridColumns, kGridRows);
+    nav::FlowField field;
+    int goals = 0;
+    auto nextGoal = [&goals]() { return (goals++ * 131) % (kGridColumns * kGridRows); };
+
+    // Everything the frame it arrives
+    std::vector<double> added;
+    added.reserve(static_cast<std::size_t>(std::max(frames, 0)));
+    std::uint64_t buildNS = 0;
+    for (int f = 0; f < frames; ++f)
+    {
+        const std::uint64_t start = metrics::nowNS();
+        for (int i = arrivals(f); i > 0; --i)
+            field.build(blocked, kGridColumns, kGridRows, nextGoal());
+        const std::uint64_t spent = metrics::nowNS() - start;
+        buildNS += spent;
+        result.fields += arrivals(f);
+        added.push_back(static_cast<double>(spent) / 1e6);
+    }
+    result.fieldMs = result.fields > 0 ? static_cast<double>(buildNS) / 1e6 / result.fields : 0.0;
+    result.immediateP50Ms = percentile(added, 0.50);
+    result.immediateP99Ms = percentile(added, 0.99);
+    result.immediateMaxMs = added.empty() ? 0.0 : *std::max_element(added.begin(), added.end());
+
+    // The same requests through the slicer, with a background sweep soaking up the rest
+    TimeSlicer slicer;
+    Config config;
+    config.budgetNS = static_cast<std::uint64_t>(budgetMs * 1e6);
+    config.reserveNS = static_cast<std::uint64_t>(frameMs * 0.1 * 1e6);
+    slicer.configure(config);
+    Sweep sweep;
+    sweep.blocked = makeGrid(kGridColumns * 2, kGridRows * 2);
+    sweep.columns = kGridColumns * 2;
+    sweep.rows = kGridRows * 2;
+    sweep.field.start(sweep.columns, sweep.rows, sweep.goal);
+    slicer.post(Priority::Background, sweepFields, &sweep, true);
+
+    std::vector<FieldRequest> requests(static_cast<std::size_t>(result.fields));
+    const std::uint64_t availableNS = static_cast<std::uint64_t>(frameMs * 0.5 * 1e6);
+    const Stats &stats = slicer.stats();
+    std::size_t posted = 0;
+    int frame = 0;
+    goals = 0;
+    added.clear();
+    // Keep going past the last frame until the backlog is gone (the sweep never finishes)
+    for (; frame < frames || slicer.pending() > 1; ++frame)
+    {
+        for (int i = frame < frames ? arrivals(frame) : 0; i > 0; --i)
+        {
+            FieldRequest &r = requests[posted++];
+            r = FieldRequest{&blocked, &field, nextGoal(), frame, -1, &frame, false, nav::FlowField()};
+            slicer.post(Priority::Normal, buildRequest, &r);
+        }
+        // Only foreground time competes with the frame's own work; background fills what is spare
+        const std::uint64_t before = stats.foregroundNS;
+        slicer.run(availableNS);
+        if (frame < frames) added.push_back(static_cast<double>(stats.foregroundNS - before) / 1e6);
+    }
+    result.slicedP50Ms = percentile(added, 0.50);
+    result.slicedP99Ms = percentile(added, 0.99);
+    result.slicedMaxMs = added.empty() ? 0.0 : *std::max_element(added.begin(), added.end());
+
+    double latency = 0.0;
+    for (const FieldRequest &r : requests)
+    {
+        latency += r.doneFrame - r.postedFrame;
+        result.maxLatencyFrames = std::max(result.maxLatencyFrames, r.doneFrame - r.postedFrame);
+    }
+    result.meanLatencyFrames = requests.empty() ? 0.0 : latency / static_cast<double>(requests.size());
+    result.backgroundBuildsPerFrame = static_cast<double>(sweep.builds) / std::max(frame, 1);
+    return result;
+}
+
+} // namespace jobs
@@ -0,0 +1,128 @@
+// Deferrable work run in time slices: a per-frame budget by priority, leftover time to background jobs
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace jobs {
+
+enum class Priority : std::uint8_t
+{
+    High,
+    Normal,
+    Low,
+    Background, // only in time the frame has left over after the budget
+    Count,
+};
+
+// One slice of a job: do work until deadlineNS (metrics::nowNS clock) or until there is none left,
+// and return true while more remains. A slice should check the clock between small units of work;
+// the slicer can't interrupt it, so a unit bigger than the budget overruns the frame.
+using Slice = bool (*)(void *context, std::uint64_t deadlineNS);
+
+struct Config
+{
+    std::uint64_t budgetNS = 2000000;  // foreground time per frame, shared by High, Normal and Low
+    std::uint64_t reserveNS = 1000000; // of the frame's spare time, kept free for jitter (background stops here)
+    int maxDeferFrames = 8;            // a foreground job passed over this many frames runs one slice anyway
+};
+
+struct Stats
+{
+    std::uint64_t frames = 0;
+    std::uint64_t slices = 0;
+    std::uint64_t forced = 0;       // slices run past the budget because a job waited maxDeferFrames
+    std::uint64_t foregroundNS = 0;
+    std::uint64_t backgroundNS = 0;
+    std::uint64_t overrunNS = 0;    // foreground time beyond the budget, summed over frames
+    std::uint64_t completed = 0;    // one-shot jobs finished
+};
+
+// Runs jobs between frames on one thread (the owner). Within a priority, jobs take turns: the
+// job after the last one to run goes first next frame, so a long job can't starve its peers.
+// post() and remove() may be called from any thread; slices always run on the owner's thread.
+class TimeSlicer
+{
+public:
+    TimeSlicer() = default;
+    TimeSlicer(const TimeSlicer &) = delete;
+    TimeSlicer &operator=(const TimeSlicer &) = delete;
+
+    void configure(const Config &config);
+    const Config &config() const { return config_; }
+
+    // Run slice(context, deadline) until it returns false. repeat keeps the job for good instead:
+    // it is offered a slice every frame and false only means "nothing to do this frame".
+    // Returns an id for remove().
+    std::uint32_t post(Priority priority, Slice slice, void *context, bool repeat = false);
+    // Drop a job from the next run() on. The context is the caller's to free once that run starts.
+    void remove(std::uint32_t id);
+    void clear();
+
+    // Once per frame, after the frame's own work: availableNS is the time until the next frame is
+    // due. Foreground jobs get min(budget, available); background jobs get whatever is left above
+    // the reserve. Returns the time spent.
+    std::uint64_t run(std::uint64_t availableNS);
+
+    std::size_t pending() const;
+    const Stats &stats() const { return stats_; }
+
+private:
+    struct Job
+    {
+        Slice slice;
+        void *context;
+        std::uint32_t id;
+        std::uint32_t deferred; // frames passed over while it had work
+        bool repeat;
+    };
+
+    struct Queue
+    {
+        std::vector<Job> jobs;
+        std::size_t next = 0; // round-robin start
+    };
+
+    void adoptPosted();
+    static void compact(Queue &queue);
+    // Offer slices to queue until deadline; force gives waiting jobs one slice regardless
+    std::uint64_t runQueue(Queue &queue, std::uint64_t deadlineNS, bool force);
+
+    Config config_;
+    Queue queues_[static_cast<int>(Priority::Count)];
+    Stats stats_;
+
+    mutable std::mutex inboxMutex_; // post()/remove() from other threads
+    std::vector<std::pair<Priority, Job>> inbox_;
+    std::vector<std::uint32_t> removed_;
+    std::uint32_t nextId_ = 0;
+};
+
+struct SlicingBenchmarkResult
+{
+    int frames;
+    int fields;             // flow fields requested in all
+    double fieldMs;         // one build
+    double immediateP50Ms;  // time added to a frame when every request is built the frame it arrives
+    double immediateP99Ms;
+    double immediateMaxMs;
+    double slicedP50Ms;     // the same requests through a TimeSlicer
+    double slicedP99Ms;
+    double slicedMaxMs;
+    double meanLatencyFrames; // frames from request to finished field, sliced
+    int maxLatencyFrames;
+    double backgroundBuildsPerFrame; // bigger fields built in spare time
+};
+
+// A steady trickle of flow-field rebuilds with a burst every 30th frame, built at once against
+// time-sliced at budgetMs per frame, each build resuming where its last slice stopped. The frame's
+// own work is taken as half of frameMs; a background job rebuilds fields on a bigger grid in
+// whatever is left.
+SlicingBenchmarkResult benchmarkTimeSlicing(int frames, double budgetMs, double frameMs);
+
+} // namespace jobs
+
+#endif
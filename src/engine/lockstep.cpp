@@ -0,0 +1,191 @@
+// Lock-step server/client implementation
+#include "lockstep.h"
+
+#include "world.h"
+#include "../input_handler.h"
+
+namespace net {
+
+LockstepServer::LockstepServer(World &world, Transport &transport)
+    : world_(world), transport_(transport) {}
+
+int LockstepServer::addPlayer(const Entity &avatar)
+{
+    world_.addEntity(avatar);
+    Player p;
+    p.entity = static_cast<std::uint32_t>(world_.getEntities().size() - 1);
+    players_.push_back(p);
+    return static_cast<int>(players_.size() - 1);
+}
+
+void LockstepServer::removePlayer(int player)
+{
+    if (player < 0 || player >= playerCount()) return;
+    Player &p = players_[player];
+    p.active = false;
+    p.pending.clear();
+    if (Entity *e = world_.getEntity(p.entity))
+        e->setDisabled(true);
+}
+
+void LockstepServer::receiveInputs()
+{
+    InputFrame in;
+    int from = 0;
+    while (transport_.receive(kServerEndpoint, buffer_, from))
+    {
+        if (!decode(buffer_, in)) continue;
+        // Only trust the player id implied by the sending endpoint
+        const int player = from - 1;
+        if (player < 0 || player >= playerCount() || in.player != player) continue;
+        Player &p = players_[player];
+        if (!p.active || in.tick <= tick_) continue;
+        p.pending.push_back(in);
+    }
+}
+
+bool LockstepServer::inputsReady(std::uint32_t tick) const
+{
+    for (const Player &p : players_)
+    {
+        if (!p.active) continue;
+        if (p.pending.empty() || p.pending.front().tick != tick) return false;
+    }
+    return true;
+}
+
+int LockstepServer::pump(int maxTicks)
+{
+    receiveInputs();
+    int advanced = 0;
+    while (advanced < maxTicks && inputsReady(tick_ + 1))
+    {
+        advance();
+        ++advanced;
+    }
+    return advanced;
+}
+
+void LockstepServer::advance()
+{
+    ++tick_;
+
+    // Inputs are applied in player order so every run sees the same sequence
+    for (Player &p : players_)
+    {
+        if (!p.active) continue;
+        const std::uint8_t held = p.pending.front().buttons;
+        p.pending.pop_front();
+        const std::uint8_t pressed = static_cast<std::uint8_t>(held & ~p.held);
+        p.held = held;
+        world_.getControls().applyButtons(world_.getEntity(p.entity), held, pressed);
+    }
+
+    world_.step();
+    broadcastDelta();
+}
+
+void LockstepServer::broadcastDelta()
+{
+    const std::vector<Entity> &entities = world_.getEntities();
+    current_.resize(entities.size());
+    for (std::uint32_t i = 0; i < entities.size(); ++i)
+        current_[i] = captureState(i, entities[i]);
+
+    delta_.tick = tick_;
+    delta_.entityCount = static_cast<std::uint32_t>(current_.size());
+    delta_.checksum = checksum(current_);
+    delta_.changes.clear();
+    for (std::uint32_t i = 0; i < current_.size(); ++i)
+    {
+        if (i >= lastSent_.size() || !sameState(current_[i], lastSent_[i]))
+            delta_.changes.push_back(current_[i]);
+    }
+    lastSent_.swap(current_);
+
+    encode(delta_, buffer_);
+    for (int player = 0; player < playerCount(); ++player)
+    {
+        if (players_[player].active)
+            transport_.send(kServerEndpoint, player + 1, buffer_);
+    }
+}
+
+LockstepClient::LockstepClient(Transport &transport, int player)
+    : transport_(transport), player_(player), endpoint_(player + 1) {}
+
+void LockstepClient::sendInput(std::uint8_t buttons)
+{
+    InputFrame in{nextInputTick_++, static_cast<std::uint16_t>(player_), buttons};
+    encode(in, buffer_);
+    transport_.send(endpoint_, kServerEndpoint, buffer_);
+}
+
+int LockstepClient::poll()
+{
+    int applied = 0;
+    int from = 0;
+    while (transport_.receive(endpoint_, buffer_, from))
+    {
+        if (from != kServerEndpoint || !decode(buffer_, delta_)) continue;
+        state_.resize(delta_.entityCount);
+        for (const EntityState &s : delta_.changes)
+        {
+            if (s.entity < state_.size())
+                state_[s.entity] = s;
+        }
+        if (checksum(state_) != delta_.checksum)
+            desynced_ = true;
+        tick_ = delta_.tick;
+        ++applied;
+    }
+    return applied;
+}
+
+ServerBenchmarkResult benchmarkServer(World &world, const Entity &avatar, int clients, int ticks)
+{
+    LoopbackTransport transport(clients + 1);
+    LockstepServer server(world, transport);
+    std::vector<LockstepClient> peers;
+    peers.reserve(clients);
+    for (int i = 0; i < clients; ++i)
+    {
+        Entity a = avatar;
+        a.setX(avatar.getX() + static_cast<float>((i % 32) * 40));
+        a.setY(avatar.getY() - static_cast<float>((i / 32) * 60));
+        peers.emplace_back(transport, server.addPlayer(a));
+    }
+
+    // Scripted, reproducible inputs: each client wanders and jumps on its own cycle
+    std::uint32_t seed = 0x9e3779b9u;
+    Uint64 serverNS = 0;
+    bool desynced = false;
+    for (int t = 0; t < ticks; ++t)
+    {
+        for (LockstepClient &c : peers)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            c.sendInput(static_cast<std::uint8_t>((seed >> 24) & (input_handler::ButtonLeft | input_handler::ButtonRight | input_handler::ButtonJump)));
+        }
+
+        const Uint64 start = SDL_GetTicksNS();
+        server.pump(1);
+        serverNS += SDL_GetTicksNS() - start;
+
+        for (LockstepClient &c : peers)
+        {
+            c.poll();
+            desynced = desynced || c.isDesynced();
+        }
+    }
+
+    ServerBenchmarkResult r;
+    r.clients = clients;
+    r.ticks = ticks;
+    r.secondsPerTick = ticks > 0 ? static_cast<double>(serverNS) / SDL_NS_PER_SECOND / ticks : 0.0;
+    r.bytesPerTick = ticks > 0 ? static_cast<double>(transport.bytesSent()) / ticks : 0.0;
+    r.desynced = desynced;
+    return r;
+}
+
+} // namespace net
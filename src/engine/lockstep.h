@@ -0,0 +1,102 @@
+// Authoritative lock-step server and mirror clients over a Transport
+#ifndef LOCKSTEP_H
+#define LOCKSTEP_H
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "netcode.h"
+#include "transport.h"
+
+class World;
+
+namespace net {
+
+// Advances the headless simulation one tick at a time, only once every active player's input for
+// that tick has arrived, then broadcasts what changed
+class LockstepServer
+{
+public:
+    LockstepServer(World &world, Transport &transport);
+
+    // Spawn an avatar for a new player; the player's endpoint is player + 1
+    int addPlayer(const Entity &avatar);
+    void removePlayer(int player);
+
+    // Drain received inputs and advance up to maxTicks ticks; returns ticks advanced
+    int pump(int maxTicks = 1);
+
+    std::uint32_t getTick() const { return tick_; }
+    int playerCount() const { return static_cast<int>(players_.size()); }
+
+private:
+    struct Player
+    {
+        std::uint32_t entity;
+        std::uint8_t held = 0;
+        bool active = true;
+        std::deque<InputFrame> pending;
+    };
+
+    void receiveInputs();
+    bool inputsReady(std::uint32_t tick) const;
+    void advance();
+    void broadcastDelta();
+
+    World &world_;
+    Transport &transport_;
+    std::vector<Player> players_;
+    std::uint32_t tick_ = 0;
+
+    std::vector<EntityState> lastSent_;
+    std::vector<EntityState> current_;
+    StateDelta delta_;
+    std::vector<std::uint8_t> buffer_;
+};
+
+// Keeps a replicated copy of the world from server deltas and sends local input
+class LockstepClient
+{
+public:
+    LockstepClient(Transport &transport, int player);
+
+    // Send held buttons for the next tick the client hasn't submitted yet
+    void sendInput(std::uint8_t buttons);
+
+    // Apply pending deltas; returns how many were applied
+    int poll();
+
+    const std::vector<EntityState> &getState() const { return state_; }
+    std::uint32_t getTick() const { return tick_; }
+    // True once a received checksum didn't match the replicated state
+    bool isDesynced() const { return desynced_; }
+
+private:
+    Transport &transport_;
+    int player_;
+    int endpoint_;
+    std::uint32_t nextInputTick_ = 1;
+    std::uint32_t tick_ = 0;
+    bool desynced_ = false;
+    std::vector<EntityState> state_;
+    StateDelta delta_;
+    std::vector<std::uint8_t> buffer_;
+};
+
+struct ServerBenchmarkResult
+{
+    int clients;
+    int ticks;
+    double secondsPerTick;  // server work (receive, simulate, broadcast) on the calling core
+    double bytesPerTick;    // transport traffic in both directions
+    bool desynced;
+};
+
+// Run clients over a loopback transport for the given number of ticks on the calling thread.
+// The world must already hold the scene; avatars are copies of avatar.
+ServerBenchmarkResult benchmarkServer(World &world, const Entity &avatar, int clients, int ticks);
+
+} // namespace net
+
+#endif
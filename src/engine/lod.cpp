@@ -0,0 +1,53 @@
+// LOD tier assignment
+#include "lod.h"
+
+namespace lod {
+
+static int divisorFor(float distanceSq, const Config &config)
+{
+    for (const Tier &t : config.tiers)
+    {
+        if (distanceSq <= t.maxDistance * t.maxDistance)
+            return t.tickDivisor;
+    }
+    return config.outermostDivisor;
+}
+
+void assignTiers(std::vector<Entity> &entities, const Entity *focus, const SDL_FRect &view, const Config &config)
+{
+    const SDL_FRect padded{view.x - config.cullMargin, view.y - config.cullMargin,
+                           view.w + 2.0f * config.cullMargin, view.h + 2.0f * config.cullMargin};
+
+    float fx = 0.0f, fy = 0.0f;
+    if (focus)
+    {
+        fx = sim::toFloat(focus->getX()) + 0.5f * focus->getWidth() * focus->getScale();
+        fy = sim::toFloat(focus->getY()) + 0.5f * focus->getHeight() * focus->getScale();
+    }
+
+    for (Entity &e : entities)
+    {
+        const float w = e.getWidth() * e.getScale();
+        const float h = e.getHeight() * e.getScale();
+        const float x = sim::toFloat(e.getX());
+        const float y = sim::toFloat(e.getY());
+        const bool visible = (x < padded.x + padded.w) && (x + w > padded.x) &&
+                             (y < padded.y + padded.h) && (y + h > padded.y);
+        if (e.isCulled() == visible)
+            e.setCulled(!visible);
+
+        if (!e.isMovable() || e.isControllable())
+            continue;
+
+        if (!focus)
+        {
+            e.setLodTickDivisor(1);
+            continue;
+        }
+        const float dx = x + 0.5f * w - fx;
+        const float dy = y + 0.5f * h - fy;
+        e.setLodTickDivisor(divisorFor(dx * dx + dy * dy, config));
+    }
+}
+
+} // namespace lod
@@ -0,0 +1,35 @@
+// Distance-based update-rate tiers for entities far from the player
+#ifndef LOD_H
+#define LOD_H
+
+#include <SDL3/SDL.h>
+#include <vector>
+
+#include "entity.h"
+
+namespace lod {
+
+// Entities within maxDistance of the focus (and beyond the previous tier) step every tickDivisor ticks
+struct Tier
+{
+    float maxDistance;
+    int tickDivisor;
+};
+
+// Off by default, so small scenes keep every entity at the full rate: a scene opts in by setting
+// reassignInterval (15 suits the default tiers)
+struct Config
+{
+    std::vector<Tier> tiers{{800.0f, 1}, {1600.0f, 2}, {3200.0f, 4}};
+    int outermostDivisor = 8; // beyond the last tier
+    int reassignInterval = 0; // ticks between tier passes; 0 turns tiering and culling off
+    float cullMargin = 64.0f; // view padding before animation is skipped
+};
+
+// Pick a tick divisor for every movable entity from its distance to focus, and flag entities
+// outside view (expanded by cullMargin) as culled. With no focus everything runs at full rate.
+void assignTiers(std::vector<Entity> &entities, const Entity *focus, const SDL_FRect &view, const Config &config);
+
+} // namespace lod
+
+#endif
@@ -0,0 +1,278 @@
+// Shared-memory ring of per-tick counters
+#include "metrics.h"
+
+#include <chrono>
+#include <cstring>
+#include <new>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace metrics {
+
+namespace {
+
+constexpr std::uint32_t kMagic = 0x4d4c4c46u; // "FLLM"
+constexpr std::uint32_t kVersion = 1;
+
+#ifdef _WIN32
+std::string mappingName(const std::string &name) { return "Local\\" + name; }
+#else
+// POSIX shared memory names are a single path component with a leading slash
+std::string mappingName(const std::string &name) { return "/" + name; }
+#endif
+
+std::size_t ringBytes(std::uint32_t capacity)
+{
+    return sizeof(RingHeader) + static_cast<std::size_t>(capacity) * sizeof(RingSlot);
+}
+
+} // namespace
+
+const char *stageName(int stage)
+{
+    switch (stage)
+    {
+    case StageInput: return "input";
+    case StageLod: return "lod";
+    case StageSystems: return "systems";
+    case StageBroadphase: return "broadphase";
+    case StageMovers: return "movers";
+    case StageTriggers: return "triggers";
+    case StageQueries: return "queries";
+    case StageParticles: return "particles";
+    default: return "?";
+    }
+}
+
+std::uint64_t nowNS()
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+std::uint64_t processId()
+{
+#ifdef _WIN32
+    return GetCurrentProcessId();
+#else
+    return static_cast<std::uint64_t>(getpid());
+#endif
+}
+
+std::string defaultName(std::uint64_t pid)
+{
+    return "feelingloopy-" + std::to_string(pid);
+}
+
+bool SharedMemory::create(const std::string &name, std::size_t bytes)
+{
+    close();
+    const std::string shmName = mappingName(name);
+#ifdef _WIN32
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(static_cast<std::uint64_t>(bytes) >> 32),
+                                        static_cast<DWORD>(bytes), shmName.c_str());
+    if (!mapping) return false;
+    void *view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+    if (!view)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+    mapping_ = mapping;
+#else
+    shm_unlink(shmName.c_str()); // left behind by a crashed run with the same name
+    const int fd = shm_open(shmName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) return false;
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0)
+    {
+        ::close(fd);
+        shm_unlink(shmName.c_str());
+        return false;
+    }
+    void *view = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED)
+    {
+        shm_unlink(shmName.c_str());
+        return false;
+    }
+#endif
+    data_ = static_cast<unsigned char *>(view);
+    size_ = bytes;
+    owner_ = true;
+    name_ = shmName;
+    return true;
+}
+
+bool SharedMemory::open(const std::string &name)
+{
+    close();
+    const std::string shmName = mappingName(name);
+#ifdef _WIN32
+    HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, shmName.c_str());
+    if (!mapping) return false;
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info;
+    if (!view || VirtualQuery(view, &info, sizeof(info)) == 0)
+    {
+        if (view) UnmapViewOfFile(view);
+        CloseHandle(mapping);
+        return false;
+    }
+    mapping_ = mapping;
+    size_ = info.RegionSize;
+#else
+    const int fd = shm_open(shmName.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    void *view = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) return false;
+    size_ = static_cast<std::size_t>(st.st_size);
+#endif
+    data_ = static_cast<unsigned char *>(view);
+    owner_ = false;
+    name_ = shmName;
+    return true;
+}
+
+void SharedMemory::close()
+{
+    if (!data_) return;
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+    CloseHandle(static_cast<HANDLE>(mapping_));
+    mapping_ = nullptr;
+#else
+    munmap(data_, size_);
+    if (owner_) shm_unlink(name_.c_str());
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    owner_ = false;
+    name_.clear();
+}
+
+bool Publisher::open(const std::string &name, std::uint32_t capacity)
+{
+    close();
+    if (capacity == 0) return false;
+    if (!memory_.create(name, ringBytes(capacity))) return false;
+
+    header_ = new (memory_.data()) RingHeader;
+    header_->magic.store(0, std::memory_order_relaxed);
+    slots_ = reinterpret_cast<RingSlot *>(memory_.data() + sizeof(RingHeader));
+    for (std::uint32_t i = 0; i < capacity; ++i)
+    {
+        RingSlot *slot = new (&slots_[i]) RingSlot;
+        slot->sequence.store(0, std::memory_order_relaxed);
+    }
+    header_->version = kVersion;
+    header_->recordSize = sizeof(Frame);
+    header_->capacity = capacity;
+    header_->published.store(0, std::memory_order_relaxed);
+    header_->pid = processId();
+    // Readers check the magic first, so set it after everything else is in place
+    header_->magic.store(kMagic, std::memory_order_release);
+    next_ = 0;
+    name_ = name;
+    return true;
+}
+
+void Publisher::close()
+{
+    if (header_) header_->magic.store(0, std::memory_order_release);
+    memory_.close();
+    header_ = nullptr;
+    slots_ = nullptr;
+    name_.clear();
+}
+
+void Publisher::publish(const Frame &frame)
+{
+    if (!header_) return;
+    RingSlot &slot = slots_[next_ % header_->capacity];
+    // Odd while the copy is in progress; the fence keeps the copy from moving above the mark
+    slot.sequence.store(2 * next_ + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&slot.frame, &frame, sizeof(Frame));
+    slot.sequence.store(2 * next_ + 2, std::memory_order_release);
+    ++next_;
+    header_->published.store(next_, std::memory_order_release);
+}
+
+bool Reader::open(const std::string &name)
+{
+    close();
+    if (!memory_.open(name)) return false;
+    if (memory_.size() < sizeof(RingHeader))
+    {
+        memory_.close();
+        return false;
+    }
+    const RingHeader *header = reinterpret_cast<const RingHeader *>(memory_.data());
+    const bool valid = header->magic.load(std::memory_order_acquire) == kMagic && header->version == kVersion && header->recordSize == sizeof(Frame) && header->capacity > 0 &&
+                       memory_.size() >= ringBytes(header->capacity);
+    if (!valid)
+    {
+        memory_.close();
+        return false;
+    }
+    header_ = header;
+    slots_ = reinterpret_cast<const RingSlot *>(memory_.data() + sizeof(RingHeader));
+    return true;
+}
+
+void Reader::close()
+{
+    memory_.close();
+    header_ = nullptr;
+    slots_ = nullptr;
+}
+
+bool Reader::isLive() const
+{
+    return header_ && header_->magic.load(std::memory_order_acquire) == kMagic;
+}
+
+std::uint64_t Reader::published() const
+{
+    return header_ ? header_->published.load(std::memory_order_acquire) : 0;
+}
+
+std::uint32_t Reader::capacity() const
+{
+    return header_ ? header_->capacity : 0;
+}
+
+std::uint64_t Reader::pid() const
+{
+    return header_ ? header_->pid : 0;
+}
+
+bool Reader::read(std::uint64_t index, Frame &out) const
+{
+    if (!header_) return false;
+    const RingSlot &slot = slots_[index % header_->capacity];
+    const std::uint64_t expected = 2 * index + 2;
+    if (slot.sequence.load(std::memory_order_acquire) != expected) return false;
+    std::memcpy(&out, &slot.frame, sizeof(Frame));
+    // The copy must finish before the sequence is checked again
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == expected;
+}
+
+} // namespace metrics
@@ -0,0 +1,148 @@
+// Per-tick counters published to a shared-memory ring for external readers
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace metrics {
+
+// Timed parts of one simulation tick
+enum Stage : int
+{
+    StageInput,      // gameplay input (Engine only)
+    StageLod,        // tier assignment
+    StageSystems,    // animation, path following, navigation, scripts, behaviours
+    StageBroadphase, // collider sync, swept proxies, pair search
+    StageMovers,     // physics, collision response and the events it posts
+    StageTriggers,
+    StageQueries,    // spatial query grid rebuild
+    StageParticles,
+    StageCount
+};
+
+const char *stageName(int stage);
+
+// One record per tick. Plain data with a fixed layout: readers in other processes copy it as is.
+struct Frame
+{
+    std::uint64_t tick;
+    std::uint64_t timeNS; // steady clock when the tick finished
+    std::uint32_t stageNS[StageCount];
+    std::uint32_t stepNS;   // whole tick, including stages not listed
+    std::uint32_t renderNS; // last frame drawn by the render thread
+    std::uint32_t drawCalls; // in that frame
+    std::uint32_t entities;
+    std::uint32_t movable;
+    std::uint32_t controllable;
+    std::uint32_t collidable;
+    std::uint32_t triggers;
+    std::uint32_t culled;
+    std::uint32_t disabled;
+    std::uint32_t collisionPairs;  // broadphase candidate pairs
+    std::uint32_t collisionProbes; // narrow-phase tests of a mover against its candidates
+    std::uint32_t particles;
+    std::uint32_t allocations; // heap allocations during the tick (0 unless counting is compiled in)
+    std::uint32_t arenaBytes;  // frame arena used by the tick
+};
+
+// Named shared memory, created by the publisher and opened read-only by readers
+class SharedMemory
+{
+public:
+    SharedMemory() = default;
+    ~SharedMemory() { close(); }
+    SharedMemory(const SharedMemory &) = delete;
+    SharedMemory &operator=(const SharedMemory &) = delete;
+
+    bool create(const std::string &name, std::size_t bytes);
+    bool open(const std::string &name);
+    void close();
+    unsigned char *data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    unsigned char *data_ = nullptr;
+    std::size_t size_ = 0;
+    bool owner_ = false;
+    std::string name_;
+#ifdef _WIN32
+    void *mapping_ = nullptr;
+#endif
+};
+
+// Shared layout: a header, then capacity slots. Each slot is a seqlock: the writer marks it odd
+// while copying a record in and even when done, so a reader can tell a torn copy from a good one
+// without the writer ever waiting.
+struct RingHeader
+{
+    std::atomic<std::uint32_t> magic; // set once the ring is ready, cleared when the writer shuts down
+    std::uint32_t version;
+    std::uint32_t recordSize;
+    std::uint32_t capacity;
+    std::atomic<std::uint64_t> published; // records written so far
+    std::uint64_t pid;
+};
+
+struct RingSlot
+{
+    std::atomic<std::uint64_t> sequence; // 2 * index + 2 once record index is complete
+    Frame frame;
+};
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free && std::atomic<std::uint64_t>::is_always_lock_free,
+              "ring counters must be lock-free to share across processes");
+
+// Single writer (the simulation thread)
+class Publisher
+{
+public:
+    bool open(const std::string &name, std::uint32_t capacity = 1024);
+    void close();
+    bool isOpen() const { return header_ != nullptr; }
+    const std::string &name() const { return name_; }
+
+    // Never blocks; the oldest record is overwritten once the ring is full
+    void publish(const Frame &frame);
+
+private:
+    SharedMemory memory_;
+    RingHeader *header_ = nullptr;
+    RingSlot *slots_ = nullptr;
+    std::uint64_t next_ = 0;
+    std::string name_;
+};
+
+class Reader
+{
+public:
+    bool open(const std::string &name);
+    void close();
+    bool isOpen() const { return header_ != nullptr; }
+    // False once the writer has shut down
+    bool isLive() const;
+
+    std::uint64_t published() const;
+    std::uint32_t capacity() const;
+    std::uint64_t pid() const;
+    // Copy record index; false if it is not written yet or was overwritten during the copy
+    bool read(std::uint64_t index, Frame &out) const;
+
+private:
+    SharedMemory memory_;
+    const RingHeader *header_ = nullptr;
+    const RingSlot *slots_ = nullptr;
+};
+
+// Nanoseconds since an arbitrary epoch, from a monotonic clock
+std::uint64_t nowNS();
+
+std::uint64_t processId();
+// Ring name a game publishes under when none is configured: "feelingloopy-<pid>"
+std::string defaultName(std::uint64_t pid);
+
+} // namespace metrics
+
+#endif
@@ -0,0 +1,794 @@
+// Flow-field navigation
+#include "navigation.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+
+#include "metrics.h"
+#include "tilemap.h"
+#include "world.h"
+
+namespace nav {
+
+namespace {
+
+// East first, clockwise with +y down; odd directions are diagonal
+constexpr int kStepX[8] = {1, 1, 0, -1, -1, -1, 0, 1};
+constexpr int kStepY[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+constexpr std::uint32_t kStraightCost = 10;
+constexpr std::uint32_t kDiagonalCost = 14;
+constexpr std::size_t kHistory = 64; // requests kept for restore
+constexpr int kSearchBatch = 64;     // cells settled between clock checks in a resumable build
+
+// Whether a step from (column, row) in direction d stays on the grid and, for diagonals, does not
+// squeeze between two blocked cells
+bool canStep(const std::vector<std::uint8_t> &blocked, int columns, int rows, int column, int row, int d)
+{
+    const int c = column + kStepX[d];
+    const int r = row + kStepY[d];
+    if (c < 0 || r < 0 || c >= columns || r >= rows) return false;
+    if (blocked[static_cast<std::size_t>(r) * columns + c]) return false;
+    if (d & 1)
+    {
+        if (blocked[static_cast<std::size_t>(row) * columns + c] || blocked[static_cast<std::size_t>(r) * columns + column]) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+void FlowField::build(const std::vector<std::uint8_t> &blocked, int columns, int rows, int goal)
+{
+    start(columns, rows, goal);
+    while (step(blocked, UINT64_MAX))
+    {
+    }
+}
+
+void FlowField::start(int columns, int rows, int goal)
+{
+    const std::size_t n = static_cast<std::size_t>(columns) * static_cast<std::size_t>(rows);
+    cost_.assign(n, kUnreachable);
+    direction_.assign(n, kNoDirection);
+    open_.clear();
+    columns_ = columns;
+    rows_ = rows;
+    goal_ = goal;
+    if (goal < 0 || static_cast<std::size_t>(goal) >= n)
+    {
+        nextRow_ = rows; // nothing to search or point
+        return;
+    }
+
+    // Dijkstra outward from the goal; the goal itself may be blocked (player against a wall)
+    cost_[goal] = 0;
+    open_.push_back(static_cast<std::uint64_t>(goal));
+    nextRow_ = 0;
+}
+
+bool FlowField::step(const std::vector<std::uint8_t> &blocked, std::uint64_t deadlineNS)
+{
+    const std::greater<std::uint64_t> later;
+    const int columns = columns_;
+    const int rows = rows_;
+    int batch = 0;
+    while (!open_.empty())
+    {
+        std::pop_heap(open_.begin(), open_.end(), later);
+        const std::uint64_t top = open_.back();
+        open_.pop_back();
+        const std::uint32_t cost = static_cast<std::uint32_t>(top >> 32);
+        const int cell = static_cast<int>(top & 0xffffffffu);
+        if (cost > cost_[cell]) continue; // stale entry
+
+        const int column = cell % columns;
+        const int row = cell / columns;
+        for (int d = 0; d < 8; ++d)
+        {
+            if (!canStep(blocked, columns, rows, column, row, d)) continue;
+            const int next = (row + kStepY[d]) * columns + column + kStepX[d];
+            const std::uint32_t nextCost = cost + ((d & 1) ? kDiagonalCost : kStraightCost);
+            if (nextCost < cost_[next])
+            {
+                cost_[next] = nextCost;
+                open_.push_back(static_cast<std::uint64_t>(nextCost) << 32 | static_cast<std::uint32_t>(next));
+                std::push_heap(open_.begin(), open_.end(), later);
+            }
+        }
+        // The clock is read after each batch, so every call makes progress
+        if (++batch == kSearchBatch)
+        {
+            batch = 0;
+            if (metrics::nowNS() >= deadlineNS) return true;
+        }
+    }
+
+    // Each cell points at its cheapest neighbour; ties go to the first direction in order. One row
+    // per clock check.
+    while (nextRow_ < rows)
+    {
+        const int row = nextRow_++;
+        for (int column = 0; column < columns; ++column)
+        {
+            const int cell = row * columns + column;
+            if (cell == goal_) continue;
+            const bool open = !blocked[cell];
+            std::uint32_t best = open ? cost_[cell] : kUnreachable;
+            for (int d = 0; d < 8; ++d)
+            {
+                const int c = column + kStepX[d];
+                const int r = row + kStepY[d];
+                if (open ? !canStep(blocked, columns, rows, column, row, d) : (c < 0 || r < 0 || c >= columns || r >= rows)) continue;
+                const std::uint32_t neighbour = cost_[r * columns + c];
+                if (neighbour < best)
+                {
+                    best = neighbour;
+                    direction_[cell] = static_cast<std::uint8_t>(d);
+                }
+            }
+        }
+        if (nextRow_ < rows && metrics::nowNS() >= deadlineNS) return true;
+    }
+    return false;
+}
+
+void FlowField::clear()
+{
+    cost_.clear();
+    direction_.clear();
+    goal_ = -1;
+}
+
+Navigation::~Navigation()
+{
+    if (sliced_ && !jobDone_) jobs_->remove(jobId_);
+    stopWorker();
+}
+
+void Navigation::configure(const Config &config)
+{
+    stopWorker();
+    config_ = config;
+    if (config_.cellSize <= 0.0f) config_.cellSize = 32.0f;
+    if (config_.refreshInterval < 1) config_.refreshInterval = 1;
+    clear();
+}
+
+void Navigation::clear()
+{
+    discardInFlight();
+    const std::size_t n = enabled() ? static_cast<std::size_t>(config_.columns) * static_cast<std::size_t>(config_.rows) : 0;
+    entityBlockers_.assign(n, 0);
+    terrainBlocked_.assign(n, 0);
+    blocked_.assign(n, 0);
+    stamps_.clear();
+    terrain_ = nullptr;
+    terrainRevision_ = 0;
+    obstacleRevision_ = 0;
+    requestedRevision_ = 0;
+    requestedGoal_ = -1;
+    active_.clear();
+    pending_.clear();
+    history_.clear();
+    pruneGrids();
+}
+
+int Navigation::cellAt(float x, float y) const
+{
+    if (!enabled()) return -1;
+    const float fx = std::floor((x - config_.originX) / config_.cellSize);
+    const float fy = std::floor((y - config_.originY) / config_.cellSize);
+    if (fx < 0.0f || fy < 0.0f || fx >= static_cast<float>(config_.columns) || fy >= static_cast<float>(config_.rows)) return -1;
+    return static_cast<int>(fy) * config_.columns + static_cast<int>(fx);
+}
+
+bool Navigation::isBlocked(int cell) const
+{
+    return cell >= 0 && static_cast<std::size_t>(cell) < blocked_.size() && blocked_[cell] != 0;
+}
+
+Navigation::Stamp Navigation::cover(float x, float y, float w, float h) const
+{
+    const Stamp none{0, 0, -1, -1};
+    const float left = (x - config_.clearance - config_.originX) / config_.cellSize;
+    const float top = (y - config_.clearance - config_.originY) / config_.cellSize;
+    const float right = (x + w + config_.clearance - config_.originX) / config_.cellSize;
+    const float bottom = (y + h + config_.clearance - config_.originY) / config_.cellSize;
+    if (right <= 0.0f || bottom <= 0.0f || left >= static_cast<float>(config_.columns) || top >= static_cast<float>(config_.rows)) return none;
+
+    // Cells the box overlaps; one that only touches a cell's edge does not block it
+    Stamp s;
+    s.column0 = std::max(0, static_cast<int>(std::floor(left)));
+    s.row0 = std::max(0, static_cast<int>(std::floor(top)));
+    s.column1 = std::min(config_.columns - 1, static_cast<int>(std::ceil(right)) - 1);
+    s.row1 = std::min(config_.rows - 1, static_cast<int>(std::ceil(bottom)) - 1);
+    return s.column1 < s.column0 || s.row1 < s.row0 ? none : s;
+}
+
+void Navigation::stamp(const Stamp &s, int delta)
+{
+    for (int r = s.row0; r <= s.row1; ++r)
+    {
+        for (int c = s.column0; c <= s.column1; ++c)
+        {
+            const std::size_t i = static_cast<std::size_t>(r) * config_.columns + c;
+            entityBlockers_[i] = static_cast<std::uint16_t>(entityBlockers_[i] + delta);
+            blocked_[i] = entityBlockers_[i] != 0 || terrainBlocked_[i] != 0;
+        }
+    }
+}
+
+void Navigation::syncObstacles(const std::vector<Entity> &entities, TileLayer *terrain)
+{
+    const Stamp none{0, 0, -1, -1};
+
+    // Entities removed from the end of the list take their stamps with them
+    for (std::size_t i = entities.size(); i < stamps_.size(); ++i)
+    {
+        if (stamps_[i] != none)
+        {
+            stamp(stamps_[i], -1);
+            ++obstacleRevision_;
+        }
+    }
+    stamps_.resize(entities.size(), none);
+
+    // Static colliders block; anything that moves is steered around, not planned around
+    for (std::size_t i = 0; i < entities.size(); ++i)
+    {
+        const Entity &e = entities[i];
+        const bool blocks = e.isCollidable() && !e.isMovable() && !e.isTrigger() && !e.isDisabled();
+        const Stamp s = blocks ? cover(sim::toFloat(e.getX()), sim::toFloat(e.getY()), e.getWidth() * e.getScale(), e.getHeight() * e.getScale()) : none;
+        if (s != stamps_[i])
+        {
+            stamp(stamps_[i], -1);
+            stamp(s, 1);
+            stamps_[i] = s;
+            ++obstacleRevision_;
+        }
+    }
+
+    const std::uint64_t revision = terrain ? terrain->revision() : 0;
+    if (terrain == terrain_ && revision == terrainRevision_) return;
+    std::fill(terrainBlocked_.begin(), terrainBlocked_.end(), 0);
+    if (terrain)
+    {
+        terrain->forEachSolidRect([this](const SDL_FRect &r) {
+            const Stamp s = cover(r.x, r.y, r.w, r.h);
+            for (int row = s.row0; row <= s.row1; ++row)
+                std::fill_n(terrainBlocked_.begin() + static_cast<std::ptrdiff_t>(row) * config_.columns + s.column0, s.column1 - s.column0 + 1, 1);
+        });
+    }
+    for (std::size_t i = 0; i < blocked_.size(); ++i)
+        blocked_[i] = entityBlockers_[i] != 0 || terrainBlocked_[i] != 0;
+    terrain_ = terrain;
+    terrainRevision_ = revision;
+    ++obstacleRevision_;
+}
+
+int Navigation::goalCell(const std::vector<Entity> &entities, int controlled, float &goalX, float &goalY) const
+{
+    const int index = config_.goalEntity >= 0 ? config_.goalEntity : controlled;
+    if (index < 0 || static_cast<std::size_t>(index) >= entities.size() || entities[index].isDisabled()) return -1;
+    const Entity &g = entities[index];
+    goalX = sim::toFloat(g.getX()) + g.getWidth() * g.getScale() * 0.5f;
+    goalY = sim::toFloat(g.getY()) + g.getHeight() * g.getScale() * 0.5f;
+
+    // A goal off the grid pulls towards the nearest edge cell
+    const int column = std::clamp(static_cast<int>(std::floor((goalX - config_.originX) / config_.cellSize)), 0, config_.columns - 1);
+    const int row = std::clamp(static_cast<int>(std::floor((goalY - config_.originY) / config_.cellSize)), 0, config_.rows - 1);
+    return row * config_.columns + column;
+}
+
+void Navigation::update(std::vector<Entity> &entities, const ecs::ArchetypeRegistry &archetypes, TileLayer *terrain, int controlled,
+                        unsigned long long tick)
+{
+    if (!enabled()) return;
+    if (inFlight_ && tick >= adoptTick_) collect();
+
+    float goalX = 0.0f;
+    float goalY = 0.0f;
+    const int goal = goalCell(entities, controlled, goalX, goalY);
+
+    // Until the first field exists it is built and adopted on the spot
+    const bool first = active_.empty() && !inFlight_;
+    const unsigned long long interval = static_cast<unsigned long long>(config_.refreshInterval);
+    if (first || tick % interval == 0)
+    {
+        syncObstacles(entities, terrain);
+        if (goal >= 0 && (first || goal != requestedGoal_ || obstacleRevision_ != requestedRevision_))
+            issue(goal, tick, first ? tick : tick + interval);
+    }
+
+    steer(entities, archetypes, goalX, goalY);
+}
+
+void Navigation::issue(int goal, unsigned long long tick, unsigned long long adoptTick)
+{
+    history_.push_back(Request{tick, adoptTick, goal, obstacleRevision_});
+    if (history_.size() > kHistory) history_.erase(history_.begin());
+    requestedGoal_ = goal;
+    requestedRevision_ = obstacleRevision_;
+
+    // Keep the obstacles this request saw so a restore can rebuild its field exactly
+    if (grids_.empty() || grids_.back().revision != obstacleRevision_)
+    {
+        Grid grid;
+        if (!spareGrids_.empty())
+        {
+            grid = std::move(spareGrids_.back());
+            spareGrids_.pop_back();
+        }
+        grid.revision = obstacleRevision_;
+        grid.blocked = blocked_; // same size every time, so reused grids do not allocate
+        grids_.push_back(std::move(grid));
+        pruneGrids();
+    }
+
+    startJob(goal, obstacleRevision_, blocked_, adoptTick, adoptTick == tick);
+    if (adoptTick == tick) collect();
+}
+
+const std::vector<std::uint8_t> &Navigation::gridAt(std::uint64_t revision) const
+{
+    for (const Grid &g : grids_)
+    {
+        if (g.revision == revision) return g.blocked;
+    }
+    return blocked_; // every request's revision has a grid; not reached
+}
+
+// Drop grids no remaining request refers to
+void Navigation::pruneGrids()
+{
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < grids_.size(); ++i)
+    {
+        const bool used = std::any_of(history_.begin(), history_.end(), [&](const Request &r) { return r.revision == grids_[i].revision; });
+        if (!used)
+            spareGrids_.push_back(std::move(grids_[i]));
+        else if (kept++ != i)
+            grids_[kept - 1] = std::move(grids_[i]);
+    }
+    grids_.resize(kept);
+}
+
+void Navigation::startJob(int goal, std::uint64_t revision, const std::vector<std::uint8_t> &blocked, unsigned long long adoptTick,
+                          bool inlineBuild)
+{
+    inFlight_ = true;
+    adoptTick_ = adoptTick;
+    pendingRevision_ = revision;
+    if (inlineBuild || !config_.background)
+    {
+        build(pending_, blocked, goal);
+        return;
+    }
+
+    if (jobs_)
+    {
+        // Only the simulation thread touches the job, so no handover is needed
+        jobBlocked_ = blocked;
+        pending_.start(config_.columns, config_.rows, goal);
+        jobDone_ = false;
+        sliced_ = true;
+        jobId_ = jobs_->post(jobs::Priority::Normal, buildSlice, this);
+        return;
+    }
+
+    if (!worker_.joinable())
+        worker_ = std::thread(&Navigation::workerLoop, this);
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobBlocked_ = blocked; // same size every time, so no allocation after the first
+    jobGoal_ = goal;
+    jobReady_ = true;
+    jobDone_ = false;
+    wake_.notify_one();
+}
+
+void Navigation::collect()
+{
+    if (!inFlight_) return;
+    if (sliced_)
+    {
+        finishSliced();
+    }
+    else
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!jobDone_)
+        {
+            const std::uint64_t start = metrics::nowNS();
+            done_.wait(lock, [this] { return jobDone_; });
+            waitNS_ += metrics::nowNS() - start;
+        }
+    }
+    std::swap(active_, pending_);
+    std::swap(activeRevision_, pendingRevision_);
+    inFlight_ = false;
+}
+
+void Navigation::discardInFlight()
+{
+    if (!inFlight_) return;
+    if (sliced_)
+    {
+        if (!jobDone_) jobs_->remove(jobId_);
+        jobDone_ = true;
+        sliced_ = false;
+        inFlight_ = false;
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return jobDone_; });
+    inFlight_ = false;
+}
+
+// Complete the sliced build now (it is due, or the slicer is going away)
+void Navigation::finishSliced()
+{
+    if (!jobDone_)
+    {
+        jobs_->remove(jobId_);
+        const std::uint64_t start = metrics::nowNS();
+        while (pending_.step(jobBlocked_, UINT64_MAX))
+        {
+        }
+        const std::uint64_t spent = metrics::nowNS() - start;
+        waitNS_ += spent;
+        buildNS_.fetch_add(spent, std::memory_order_relaxed);
+        builds_.fetch_add(1, std::memory_order_relaxed);
+        jobDone_ = true;
+    }
+    sliced_ = false;
+}
+
+bool Navigation::buildSlice(void *context, std::uint64_t deadlineNS)
+{
+    Navigation &n = *static_cast<Navigation *>(context);
+    const std::uint64_t start = metrics::nowNS();
+    const bool more = n.pending_.step(n.jobBlocked_, deadlineNS);
+    n.buildNS_.fetch_add(metrics::nowNS() - start, std::memory_order_relaxed);
+    if (!more)
+    {
+        n.builds_.fetch_add(1, std::memory_order_relaxed);
+        n.jobDone_ = true;
+    }
+    return more;
+}
+
+void Navigation::setJobs(jobs::TimeSlicer *jobs)
+{
+    if (sliced_) finishSliced();
+    jobs_ = jobs;
+}
+
+void Navigation::build(FlowField &field, const std::vector<std::uint8_t> &blocked, int goal)
+{
+    const std::uint64_t start = metrics::nowNS();
+    field.build(blocked, config_.columns, config_.rows, goal);
+    buildNS_.fetch_add(metrics::nowNS() - start, std::memory_order_relaxed);
+    builds_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Navigation::restore(const std::vector<Entity> &entities, TileLayer *terrain, unsigned long long tick)
+{
+    if (!enabled()) return;
+    discardInFlight();
+    while (!history_.empty() && history_.back().tick > tick)
+        history_.pop_back();
+    pruneGrids();
+    syncObstacles(entities, terrain);
+
+    // Replay the schedule: the last request adopted by tick is current, a later one is in flight
+    const Request *adopted = nullptr;
+    const Request *pending = nullptr;
+    for (const Request &r : history_)
+    {
+        if (r.adoptTick <= tick)
+            adopted = &r;
+        else
+            pending = &r;
+    }
+    if (!adopted)
+    {
+        active_.clear();
+    }
+    else if (active_.empty() || active_.goal() != adopted->goal || activeRevision_ != adopted->revision)
+    {
+        build(active_, gridAt(adopted->revision), adopted->goal);
+        activeRevision_ = adopted->revision;
+    }
+
+    // The next refresh requests a field only if the restored obstacles differ from the last
+    // request's, as it would have without the rollback
+    requestedGoal_ = history_.empty() ? -1 : history_.back().goal;
+    requestedRevision_ = obstacleRevision_;
+    if (!history_.empty() && gridAt(history_.back().revision) != blocked_) requestedRevision_ = history_.back().revision;
+    if (pending) startJob(pending->goal, pending->revision, gridAt(pending->revision), pending->adoptTick, false);
+}
+
+void Navigation::steer(std::vector<Entity> &entities, const ecs::ArchetypeRegistry &archetypes, float goalX, float goalY)
+{
+    const std::uint64_t start = metrics::nowNS();
+    const sim::Real diagonal(0.70710678f);
+    std::uint64_t steered = 0;
+    archetypes.forEach(entities, ecs::Movable | ecs::Navigator, ecs::Controllable | ecs::Disabled, [&](Entity &e) {
+        const float cx = sim::toFloat(e.getX()) + e.getWidth() * e.getScale() * 0.5f;
+        const float cy = sim::toFloat(e.getY()) + e.getHeight() * e.getScale() * 0.5f;
+        const int cell = cellAt(cx, cy);
+        const std::uint8_t d = active_.direction(cell);
+
+        // One lookup per agent; in the goal's own cell head straight for it. Unreachable cells stop.
+        int sx = 0;
+        int sy = 0;
+        if (d != kNoDirection)
+        {
+            sx = kStepX[d];
+            sy = kStepY[d];
+        }
+        else if (cell >= 0 && cell == active_.goal())
+        {
+            sx = goalX > cx + 1.0f ? 1 : (goalX < cx - 1.0f ? -1 : 0);
+            sy = goalY > cy + 1.0f ? 1 : (goalY < cy - 1.0f ? -1 : 0);
+        }
+
+        sim::Real speed = e.getNavigationSpeed();
+        if (sx != 0 && sy != 0) speed = speed * diagonal;
+        e.setVelocityX(speed * sim::Real(sx));
+        // Walkers keep their fall; only fliers steer vertically
+        if (!e.getisAffectedByGravity()) e.setVelocityY(speed * sim::Real(sy));
+        ++steered;
+    });
+    steered_ += steered;
+    steerNS_ += metrics::nowNS() - start;
+}
+
+void Navigation::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;)
+    {
+        wake_.wait(lock, [this] { return stopping_ || jobReady_; });
+        if (stopping_) return;
+        jobReady_ = false;
+        const int goal = jobGoal_;
+        lock.unlock();
+        // The simulation thread does not touch pending_ or jobBlocked_ until jobDone_ is set
+        build(pending_, jobBlocked_, goal);
+        lock.lock();
+        jobDone_ = true;
+        done_.notify_all();
+    }
+}
+
+void Navigation::stopWorker()
+{
+    if (!worker_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    worker_.join();
+    stopping_ = false;
+    jobReady_ = false;
+    jobDone_ = true;
+    inFlight_ = false;
+}
+
+namespace {
+
+// A* with the octile heuristic on the same grid and moves as the field: what each agent would run
+// for itself without a shared field. Returns the path cost, or kUnreachable.
+std::uint32_t searchPath(const std::vector<std::uint8_t> &blocked, int columns, int rows, int from, int to, std::vector<std::uint32_t> &cost,
+                         std::vector<std::uint64_t> &open)
+{
+    const std::greater<std::uint64_t> later;
+    cost.assign(blocked.size(), FlowField::kUnreachable);
+    open.clear();
+    const int toColumn = to % columns;
+    const int toRow = to / columns;
+    auto heuristic = [&](int cell) {
+        const std::uint32_t dx = static_cast<std::uint32_t>(std::abs(cell % columns - toColumn));
+        const std::uint32_t dy = static_cast<std::uint32_t>(std::abs(cell / columns - toRow));
+        return kStraightCost * (dx + dy) + (kDiagonalCost - 2 * kStraightCost) * std::min(dx, dy);
+    };
+    cost[from] = 0;
+    open.push_back(static_cast<std::uint64_t>(heuristic(from)) << 32 | static_cast<std::uint32_t>(from));
+    while (!open.empty())
+    {
+        std::pop_heap(open.begin(), open.end(), later);
+        const int cell = static_cast<int>(open.back() & 0xffffffffu);
+        const std::uint32_t estimate = static_cast<std::uint32_t>(open.back() >> 32);
+        open.pop_back();
+        if (cell == to) return cost[cell];
+        if (estimate > cost[cell] + heuristic(cell)) continue;
+        const int column = cell % columns;
+        const int row = cell / columns;
+        for (int d = 0; d < 8; ++d)
+        {
+            if (!canStep(blocked, columns, rows, column, row, d)) continue;
+            const int next = (row + kStepY[d]) * columns + column + kStepX[d];
+            const std::uint32_t nextCost = cost[cell] + ((d & 1) ? kDiagonalCost : kStraightCost);
+            if (nextCost < cost[next])
+            {
+                cost[next] = nextCost;
+                open.push_back(static_cast<std::uint64_t>(nextCost + heuristic(next)) << 32 | static_cast<std::uint32_t>(next));
+                std::push_heap(open.begin(), open.end(), later);
+            }
+        }
+    }
+    return FlowField::kUnreachable;
+}
+
+constexpr float kArenaWidth = 1920.0f;
+constexpr float kArenaHeight = 1280.0f;
+
+// Outer walls plus staggered interior walls with gaps, so the shortest route is rarely straight
+const SDL_FRect kWalls[] = {
+    {0.0f, 0.0f, kArenaWidth, 32.0f},
+    {0.0f, kArenaHeight - 32.0f, kArenaWidth, 32.0f},
+    {0.0f, 0.0f, 32.0f, kArenaHeight},
+    {kArenaWidth - 32.0f, 0.0f, 32.0f, kArenaHeight},
+    {480.0f, 32.0f, 32.0f, 900.0f},
+    {960.0f, 350.0f, 32.0f, 898.0f},
+    {1440.0f, 32.0f, 32.0f, 900.0f},
+    {160.0f, 640.0f, 240.0f, 32.0f},
+    {1120.0f, 640.0f, 240.0f, 32.0f},
+    {640.0f, 960.0f, 240.0f, 32.0f},
+};
+
+void populateArena(World &world, int agents, bool background)
+{
+    Config config;
+    config.columns = static_cast<int>(kArenaWidth / 32.0f);
+    config.rows = static_cast<int>(kArenaHeight / 32.0f);
+    config.cellSize = 32.0f;
+    config.clearance = 6.0f;
+    config.background = background;
+    config.goalEntity = 0;
+    world.getNavigation().configure(config);
+
+    // Entity 0 is the goal: moved by the benchmark, neither movable nor solid
+    world.addEntity(Entity(std::string("Goal"), 200.0f, 200.0f, 16.0f, 16.0f, 0.0f, 0.0f, 0.0f, 0.0f, false, false, false, false, false, nullptr, 0, 0, 0,
+                           1.0f, false, nullptr));
+    for (const SDL_FRect &w : kWalls)
+        world.addEntity(Entity(std::string("Wall"), w.x, w.y, w.w, w.h, nullptr, 0, 0, 0, false, false, false, nullptr));
+
+    // Agents at fixed pseudo-random spots clear of the walls; they collide with walls, not each other
+    std::uint32_t seed = 12345u;
+    auto next = [&seed](float range) {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / 16777216.0f * range;
+    };
+    for (int placed = 0; placed < agents;)
+    {
+        const SDL_FRect box{32.0f + next(kArenaWidth - 80.0f), 32.0f + next(kArenaHeight - 80.0f), 12.0f, 12.0f};
+        bool clear = true;
+        for (const SDL_FRect &w : kWalls)
+            clear = clear && !TileLayer::overlaps(box, SDL_FRect{w.x - 8.0f, w.y - 8.0f, w.w + 16.0f, w.h + 16.0f});
+        if (!clear) continue;
+        Entity agent(std::string("Agent"), box.x, box.y, box.w, box.h, 0.0f, 0.0f, 0.0f, 0.0f, true, false, true, false, true, nullptr, 0, 0, 0, 1.0f,
+                     false, nullptr);
+        agent.setCollisionMask(collision::LayerAll & ~collision::LayerEnemy);
+        agent.setNavigationSpeed(sim::Real(90 + placed % 60));
+        world.addEntity(agent);
+        ++placed;
+    }
+}
+
+// The goal laps the arena on an ellipse, passing behind the interior walls
+void moveGoal(World &world, int tick)
+{
+    const float angle = static_cast<float>(tick) * (6.2831853f / 3600.0f);
+    Entity *goal = world.getEntity(0);
+    goal->setX(sim::Real(kArenaWidth * 0.5f + 720.0f * std::cos(angle)));
+    goal->setY(sim::Real(kArenaHeight * 0.5f + 460.0f * std::sin(angle)));
+}
+
+float averageDistance(const World &world)
+{
+    const std::vector<Entity> &entities = world.getEntities();
+    const float gx = sim::toFloat(entities[0].getX());
+    const float gy = sim::toFloat(entities[0].getY());
+    double sum = 0.0;
+    int n = 0;
+    for (const Entity &e : entities)
+    {
+        if (!e.isNavigator()) continue;
+        sum += std::hypot(sim::toFloat(e.getX()) - gx, sim::toFloat(e.getY()) - gy);
+        ++n;
+    }
+    return n > 0 ? static_cast<float>(sum / n) : 0.0f;
+}
+
+} // namespace
+
+NavigationBenchmarkResult benchmarkNavigation(int agents, int ticks)
+{
+    using Clock = std::chrono::steady_clock;
+    NavigationBenchmarkResult result{};
+    result.agents = agents;
+    result.ticks = ticks;
+
+    World world;
+    populateArena(world, agents, true);
+    const Navigation &navigation = world.getNavigation();
+    result.cells = navigation.config().columns * navigation.config().rows;
+    moveGoal(world, 0);
+    result.startDistance = averageDistance(world);
+
+    const Clock::time_point start = Clock::now();
+    for (int t = 1; t <= ticks; ++t)
+    {
+        moveGoal(world, t);
+        world.step();
+    }
+    result.tickMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / std::max(ticks, 1);
+    result.endDistance = averageDistance(world);
+    result.steerNsPerAgent = navigation.steered() > 0 ? static_cast<double>(navigation.steerNS()) / static_cast<double>(navigation.steered()) : 0.0;
+    result.fieldBuilds = navigation.builds();
+    result.fieldBuildMs = result.fieldBuilds > 0 ? static_cast<double>(navigation.buildNS()) / 1e6 / static_cast<double>(result.fieldBuilds) : 0.0;
+    result.waitMs = static_cast<double>(navigation.waitNS()) / 1e6;
+
+    // What the field saves: every agent searching for itself, once
+    const std::vector<Entity> &entities = world.getEntities();
+    const int goal = navigation.field().goal();
+    std::vector<std::uint32_t> cost;
+    std::vector<std::uint64_t> open;
+    const Clock::time_point searchStart = Clock::now();
+    for (const Entity &e : entities)
+    {
+        if (!e.isNavigator()) continue;
+        const int from = navigation.cellAt(sim::toFloat(e.getX()) + 6.0f, sim::toFloat(e.getY()) + 6.0f);
+        if (from >= 0 && goal >= 0)
+            searchPath(navigation.blocked(), navigation.config().columns, navigation.config().rows, from, goal, cost, open);
+    }
+    result.perAgentSearchMs = std::chrono::duration<double, std::milli>(Clock::now() - searchStart).count();
+
+    // The same run with every field built inline must land on exactly the same state
+    World reference;
+    populateArena(reference, agents, false);
+    for (int t = 1; t <= ticks; ++t)
+    {
+        moveGoal(reference, t);
+        reference.step();
+    }
+    auto matchesReference = [&reference](const World &w) {
+        std::vector<Entity::SimState> a;
+        std::vector<Entity::SimState> b;
+        unsigned long long tickA = 0;
+        unsigned long long tickB = 0;
+        w.saveState(a, tickA);
+        reference.saveState(b, tickB);
+        bool same = tickA == tickB && a.size() == b.size();
+        for (std::size_t i = 0; i < a.size() && same; ++i)
+            same = a[i].x == b[i].x && a[i].y == b[i].y && a[i].velocityX == b[i].velocityX && a[i].velocityY == b[i].velocityY;
+        return same;
+    };
+    result.matchesForeground = matchesReference(world);
+
+    // And with fields built as a job in small slices between ticks, as under Engine::run(), so
+    // builds span several ticks and some are finished on their adopt tick
+    World sliced;
+    populateArena(sliced, agents, true);
+    jobs::TimeSlicer slicer;
+    jobs::Config slicing;
+    slicing.budgetNS = 50000;
+    slicer.configure(slicing);
+    sliced.getNavigation().setJobs(&slicer);
+    for (int t = 1; t <= ticks; ++t)
+    {
+        moveGoal(sliced, t);
+        sliced.step();
+        slicer.run(slicing.budgetNS);
+    }
+    sliced.getNavigation().setJobs(nullptr);
+    result.matchesSliced = matchesReference(sliced);
+    return result;
+}
+
+} // namespace nav
@@ -0,0 +1,224 @@
+// Flow-field navigation: one shared field toward a goal, steered by table lookup
+#ifndef NAVIGATION_H
+#define NAVIGATION_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "entity.h"
+#include "jobs.h"
+
+class TileLayer;
+
+namespace nav {
+
+struct Config
+{
+    float originX = 0.0f; // top-left of the grid in world space
+    float originY = 0.0f;
+    int columns = 0;      // 0 turns navigation off
+    int rows = 0;
+    float cellSize = 32.0f;
+    float clearance = 0.0f;   // obstacles grow by this much on every side (about half an agent)
+    int refreshInterval = 10; // ticks between field requests; a field is adopted this many ticks later
+    bool background = true;   // build fields on a worker thread; results are the same either way
+    int goalEntity = -1;      // entity to chase; -1 follows the controlled entity
+};
+
+// Eight compass directions (east first, clockwise with +y down), then none
+constexpr std::uint8_t kNoDirection = 8;
+
+// Costs and a direction for every cell, toward one goal cell. Straight steps cost 10 and diagonal
+// ones 14; diagonals never cut past a blocked corner. Blocked cells point to their cheapest open
+// neighbour so an agent pushed into one can get out.
+class FlowField
+{
+public:
+    static constexpr std::uint32_t kUnreachable = 0xffffffffu;
+
+    void build(const std::vector<std::uint8_t> &blocked, int columns, int rows, int goal);
+    // The same build in pieces: start(), then step() until it returns false, with the same
+    // blocked grid each time. A step runs until deadlineNS (metrics::nowNS clock), checking the
+    // clock every few dozen cells, and always makes some progress. The result does not depend on
+    // how the work was split.
+    void start(int columns, int rows, int goal);
+    bool step(const std::vector<std::uint8_t> &blocked, std::uint64_t deadlineNS);
+    void clear();
+
+    bool empty() const { return direction_.empty(); }
+    int goal() const { return goal_; }
+    std::uint8_t direction(int cell) const
+    {
+        return cell >= 0 && static_cast<std::size_t>(cell) < direction_.size() ? direction_[cell] : kNoDirection;
+    }
+    std::uint32_t cost(int cell) const
+    {
+        return cell >= 0 && static_cast<std::size_t>(cell) < cost_.size() ? cost_[cell] : kUnreachable;
+    }
+
+private:
+    std::vector<std::uint32_t> cost_;
+    std::vector<std::uint8_t> direction_;
+    std::vector<std::uint64_t> open_; // heap of cost << 32 | cell, kept between builds
+    int columns_ = 0;
+    int rows_ = 0;
+    int nextRow_ = 0; // direction pass progress, once the search is done
+    int goal_ = -1;
+};
+
+// Navigation for one world. Static collidable entities and solid terrain are rasterised into a
+// blocked-cell grid, restamping only what moved; a new field is requested only when the goal
+// changes cell or the obstacles change. Fields are built on a worker thread, or in slices of the
+// engine's spare time between ticks, and adopted exactly refreshInterval ticks after their request
+// (finishing the build first if it is late), so lock-step peers and rollback re-simulation see the
+// same field on the same tick whatever the timing.
+class Navigation
+{
+public:
+    Navigation() = default;
+    ~Navigation();
+    Navigation(const Navigation &) = delete;
+    Navigation &operator=(const Navigation &) = delete;
+
+    // Replace the grid; drops every field and obstacle
+    void configure(const Config &config);
+    const Config &config() const { return config_; }
+    bool enabled() const { return config_.columns > 0 && config_.rows > 0; }
+    // Build background fields as a job on jobs (run on the simulation thread) instead of on the
+    // worker; nullptr goes back to the worker. A build in flight is finished first.
+    void setJobs(jobs::TimeSlicer *jobs);
+
+    // Once per tick on the simulation thread: adopt the field that is due, request a new one on
+    // refresh ticks, then point every Navigator along it. controlled is the player's entity index.
+    void update(std::vector<Entity> &entities, const ecs::ArchetypeRegistry &archetypes, TileLayer *terrain, int controlled,
+                unsigned long long tick);
+    // After a state restore: restamp obstacles from the restored entities, then rebuild whichever
+    // fields were current or in flight at tick from the obstacles they were requested against
+    void restore(const std::vector<Entity> &entities, TileLayer *terrain, unsigned long long tick);
+    // Drop obstacles, fields and request history (entity list rebuilt)
+    void clear();
+
+    int cellAt(float x, float y) const; // -1 outside the grid
+    bool isBlocked(int cell) const;
+    const std::vector<std::uint8_t> &blocked() const { return blocked_; }
+    const FlowField &field() const { return active_; }
+
+    std::uint64_t builds() const { return builds_.load(std::memory_order_relaxed); }
+    std::uint64_t buildNS() const { return buildNS_.load(std::memory_order_relaxed); } // spent building, on any thread
+    std::uint64_t waitNS() const { return waitNS_; } // simulation thread time spent waiting on the worker
+    std::uint64_t steered() const { return steered_; } // agent updates so far
+    std::uint64_t steerNS() const { return steerNS_; }
+
+private:
+    struct Stamp
+    {
+        int column0, row0, column1, row1; // inclusive; column1 < column0 when empty
+        bool operator!=(const Stamp &o) const { return column0 != o.column0 || row0 != o.row0 || column1 != o.column1 || row1 != o.row1; }
+    };
+
+    // A field request: goal cell at tick against obstacle revision, adopted at adoptTick
+    struct Request
+    {
+        unsigned long long tick;
+        unsigned long long adoptTick;
+        int goal;
+        std::uint64_t revision;
+    };
+
+    // Blocked cells as they were at one obstacle revision, kept while a request refers to it
+    struct Grid
+    {
+        std::uint64_t revision;
+        std::vector<std::uint8_t> blocked;
+    };
+
+    Stamp cover(float x, float y, float w, float h) const;
+    void stamp(const Stamp &s, int delta);
+    void syncObstacles(const std::vector<Entity> &entities, TileLayer *terrain);
+    int goalCell(const std::vector<Entity> &entities, int controlled, float &goalX, float &goalY) const;
+    void issue(int goal, unsigned long long tick, unsigned long long adoptTick);
+    const std::vector<std::uint8_t> &gridAt(std::uint64_t revision) const;
+    void pruneGrids();
+    void startJob(int goal, std::uint64_t revision, const std::vector<std::uint8_t> &blocked, unsigned long long adoptTick, bool inlineBuild);
+    void collect();
+    void discardInFlight();
+    void finishSliced();
+    static bool buildSlice(void *context, std::uint64_t deadlineNS);
+    void build(FlowField &field, const std::vector<std::uint8_t> &blocked, int goal);
+    void steer(std::vector<Entity> &entities, const ecs::ArchetypeRegistry &archetypes, float goalX, float goalY);
+    void workerLoop();
+    void stopWorker();
+
+    Config config_;
+
+    // Obstacles: blockers per cell from entities, and from terrain (restamped when it changes)
+    std::vector<std::uint16_t> entityBlockers_;
+    std::vector<std::uint8_t> terrainBlocked_;
+    std::vector<std::uint8_t> blocked_;
+    std::vector<Stamp> stamps_; // by entity index
+    const TileLayer *terrain_ = nullptr;
+    std::uint64_t terrainRevision_ = 0;
+    std::uint64_t obstacleRevision_ = 0;
+    std::uint64_t requestedRevision_ = 0;
+    int requestedGoal_ = -1;
+
+    FlowField active_;
+    FlowField pending_;
+    std::uint64_t activeRevision_ = 0; // obstacle revision each field was built against
+    std::uint64_t pendingRevision_ = 0;
+    std::vector<Request> history_; // recent requests, oldest first
+    std::vector<Grid> grids_;      // by revision, oldest first
+    std::vector<Grid> spareGrids_; // dropped grids, reused so steady state does not allocate
+    bool inFlight_ = false;
+    unsigned long long adoptTick_ = 0;
+
+    // Worker: one job at a time, handed over under the mutex
+    std::thread worker_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::vector<std::uint8_t> jobBlocked_;
+    int jobGoal_ = -1;
+    bool jobReady_ = false;
+    bool jobDone_ = true;
+    bool stopping_ = false;
+
+    // Or a job on the time slicer, building pending_ from jobBlocked_ a slice at a time
+    jobs::TimeSlicer *jobs_ = nullptr;
+    std::uint32_t jobId_ = 0;
+    bool sliced_ = false; // the build in flight is that job
+
+    std::atomic<std::uint64_t> builds_{0};
+    std::atomic<std::uint64_t> buildNS_{0};
+    std::uint64_t waitNS_ = 0;
+    std::uint64_t steered_ = 0;
+    std::uint64_t steerNS_ = 0;
+};
+
+struct NavigationBenchmarkResult
+{
+    int agents;
+    int ticks;
+    int cells;
+    double tickMs;          // whole world step per tick
+    double steerNsPerAgent; // flow lookup and velocity write
+    std::uint64_t fieldBuilds;
+    double fieldBuildMs;    // per build, on the worker
+    double waitMs;          // total time the simulation thread waited for the worker
+    double perAgentSearchMs; // one A* search for every agent, the cost the shared field replaces
+    float startDistance;    // average agent distance to the goal at the start
+    float endDistance;      // and at the end
+    bool matchesForeground; // background builds gave the same final state as inline ones
+    bool matchesSliced;     // and so did builds sliced through a jobs::TimeSlicer
+};
+
+// A walled arena with a goal circling it, chased by the given number of agents for ticks ticks
+NavigationBenchmarkResult benchmarkNavigation(int agents, int ticks);
+
+} // namespace nav
+
+#endif
@@ -0,0 +1,169 @@
+// Lock-step message encoding
+#include "netcode.h"
+
+#include <type_traits>
+
+namespace net {
+
+namespace {
+
+void put8(std::vector<std::uint8_t> &out, std::uint8_t v) { out.push_back(v); }
+
+void put16(std::vector<std::uint8_t> &out, std::uint16_t v)
+{
+    out.push_back(static_cast<std::uint8_t>(v));
+    out.push_back(static_cast<std::uint8_t>(v >> 8));
+}
+
+void put32(std::vector<std::uint8_t> &out, std::uint32_t v)
+{
+    for (int i = 0; i < 4; ++i)
+        out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+}
+
+void put64(std::vector<std::uint8_t> &out, std::uint64_t v)
+{
+    for (int i = 0; i < 8; ++i)
+        out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+}
+
+// Simulation values travel as their bit patterns so the receiver gets exactly what the sender had
+constexpr int kRealSize = static_cast<int>(sizeof(sim::Real));
+static_assert(kRealSize == 4 || kRealSize == 8, "sim::Real must be 32 or 64 bits wide");
+using RealBits = std::conditional<kRealSize == 4, std::uint32_t, std::uint64_t>::type;
+
+void putReal(std::vector<std::uint8_t> &out, sim::Real v)
+{
+    RealBits bits;
+    std::memcpy(&bits, &v, sizeof(v));
+    for (int i = 0; i < kRealSize; ++i)
+        out.push_back(static_cast<std::uint8_t>(bits >> (8 * i)));
+}
+
+struct Reader
+{
+    const std::vector<std::uint8_t> &bytes;
+    std::size_t pos;
+
+    bool has(std::size_t n) const { return pos + n <= bytes.size(); }
+
+    std::uint64_t read(int n)
+    {
+        std::uint64_t v = 0;
+        for (int i = 0; i < n; ++i)
+            v |= static_cast<std::uint64_t>(bytes[pos + i]) << (8 * i);
+        pos += n;
+        return v;
+    }
+
+    sim::Real readReal()
+    {
+        const RealBits bits = static_cast<RealBits>(read(kRealSize));
+        sim::Real v;
+        std::memcpy(static_cast<void *>(&v), &bits, sizeof(v)); // trivially copyable
+        return v;
+    }
+};
+
+constexpr std::size_t kInputSize = 1 + 4 + 2 + 1;
+constexpr std::size_t kDeltaHeader = 1 + 4 + 4 + 8 + 4;
+constexpr std::size_t kStateSize = 4 + 4 * kRealSize;
+
+} // namespace
+
+EntityState captureState(std::uint32_t index, const Entity &e)
+{
+    EntityState s;
+    s.entity = index;
+    s.x = e.getX();
+    s.y = e.getY();
+    s.vx = e.getVelocityX();
+    s.vy = e.getVelocityY();
+    return s;
+}
+
+std::uint64_t checksum(const std::vector<EntityState> &states)
+{
+    std::uint64_t h = 1469598103934665603ULL;
+    for (const EntityState &s : states)
+    {
+        const sim::Real fields[] = {s.x, s.y, s.vx, s.vy};
+        std::uint8_t bytes[sizeof(std::uint32_t) + sizeof(fields)];
+        std::memcpy(bytes, &s.entity, sizeof(std::uint32_t));
+        std::memcpy(bytes + sizeof(std::uint32_t), fields, sizeof(fields));
+        for (std::uint8_t b : bytes)
+        {
+            h ^= b;
+            h *= 1099511628211ULL;
+        }
+    }
+    return h;
+}
+
+void encode(const InputFrame &in, std::vector<std::uint8_t> &out)
+{
+    out.clear();
+    put8(out, static_cast<std::uint8_t>(MessageType::Input));
+    put32(out, in.tick);
+    put16(out, in.player);
+    put8(out, in.buttons);
+}
+
+void encode(const StateDelta &delta, std::vector<std::uint8_t> &out)
+{
+    out.clear();
+    out.reserve(kDeltaHeader + delta.changes.size() * kStateSize);
+    put8(out, static_cast<std::uint8_t>(MessageType::StateDelta));
+    put32(out, delta.tick);
+    put32(out, delta.entityCount);
+    put64(out, delta.checksum);
+    put32(out, static_cast<std::uint32_t>(delta.changes.size()));
+    for (const EntityState &s : delta.changes)
+    {
+        put32(out, s.entity);
+        putReal(out, s.x);
+        putReal(out, s.y);
+        putReal(out, s.vx);
+        putReal(out, s.vy);
+    }
+}
+
+bool peekType(const std::vector<std::uint8_t> &bytes, MessageType &type)
+{
+    if (bytes.empty()) return false;
+    type = static_cast<MessageType>(bytes[0]);
+    return true;
+}
+
+bool decode(const std::vector<std::uint8_t> &bytes, InputFrame &out)
+{
+    if (bytes.size() != kInputSize || bytes[0] != static_cast<std::uint8_t>(MessageType::Input)) return false;
+    Reader r{bytes, 1};
+    out.tick = static_cast<std::uint32_t>(r.read(4));
+    out.player = static_cast<std::uint16_t>(r.read(2));
+    out.buttons = static_cast<std::uint8_t>(r.read(1));
+    return true;
+}
+
+bool decode(const std::vector<std::uint8_t> &bytes, StateDelta &out)
+{
+    if (bytes.size() < kDeltaHeader || bytes[0] != static_cast<std::uint8_t>(MessageType::StateDelta)) return false;
+    Reader r{bytes, 1};
+    out.tick = static_cast<std::uint32_t>(r.read(4));
+    out.entityCount = static_cast<std::uint32_t>(r.read(4));
+    out.checksum = r.read(8);
+    const std::uint32_t count = static_cast<std::uint32_t>(r.read(4));
+    if (!r.has(static_cast<std::size_t>(count) * kStateSize)) return false;
+    out.changes.resize(count);
+    for (EntityState &s : out.changes)
+    {
+        s.entity = static_cast<std::uint32_t>(r.read(4));
+        s.x = r.readReal();
+        s.y = r.readReal();
+        s.vx = r.readReal();
+        s.vy = r.readReal();
+    }
+    return true;
+}
+
+} // namespace net
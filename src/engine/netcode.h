@@ -0,0 +1,72 @@
+// Wire messages for lock-step multiplayer: per-player input frames and state deltas
+#ifndef NETCODE_H
+#define NETCODE_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "entity.h"
+
+namespace net {
+
+enum class MessageType : std::uint8_t
+{
+    Input = 1,
+    StateDelta = 2,
+};
+
+// One player's held buttons (input_handler::Button bits) for one simulation tick
+struct InputFrame
+{
+    std::uint32_t tick;
+    std::uint16_t player;
+    std::uint8_t buttons;
+};
+
+// Replicated kinematic state of one entity, in the simulation's own numeric type
+struct EntityState
+{
+    std::uint32_t entity;
+    sim::Real x;
+    sim::Real y;
+    sim::Real vx;
+    sim::Real vy;
+};
+
+// Entities whose state changed during a tick, plus a checksum of the whole world for desync checks
+struct StateDelta
+{
+    std::uint32_t tick = 0;
+    std::uint32_t entityCount = 0;
+    std::uint64_t checksum = 0;
+    std::vector<EntityState> changes;
+};
+
+EntityState captureState(std::uint32_t index, const Entity &e);
+
+// Bit-exact comparison; lock-step state must match to the last bit, not within an epsilon.
+// Field by field, since padding differs between scalar types.
+inline bool sameBits(const sim::Real &a, const sim::Real &b)
+{
+    return std::memcmp(&a, &b, sizeof(sim::Real)) == 0;
+}
+
+inline bool sameState(const EntityState &a, const EntityState &b)
+{
+    return a.entity == b.entity && sameBits(a.x, b.x) && sameBits(a.y, b.y) && sameBits(a.vx, b.vx) && sameBits(a.vy, b.vy);
+}
+
+// FNV-1a over every entity's replicated state
+std::uint64_t checksum(const std::vector<EntityState> &states);
+
+// Little-endian encoding; decode functions return false on malformed input
+void encode(const InputFrame &in, std::vector<std::uint8_t> &out);
+void encode(const StateDelta &delta, std::vector<std::uint8_t> &out);
+bool peekType(const std::vector<std::uint8_t> &bytes, MessageType &type);
+bool decode(const std::vector<std::uint8_t> &bytes, InputFrame &out);
+bool decode(const std::vector<std::uint8_t> &bytes, StateDelta &out);
+
+} // namespace net
+
+#endif
@@ -0,0 +1,154 @@
+// Pooled particle effects: dust, sparks, explosions
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include <SDL3/SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "entity.h"
+#include "render_snapshot.h"
+
+namespace fx {
+
+// How an emitter spawns particles. Angles are in radians with +y pointing down the screen, so
+// the default direction (-pi/2) is straight up.
+struct EmitterConfig
+{
+    float rate = 0.0f;        // particles per second while active
+    float offsetX = 0.0f;     // spawn point relative to the entity's top-left
+    float offsetY = 0.0f;
+    float direction = -1.5707964f;
+    float spread = 3.1415927f; // full width of the launch cone
+    float speedMin = 50.0f;    // px/s
+    float speedMax = 150.0f;
+    float lifeMin = 0.5f;      // seconds
+    float lifeMax = 1.0f;
+    float size = 2.0f;         // px, square
+    float gravityScale = 1.0f; // multiplies the world's gravity; 0 for floating dust
+    SDL_Color color{255, 255, 255, 255};
+};
+
+using EmitterId = int;
+
+// Fixed-capacity pool of particles stored as parallel arrays, stepped by a vector kernel.
+// Particles are cosmetic: they are not part of the entity state saved for rollback or replays,
+// and spawns beyond the capacity are dropped rather than growing the pool mid-tick.
+class ParticleSystem
+{
+public:
+    explicit ParticleSystem(std::size_t capacity = 0);
+    ParticleSystem(const ParticleSystem &) = delete;
+    ParticleSystem &operator=(const ParticleSystem &) = delete;
+
+    // Reallocate the pool (drops every live particle); rounded up to the kernel's lane count
+    void setCapacity(std::size_t capacity);
+    std::size_t capacity() const { return capacity_; }
+    std::size_t size() const { return count_; }
+    std::uint64_t dropped() const { return dropped_; }
+
+    // Emitters follow an entity by index and stop while it is disabled
+    EmitterId addEmitter(std::uint32_t entity, const EmitterConfig &config);
+    void removeEmitter(EmitterId id);
+    void setEmitterActive(EmitterId id, bool active);
+    // Queue a one-shot burst from an attached emitter; spawned on the next update
+    void burst(EmitterId id, int count);
+    // Spawn count particles at a point right away (explosions, impacts)
+    void burstAt(const EmitterConfig &config, float x, float y, int count);
+
+    // Age and move every particle, retire the expired ones, then run the emitters
+    void update(const std::vector<Entity> &entities, float dt, float gravity);
+    // Remove all particles and emitters
+    void clear();
+
+    // Live particles occupy [0, size()) of each array
+    const float *x() const { return x_; }
+    const float *y() const { return y_; }
+    const float *prevX() const { return prevX_; }
+    const float *prevY() const { return prevY_; }
+    const float *sizes() const { return sizes_; }
+    const std::uint32_t *colors() const { return colors_; }
+
+    // Append the live particles to a render snapshot, alpha already faded by age
+    void capture(std::vector<render::Particle> &out) const;
+
+private:
+    struct Emitter
+    {
+        std::uint32_t entity;
+        EmitterConfig config;
+        float accumulator; // fractional particles carried to the next tick
+        int pending;       // queued burst
+        bool active;
+        bool used;
+    };
+
+    struct FreeBlock
+    {
+        void operator()(unsigned char *p) const;
+    };
+
+    void spawn(const EmitterConfig &config, float x, float y);
+    float random01();
+    void retire(std::size_t i);
+
+    std::unique_ptr<unsigned char[], FreeBlock> block_; // every channel below, one aligned allocation
+    float *x_ = nullptr;
+    float *y_ = nullptr;
+    float *prevX_ = nullptr;
+    float *prevY_ = nullptr;
+    float *velocityX_ = nullptr;
+    float *velocityY_ = nullptr;
+    float *life_ = nullptr;         // seconds left
+    float *fade_ = nullptr;         // 1 / starting life
+    float *gravityScale_ = nullptr;
+    float *sizes_ = nullptr;
+    std::uint32_t *colors_ = nullptr; // RGBA bytes in SDL_Color order
+    std::size_t capacity_ = 0;
+    std::size_t count_ = 0;
+    std::uint64_t dropped_ = 0;
+    std::uint32_t rng_ = 0x2545f491u;
+    std::vector<Emitter> emitters_;
+};
+
+// Expands snapshot particles into coloured quads and submits them through SDL_RenderGeometry in
+// fixed-size batches, reusing one vertex and one index buffer (render thread)
+class ParticleRenderer
+{
+public:
+    static constexpr std::size_t kBatch = 8192; // quads per geometry call
+
+    ParticleRenderer();
+
+    // Draw every particle blended alpha of the way from its previous position to its current one;
+    // returns the number of geometry calls
+    std::size_t draw(SDL_Renderer *renderer, const std::vector<render::Particle> &particles, float alpha);
+    // Fill the vertex buffer with up to kBatch quads; returns how many were written
+    std::size_t build(const render::Particle *first, std::size_t count, float alpha);
+
+private:
+    std::vector<SDL_Vertex> vertices_;
+    std::vector<int> indices_;
+};
+
+// Name of the update kernel compiled in: "AVX", "SSE2" or "scalar"
+const char *kernelName();
+
+struct ParticleBenchmarkResult
+{
+    std::size_t live;      // average live particles per tick
+    int ticks;
+    double updateMs;       // per tick: integrate, retire, emit
+    double captureMs;      // per tick: copy into a render snapshot
+    double buildMs;        // per tick: expand into quads for SDL_RenderGeometry
+    std::uint64_t dropped;
+};
+
+// Hold about count live particles with one emitter and time each stage of a 60 Hz tick
+ParticleBenchmarkResult benchmarkParticles(std::size_t count, int ticks);
+
+} // namespace fx
+
+#endif
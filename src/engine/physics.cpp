@@ -1,43 +1,64 @@
 #include "physics.h"
 
 // Defaults tuned for pixel units: ~2000 px/s^2 feels platformer-like
-float Physics::gravity = 2000.0f;
-float Physics::deltaTime = 1.0f / 60.0f;
+template <typename Real>
+BasicPhysics<Real>::BasicPhysics() : gravity_(Real(2000)), deltaTime_(Real(1) / Real(60)) {}
+
+template <typename Real>
+std::pair<typename BasicPhysics<Real>::Vector, typename BasicPhysics<Real>::Vector> BasicPhysics<Real>::applyPhysics(Entity& e) const {
+    return applyPhysics(e, deltaTime_);
+}
+
+template <typename Real>
+std::pair<typename BasicPhysics<Real>::Vector, typename BasicPhysics<Real>::Vector> BasicPhysics<Real>::applyPhysics(Entity& e, Real dt) const {
+    // Static entities stay where they are
+    if (!e.isMovable()) return {{Real(e.getX()), Real(e.getY())}, {Real(e.getVelocityX()), Real(e.getVelocityY())}};
 
-std::pair<std::pair<float,float>, std::pair<float,float>> Physics::applyPhysics(Entity& e) {
     // Read current state
-    float x = e.getX();
-    float y = e.getY();
-    float vx = e.getVelocityX();
-    float vy = e.getVelocityY();
-    float ax = e.getAccelerationX();
-    float ay = e.getAccelerationY();
-    if (!e.isMovable()) return {{x, y}, {vx, vy}};
+    return integrate({Real(e.getX()), Real(e.getY())},
+                     {Real(e.getVelocityX()), Real(e.getVelocityY())},
+                     {Real(e.getAccelerationX()), Real(e.getAccelerationY())},
+                     e.getisAffectedByGravity(), dt);
+}
+
+template <typename Real>
+std::pair<typename BasicPhysics<Real>::Vector, typename BasicPhysics<Real>::Vector> BasicPhysics<Real>::integrate(
+    Vector position, Vector velocity, Vector acceleration, bool affectedByGravity, Real dt) const {
+    Real vx = velocity.first;
+    Real vy = velocity.second;
+    Real ax = acceleration.first;
+    Real ay = acceleration.second;
 
     // Apply gravity if the entity is affected by it
-    if (e.getisAffectedByGravity()) {
-        ay += gravity;
+    if (affectedByGravity) {
+        ay += gravity_;
     }
 
     // Semi-implicit Euler integration using the entity's own acceleration
-    vx += ax * deltaTime;
-    vy += ay * deltaTime;
+    vx += ax * dt;
+    vy += ay * dt;
 
-    float targetX = x + vx * deltaTime;
-    float targetY = y + vy * deltaTime;
+    Real targetX = position.first + vx * dt;
+    Real targetY = position.second + vy * dt;
 
     return {{targetX, targetY}, {vx, vy}};
 }
 
-void Physics::setGravity(float g) { 
-    gravity = g; 
+template <typename Real>
+void BasicPhysics<Real>::setGravity(Real g) { 
+    gravity_ = g; 
 }
-float Physics::getGravity() { 
-    return gravity; 
+template <typename Real>
+Real BasicPhysics<Real>::getGravity() const { 
+    return gravity_; 
 }
-void Physics::setDeltaTime(float dt) { 
-    deltaTime = dt; 
+template <typename Real>
+void BasicPhysics<Real>::setDeltaTime(Real dt) { 
+    deltaTime_ = dt; 
 }
-float Physics::getDeltaTime() { 
-    return deltaTime; 
+template <typename Real>
+Real BasicPhysics<Real>::getDeltaTime() const { 
+    return deltaTime_; 
 }
+
+template class BasicPhysics<sim::Real>;
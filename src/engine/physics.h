@@ -3,18 +3,33 @@
 
 #include "entity.h"
 
-class Physics {
+// Integration is templated on the numeric type so fixed-point and floating-point builds share one kernel.
+// Each world owns its own instance, so gravity and timestep can differ between worlds.
+template <typename Real>
+class BasicPhysics {
 private:
-    static float gravity;    // pixels per second^2
-    static float deltaTime;  // seconds per frame (~1/60)
+    Real gravity_;    // pixels per second^2
+    Real deltaTime_;  // seconds per frame (~1/60)
 public:
-    static std::pair<std::pair<float,float>, std::pair<float,float>> applyPhysics(Entity& entity);
+    using Vector = std::pair<Real, Real>;
+
+    BasicPhysics();
+
+    std::pair<Vector, Vector> applyPhysics(Entity& entity) const;
+    // Same integration with an explicit timestep (entities stepped at a reduced rate)
+    std::pair<Vector, Vector> applyPhysics(Entity& entity, Real dt) const;
+    // Semi-implicit Euler on plain values; returns {target position, new velocity}
+    std::pair<Vector, Vector> integrate(Vector position, Vector velocity, Vector acceleration, bool affectedByGravity, Real dt) const;
 
     // Setters and getters for tuning
-    static void setGravity(float g);
-    static float getGravity();
-    static void setDeltaTime(float dt);
-    static float getDeltaTime();
+    void setGravity(Real g);
+    Real getGravity() const;
+    void setDeltaTime(Real dt);
+    Real getDeltaTime() const;
 };
 
-#endif 
\ No newline at end of file
+// The engine's physics runs in the configured simulation type
+using Physics = BasicPhysics<sim::Real>;
+extern template class BasicPhysics<sim::Real>;
+
+#endif 
@@ -0,0 +1,30 @@
+// Triple-buffered snapshot exchange between simulation and rendering
+#include "render_snapshot.h"
+
+namespace render {
+
+void SnapshotBuffer::publish()
+{
+    // Hand our slot over as the latest and take back whichever slot it replaced
+    write_ = latest_.exchange(write_ | kFresh, std::memory_order_acq_rel) & kIndexMask;
+}
+
+bool SnapshotBuffer::acquire()
+{
+    if ((latest_.load(std::memory_order_acquire) & kFresh) == 0)
+        return false;
+
+    read_ = latest_.exchange(read_, std::memory_order_acq_rel) & kIndexMask;
+    return true;
+}
+
+void SnapshotBuffer::reset()
+{
+    for (Snapshot &s : slots_)
+        s = Snapshot{};
+    latest_.store(1, std::memory_order_relaxed);
+    write_ = 0;
+    read_ = 2;
+}
+
+} // namespace render
@@ -0,0 +1,76 @@
+// Immutable render snapshots handed from the simulation thread to the render thread
+#ifndef RENDER_SNAPSHOT_H
+#define RENDER_SNAPSHOT_H
+
+#include <SDL3/SDL.h>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace render {
+
+// Everything needed to draw one entity, captured at the end of a simulation tick
+struct Sprite
+{
+    std::uint32_t id; // index of the entity in the engine's list
+    SDL_Texture *texture;
+    SDL_FRect src;
+    SDL_FRect prevDst; // placement before the entity's last step
+    SDL_FRect dst;     // placement after it
+    unsigned long long stateTick; // tick the entity last stepped on
+    int span;                     // ticks covered by that step
+};
+
+// One particle as a point before and after the tick; drawn as an untextured square
+struct Particle
+{
+    float prevX, prevY;
+    float x, y;
+    float size;
+    std::uint32_t color; // RGBA bytes in SDL_Color order, alpha already faded by age
+};
+
+struct Snapshot
+{
+    std::vector<Sprite> sprites;
+    std::vector<Particle> particles;
+    unsigned long long tick = 0;
+    Uint64 timeNS = 0; // when the tick finished
+    bool paused = false;
+};
+
+// Lock-free triple buffer: the writer always has a free slot, the reader always sees the newest
+// complete snapshot, and neither side waits for the other.
+class SnapshotBuffer
+{
+public:
+    // Simulation thread: fill the returned slot, then publish it
+    Snapshot &beginWrite() { return slots_[write_]; }
+    void publish();
+
+    // Render thread: swap in the newest snapshot if one was published since the last call
+    bool acquire();
+    const Snapshot &current() const { return slots_[read_]; }
+
+    // Drop any published state (only while no thread is running)
+    void reset();
+
+private:
+    static constexpr unsigned kIndexMask = 0x3u;
+    static constexpr unsigned kFresh = 0x4u;
+
+    Snapshot slots_[3];
+    std::atomic<unsigned> latest_{1};
+    unsigned write_ = 0;
+    unsigned read_ = 2;
+};
+
+// Blend two rects; used to interpolate sprite positions between ticks
+inline SDL_FRect lerp(const SDL_FRect &a, const SDL_FRect &b, float t)
+{
+    return SDL_FRect{a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.w + (b.w - a.w) * t, a.h + (b.h - a.h) * t};
+}
+
+} // namespace render
+
+#endif
@@ -0,0 +1,241 @@
+// Rollback session implementation
+#include "rollback.h"
+
+#include <algorithm>
+
+#include "golden.h"
+#include "world.h"
+#include "../input_handler.h"
+
+namespace net {
+
+std::vector<std::uint32_t> addAvatars(World &world, const Entity &avatar, int players)
+{
+    const float stepX = avatar.getWidth() * avatar.getScale() + 8.0f;
+    const float stepY = avatar.getHeight() * avatar.getScale() + 8.0f;
+    std::vector<std::uint32_t> entities;
+    for (int i = 0; i < players; ++i)
+    {
+        Entity a = avatar;
+        a.setX(avatar.getX() + static_cast<float>(i % 12) * stepX);
+        a.setY(avatar.getY() - static_cast<float>(i / 12) * stepY);
+        world.addEntity(a);
+        entities.push_back(static_cast<std::uint32_t>(world.getEntities().size() - 1));
+    }
+    return entities;
+}
+
+std::uint8_t scriptedButtons(int player, std::uint32_t tick)
+{
+    std::uint32_t h = (tick / 2u) * 2654435761u ^ static_cast<std::uint32_t>(player + 1) * 40503u;
+    h ^= h >> 15;
+    h *= 2246822519u;
+    h ^= h >> 13;
+    const std::uint8_t mask = input_handler::ButtonLeft | input_handler::ButtonRight | input_handler::ButtonJump;
+    return static_cast<std::uint8_t>((h >> 8) & mask);
+}
+
+RollbackSession::RollbackSession(World &world, const std::vector<std::uint32_t> &players, int historyFrames, int maxPrediction)
+    : world_(world)
+{
+    const int frames = historyFrames > 2 ? historyFrames : 2;
+    maxPrediction_ = SDL_clamp(maxPrediction, 0, frames - 1);
+
+    history_.resize(frames);
+    for (Frame &f : history_)
+        f.used.assign(players.size(), 0);
+
+    for (std::uint32_t entity : players)
+    {
+        PlayerInput p;
+        p.entity = entity;
+        p.buttons.assign(frames, 0);
+        p.tickOf.assign(frames, 0);
+        players_.push_back(p);
+    }
+}
+
+std::uint32_t RollbackSession::getConfirmedTick() const
+{
+    std::uint32_t confirmed = tick_ + static_cast<std::uint32_t>(history_.size());
+    for (const PlayerInput &p : players_)
+        confirmed = p.lastConfirmed < confirmed ? p.lastConfirmed : confirmed;
+    return players_.empty() ? tick_ : confirmed;
+}
+
+bool RollbackSession::addInput(int player, std::uint32_t tick, std::uint8_t buttons)
+{
+    if (player < 0 || player >= static_cast<int>(players_.size()) || tick == 0) return false;
+    const std::uint32_t n = static_cast<std::uint32_t>(history_.size());
+    // Too far ahead would overwrite ring slots still needed; too old has no saved state to rewind to
+    if (tick >= tick_ + n) return false;
+    if (tick <= tick_ && history_[tick % n].tick != tick) return false;
+
+    PlayerInput &p = players_[player];
+    p.buttons[tick % n] = buttons;
+    p.tickOf[tick % n] = tick;
+    if (tick > p.lastConfirmed) p.lastConfirmed = tick;
+
+    // Already simulated with a guess: rewind if the guess was wrong
+    if (tick <= tick_ && history_[tick % n].used[player] != buttons)
+    {
+        if (rollbackFrom_ == 0 || tick < rollbackFrom_)
+            rollbackFrom_ = tick;
+    }
+    return true;
+}
+
+std::uint8_t RollbackSession::inputFor(const PlayerInput &p, std::uint32_t tick) const
+{
+    const std::uint32_t n = static_cast<std::uint32_t>(history_.size());
+    if (p.tickOf[tick % n] == tick) return p.buttons[tick % n];
+
+    // Predict: the player keeps holding whatever they last confirmed
+    const std::uint32_t last = p.lastConfirmed;
+    if (last != 0 && p.tickOf[last % n] == last) return p.buttons[last % n];
+    return 0;
+}
+
+void RollbackSession::simulate(std::uint32_t tick)
+{
+    const std::uint32_t n = static_cast<std::uint32_t>(history_.size());
+    Frame &f = history_[tick % n];
+    const Frame &before = history_[(tick - 1) % n];
+    const bool haveBefore = tick > 1 && before.tick == tick - 1;
+
+    f.tick = tick;
+    world_.saveState(f.state, f.engineTick);
+
+    for (std::size_t i = 0; i < players_.size(); ++i)
+    {
+        const std::uint8_t held = inputFor(players_[i], tick);
+        const std::uint8_t previous = haveBefore ? before.used[i] : 0;
+        world_.getControls().applyButtons(world_.getEntity(players_[i].entity), held, static_cast<std::uint8_t>(held & ~previous));
+        f.used[i] = held;
+    }
+
+    world_.step();
+}
+
+bool RollbackSession::advance()
+{
+    if (tick_ + 1 > getConfirmedTick() + static_cast<std::uint32_t>(maxPrediction_)) return false;
+    simulate(tick_ + 1);
+    ++tick_;
+    return true;
+}
+
+int RollbackSession::reconcile()
+{
+    if (rollbackFrom_ == 0) return 0;
+    const std::uint32_t from = rollbackFrom_;
+    rollbackFrom_ = 0;
+
+    const Frame &start = history_[from % history_.size()];
+    if (start.tick != from) return 0;
+    world_.loadState(start.state, start.engineTick);
+
+    int count = 0;
+    for (std::uint32_t t = from; t <= tick_; ++t)
+    {
+        simulate(t);
+        ++count;
+    }
+    resimulated_ += static_cast<std::uint64_t>(count);
+    return count;
+}
+
+RollbackBenchmarkResult benchmarkRollback(World &world, const Entity &avatar, int players, int renderFrames)
+{
+    const std::vector<std::uint32_t> entities = addAvatars(world, avatar, players);
+
+    const int maxPrediction = 8;
+    RollbackSession session(world, entities, 16, maxPrediction);
+
+    // Player 0 is local; the others' inputs arrive maxPrediction - 1 ticks late and change every
+    // tick, so every frame rewinds the full window
+    const std::uint32_t delay = static_cast<std::uint32_t>(maxPrediction - 1);
+    const std::uint8_t mask = input_handler::ButtonLeft | input_handler::ButtonRight | input_handler::ButtonJump;
+    std::uint32_t seed = 0x2545f491u;
+    Uint64 resimNS = 0;
+    for (int frame = 0; frame < renderFrames; ++frame)
+    {
+        const std::uint32_t next = session.getTick() + 1;
+        seed = seed * 1664525u + 1013904223u;
+        session.addInput(0, next, static_cast<std::uint8_t>((seed >> 24) & mask));
+        if (next > delay)
+        {
+            for (int p = 1; p < players; ++p)
+            {
+                seed = seed * 1664525u + 1013904223u;
+                session.addInput(p, next - delay, static_cast<std::uint8_t>((seed >> 24) & mask));
+            }
+        }
+        session.advance();
+
+        const Uint64 start = SDL_GetTicksNS();
+        session.reconcile();
+        resimNS += SDL_GetTicksNS() - start;
+    }
+
+    RollbackBenchmarkResult r;
+    r.players = players;
+    r.frames = session.resimulatedFrames();
+    r.framesPerMs = resimNS > 0 ? static_cast<double>(r.frames) / (static_cast<double>(resimNS) / SDL_NS_PER_MS) : 0.0;
+    return r;
+}
+
+RollbackCheckResult checkRollback(World &plain, World &rolled, const Entity &avatar, int players, int ticks)
+{
+    RollbackCheckResult r{ticks, 0, 0, -1};
+    const std::vector<std::uint32_t> entities = addAvatars(plain, avatar, players);
+    addAvatars(rolled, avatar, players);
+
+    // Plain: held buttons and pressed edges exactly as a session applies them
+    std::vector<std::uint64_t> expected;
+    expected.reserve(static_cast<std::size_t>(std::max(ticks, 0)));
+    std::vector<std::uint8_t> held(entities.size(), 0);
+    for (int t = 1; t <= ticks; ++t)
+    {
+        for (std::size_t p = 0; p < entities.size(); ++p)
+        {
+            const std::uint8_t now = scriptedButtons(static_cast<int>(p), static_cast<std::uint32_t>(t));
+            plain.getControls().applyButtons(plain.getEntity(entities[p]), now, static_cast<std::uint8_t>(now & ~held[p]));
+            held[p] = now;
+        }
+        plain.step();
+        expected.push_back(golden::hashState(plain.getEntities()));
+    }
+
+    // Rolled: player 0 is local; the others' input for the last few ticks lands all at once, one
+    // tick short of the prediction limit, so the session never has to stall
+    const int maxPrediction = 8;
+    const std::uint32_t burst = static_cast<std::uint32_t>(maxPrediction - 1);
+    RollbackSession session(rolled, entities, 16, maxPrediction);
+    std::uint32_t delivered = 0;
+    while (session.getTick() < static_cast<std::uint32_t>(ticks))
+    {
+        const std::uint32_t next = session.getTick() + 1;
+        session.addInput(0, next, scriptedButtons(0, next));
+        if (next % burst == 0 || next == static_cast<std::uint32_t>(ticks))
+        {
+            for (int p = 1; p < players; ++p)
+            {
+                for (std::uint32_t t = delivered + 1; t <= next; ++t)
+                    session.addInput(p, t, scriptedButtons(p, t));
+            }
+            delivered = next;
+        }
+        if (!session.advance()) break;
+        session.reconcile();
+
+        if (session.getConfirmedTick() < session.getTick()) continue;
+        ++r.compared;
+        if (golden::hashState(rolled.getEntities()) != expected[session.getTick() - 1] && r.firstMismatch < 0)
+            r.firstMismatch = static_cast<long long>(session.getTick());
+    }
+    r.resimulated = session.resimulatedFrames();
+    return r;
+}
+
+} // namespace net
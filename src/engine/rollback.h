@@ -0,0 +1,102 @@
+// Rollback netcode: predict missing inputs, simulate ahead, rewind and resimulate on corrections
+#ifndef ROLLBACK_H
+#define ROLLBACK_H
+
+#include <cstdint>
+#include <vector>
+
+#include "entity.h"
+
+class World;
+
+namespace net {
+
+class RollbackSession
+{
+public:
+    // players maps player index to entity index; maxPrediction bounds how far the session may run
+    // ahead of confirmed input, and therefore the longest resimulation (at most historyFrames - 1)
+    RollbackSession(World &world, const std::vector<std::uint32_t> &players, int historyFrames = 16, int maxPrediction = 8);
+
+    // Record a player's real buttons for a tick. Local input arrives before the tick runs;
+    // remote input may arrive after it was predicted, which schedules a rollback.
+    // Returns false if the tick is already outside the history window.
+    bool addInput(int player, std::uint32_t tick, std::uint8_t buttons);
+
+    // Simulate the next tick with confirmed or predicted input; false when the prediction window is full
+    bool advance();
+
+    // Rewind to the earliest mispredicted tick and resimulate up to the present; call once per render
+    // frame. Returns the number of ticks resimulated.
+    int reconcile();
+
+    std::uint32_t getTick() const { return tick_; }
+    // Latest tick for which every player's input is known
+    std::uint32_t getConfirmedTick() const;
+    std::uint64_t resimulatedFrames() const { return resimulated_; }
+
+private:
+    struct Frame
+    {
+        std::uint32_t tick = 0;
+        unsigned long long engineTick = 0;
+        std::vector<Entity::SimState> state; // world before the tick ran
+        std::vector<std::uint8_t> used;      // buttons each player ran the tick with
+    };
+
+    struct PlayerInput
+    {
+        std::uint32_t entity;
+        std::vector<std::uint8_t> buttons;   // ring of confirmed buttons by tick
+        std::vector<std::uint32_t> tickOf;   // which tick each ring slot holds
+        std::uint32_t lastConfirmed = 0;
+    };
+
+    std::uint8_t inputFor(const PlayerInput &p, std::uint32_t tick) const;
+    void simulate(std::uint32_t tick);
+
+    World &world_;
+    std::vector<PlayerInput> players_;
+    std::vector<Frame> history_;
+    int maxPrediction_;
+    std::uint32_t tick_ = 0;
+    std::uint32_t rollbackFrom_ = 0; // 0 = nothing to correct
+    std::uint64_t resimulated_ = 0;
+};
+
+// Copies of avatar in rows of 12, each row stacked above the last with a small gap all round, so
+// none starts inside another; returns their entity indices
+std::vector<std::uint32_t> addAvatars(World &world, const Entity &avatar, int players);
+
+// Reproducible buttons for a scripted player: a fresh choice every other tick, different for
+// every player
+std::uint8_t scriptedButtons(int player, std::uint32_t tick);
+
+struct RollbackBenchmarkResult
+{
+    int players;
+    std::uint64_t frames;
+    double framesPerMs;
+};
+
+// Run a session that mispredicts on purpose so every render frame resimulates the full window;
+// measures how many resimulated ticks per millisecond the tick path sustains
+RollbackBenchmarkResult benchmarkRollback(World &world, const Entity &avatar, int players, int renderFrames);
+
+struct RollbackCheckResult
+{
+    int ticks;
+    int compared;             // ticks on which every input was confirmed and the states compared
+    std::uint64_t resimulated;
+    long long firstMismatch;  // first compared tick whose state differs, -1 if none
+};
+
+// Run one scene in two identical worlds: plainly, with every player's input known before each
+// tick, and through a session whose remote input arrives in late bursts, so most ticks are
+// mispredicted and resimulated. Whenever the session has every input up to its tick, its state
+// must hash the same as the plain run's on that tick.
+RollbackCheckResult checkRollback(World &plain, World &rolled, const Entity &avatar, int players, int ticks);
+
+} // namespace net
+
+#endif
@@ -0,0 +1,50 @@
+// Compile-time choice of the simulation's numeric type (positions, velocities, time)
+#ifndef SCALAR_H
+#define SCALAR_H
+
+#include "fixed.h"
+
+// Selected with -DFEELINGLOOPY_SCALAR=float|double|q16_16|q32_32 at configure time
+namespace sim {
+
+#if defined(FEELINGLOOPY_SCALAR_DOUBLE)
+using Real = double;
+#elif defined(FEELINGLOOPY_SCALAR_Q16_16)
+using Real = Q16_16;
+#elif defined(FEELINGLOOPY_SCALAR_Q32_32)
+#if !defined(FIXED_HAS_Q32_32)
+#error "Q32.32 needs a compiler with 128-bit integers"
+#endif
+using Real = Q32_32;
+#else
+using Real = float;
+#endif
+
+// Leave simulation space for rendering, culling and logging
+template <typename T>
+inline float toFloat(T v)
+{
+    return static_cast<float>(v);
+}
+
+template <typename T>
+constexpr T absolute(T v)
+{
+    return v < T(0) ? -v : v;
+}
+
+template <typename T>
+constexpr T minimum(T a, T b)
+{
+    return b < a ? b : a;
+}
+
+template <typename T>
+constexpr T maximum(T a, T b)
+{
+    return a < b ? b : a;
+}
+
+} // namespace sim
+
+#endif
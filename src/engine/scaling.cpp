@@ -13,28 +13,38 @@ void Controller::init(SDL_Window* window, SDL_Renderer* renderer, int base_w, in
     applyWindowSize(window);
 }
 
-void Controller::apply(SDL_Renderer* renderer, const std::vector<Entity>& entities) const
+SDL_ScaleMode Controller::applyPresentation(SDL_Renderer* renderer) const
 {
-    if (!renderer) return;
     if (mode == ScalingMode::ProportionalLogical) {
         SDL_SetRenderLogicalPresentation(renderer, logical_w, logical_h, SDL_LOGICAL_PRESENTATION_LETTERBOX);
         SDL_SetDefaultTextureScaleMode(renderer, SDL_SCALEMODE_LINEAR);
-        for (auto &e : entities) {
-            if (SDL_Texture *tex = e.getTexture()) {
-                SDL_SetTextureScaleMode(tex, SDL_SCALEMODE_LINEAR);
-            }
-        }
-    } else {
-        SDL_SetRenderLogicalPresentation(renderer, 0, 0, SDL_LOGICAL_PRESENTATION_DISABLED);
-        SDL_SetDefaultTextureScaleMode(renderer, SDL_SCALEMODE_NEAREST);
-        for (auto &e : entities) {
-            if (SDL_Texture *tex = e.getTexture()) {
-                SDL_SetTextureScaleMode(tex, SDL_SCALEMODE_NEAREST);
-            }
+        return SDL_SCALEMODE_LINEAR;
+    }
+    SDL_SetRenderLogicalPresentation(renderer, 0, 0, SDL_LOGICAL_PRESENTATION_DISABLED);
+    SDL_SetDefaultTextureScaleMode(renderer, SDL_SCALEMODE_NEAREST);
+    return SDL_SCALEMODE_NEAREST;
+}
+
+void Controller::apply(SDL_Renderer* renderer, const std::vector<Entity>& entities) const
+{
+    if (!renderer) return;
+    const SDL_ScaleMode scaleMode = applyPresentation(renderer);
+    for (auto &e : entities) {
+        if (SDL_Texture *tex = e.getTexture()) {
+            SDL_SetTextureScaleMode(tex, scaleMode);
         }
     }
 }
 
+void Controller::apply(SDL_Renderer* renderer, const render::Snapshot& snapshot) const
+{
+    if (!renderer) return;
+    const SDL_ScaleMode scaleMode = applyPresentation(renderer);
+    for (const render::Sprite &s : snapshot.sprites) {
+        SDL_SetTextureScaleMode(s.texture, scaleMode);
+    }
+}
+
 void Controller::applyWindowSize(SDL_Window* window) const
 {
     if (!window) return;
@@ -50,6 +60,13 @@ void Controller::setMode(ScalingMode newMode, SDL_Renderer* renderer, const std:
     apply(renderer, entities);
 }
 
+void Controller::setMode(ScalingMode newMode, SDL_Renderer* renderer, const render::Snapshot& snapshot)
+{
+    if (mode == newMode) return;
+    mode = newMode;
+    apply(renderer, snapshot);
+}
+
 void Controller::onMouseWheel(const SDL_Event& e, SDL_Window* window)
 {
     if (e.type != SDL_EVENT_MOUSE_WHEEL) return;
@@ -3,6 +3,7 @@
 #include <SDL3/SDL.h>
 #include <vector>
 #include "entity.h"
+#include "render_snapshot.h"
 
 namespace scaling {
 
@@ -20,17 +21,24 @@ struct Controller {
     // Initialize baseline and apply defaults
     void init(SDL_Window* window, SDL_Renderer* renderer, int base_w, int base_h, const std::vector<Entity>& entities);
 
-    // Apply current mode to renderer and textures
+    // Apply current mode to renderer and textures. The entity form reads the live entity list, so
+    // only while no simulation thread is stepping it; the render thread passes its snapshot.
     void apply(SDL_Renderer* renderer, const std::vector<Entity>& entities) const;
+    void apply(SDL_Renderer* renderer, const render::Snapshot& snapshot) const;
 
     // Resize window to logical * window_scale
     void applyWindowSize(SDL_Window* window) const;
 
     // Change mode and re-apply
     void setMode(ScalingMode newMode, SDL_Renderer* renderer, const std::vector<Entity>& entities);
+    void setMode(ScalingMode newMode, SDL_Renderer* renderer, const render::Snapshot& snapshot);
 
     // Handle mouse wheel to adjust window size
     void onMouseWheel(const SDL_Event& e, SDL_Window* window);
+
+private:
+    // Logical presentation and default texture filtering; returns the filtering for textures
+    SDL_ScaleMode applyPresentation(SDL_Renderer* renderer) const;
 };
 
 } // namespace scaling
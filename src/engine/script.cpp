@@ -0,0 +1,345 @@
+// Coroutine scripts and their scheduler
+#include "script.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "metrics.h"
+#include "world.h"
+
+namespace script {
+
+namespace {
+
+// Closer than this counts as arrived; a landing step can miss by a rounding error
+constexpr float kArrival = 0.5f;
+
+} // namespace
+
+bool Scheduler::later(const Timer &a, const Timer &b)
+{
+    return a.tick != b.tick ? a.tick > b.tick : a.slot > b.slot;
+}
+
+void Actor::Wait::await_suspend(std::coroutine_handle<>) const
+{
+    scheduler->sleep(slot, ticks);
+}
+
+void Actor::Contact::await_suspend(std::coroutine_handle<>) const
+{
+    scheduler->waitForContact(slot);
+}
+
+std::uint32_t Actor::Contact::await_resume() const
+{
+    return scheduler->slots_[slot].touched;
+}
+
+void Actor::MoveTo::await_suspend(std::coroutine_handle<>) const
+{
+    scheduler->moveTo(slot, x, y, speed);
+}
+
+Entity &Actor::entity() const
+{
+    return (*scheduler_->entities_)[entity_];
+}
+
+unsigned long long Actor::tick() const
+{
+    return scheduler_->tick_;
+}
+
+Scheduler::~Scheduler()
+{
+    clear();
+}
+
+std::uint32_t Scheduler::acquire(std::uint32_t entity)
+{
+    std::uint32_t id;
+    if (!free_.empty())
+    {
+        id = free_.back();
+        free_.pop_back();
+    }
+    else
+    {
+        id = static_cast<std::uint32_t>(slots_.size());
+        slots_.push_back(Slot{});
+    }
+    Slot &s = slots_[id];
+    s.entity = entity;
+    s.state = State::Free;
+    s.nextWaiter = kNone;
+    s.touched = kNone;
+    return id;
+}
+
+void Scheduler::start(std::uint32_t slot, std::coroutine_handle<> handle)
+{
+    slots_[slot].handle = handle;
+    slots_[slot].state = State::Ready;
+    ready_.push_back(slot);
+}
+
+void Scheduler::release(std::uint32_t slot)
+{
+    Slot &s = slots_[slot];
+    switch (s.state)
+    {
+    case State::Sleeping: --sleeping_; break; // its timer goes stale
+    case State::Moving: moving_.erase(std::find(moving_.begin(), moving_.end(), slot)); break;
+    case State::Waiting: unlink(slot); break;
+    default: break;
+    }
+    if (s.handle) s.handle.destroy();
+    s.handle = nullptr;
+    s.state = State::Free;
+    ++s.serial;
+    free_.push_back(slot);
+}
+
+void Scheduler::stop(std::uint32_t id)
+{
+    if (id < slots_.size() && slots_[id].state != State::Free && slots_[id].state != State::Running) release(id);
+}
+
+void Scheduler::clear()
+{
+    for (Slot &s : slots_)
+    {
+        if (s.handle) s.handle.destroy();
+    }
+    slots_.clear();
+    free_.clear();
+    timers_.clear();
+    moving_.clear();
+    ready_.clear();
+    contactHead_.clear();
+    sleeping_ = 0;
+}
+
+void Scheduler::sleep(std::uint32_t slot, int ticks)
+{
+    Slot &s = slots_[slot];
+    s.state = State::Sleeping;
+    ++sleeping_;
+    timers_.push_back(Timer{tick_ + static_cast<unsigned long long>(ticks), slot, s.serial});
+    std::push_heap(timers_.begin(), timers_.end(), later);
+}
+
+void Scheduler::waitForContact(std::uint32_t slot)
+{
+    Slot &s = slots_[slot];
+    if (s.entity >= contactHead_.size()) contactHead_.resize(s.entity + 1, kNone);
+    s.nextWaiter = contactHead_[s.entity];
+    contactHead_[s.entity] = slot;
+    s.state = State::Waiting;
+}
+
+void Scheduler::unlink(std::uint32_t slot)
+{
+    std::uint32_t *link = &contactHead_[slots_[slot].entity];
+    while (*link != kNone && *link != slot)
+        link = &slots_[*link].nextWaiter;
+    if (*link == slot) *link = slots_[slot].nextWaiter;
+}
+
+void Scheduler::moveTo(std::uint32_t slot, sim::Real x, sim::Real y, sim::Real speed)
+{
+    Slot &s = slots_[slot];
+    s.targetX = x;
+    s.targetY = y;
+    s.speed = speed;
+    s.state = State::Moving;
+    moving_.push_back(slot);
+}
+
+void Scheduler::notifyContact(std::uint32_t entity, std::uint32_t other)
+{
+    if (entity >= contactHead_.size()) return;
+    for (std::uint32_t id = contactHead_[entity]; id != kNone; id = slots_[id].nextWaiter)
+    {
+        slots_[id].state = State::Ready;
+        slots_[id].touched = other;
+        ready_.push_back(id);
+    }
+    contactHead_[entity] = kNone;
+}
+
+// Point the entity at its target; true once it is there (velocity then zeroed)
+bool Scheduler::steer(Slot &s, sim::Real dt)
+{
+    Entity &e = (*entities_)[s.entity];
+    const bool flying = !e.getisAffectedByGravity();
+    const sim::Real span = dt * sim::Real(e.getTickDivisor());
+    const sim::Real rx = s.targetX - e.getX();
+    const sim::Real ry = flying ? s.targetY - e.getY() : sim::Real(0);
+    const float fx = sim::toFloat(rx);
+    const float fy = sim::toFloat(ry);
+    const float distance = std::sqrt(fx * fx + fy * fy);
+    if (distance <= kArrival)
+    {
+        e.setVelocityX(sim::Real(0));
+        if (flying) e.setVelocityY(sim::Real(0));
+        return true;
+    }
+    // Within one step: land on the target instead of overshooting it
+    if (distance <= sim::toFloat(s.speed * span))
+    {
+        e.setVelocityX(rx / span);
+        if (flying) e.setVelocityY(ry / span);
+        return false;
+    }
+    e.setVelocityX(s.speed * sim::Real(fx / distance));
+    if (flying) e.setVelocityY(s.speed * sim::Real(fy / distance));
+    return false;
+}
+
+void Scheduler::run(std::vector<Entity> &entities, unsigned long long tick, sim::Real dt)
+{
+    if (running() == 0) return;
+    const std::uint64_t start = metrics::nowNS();
+    entities_ = &entities;
+    tick_ = tick;
+
+    for (std::size_t i = 0; i < moving_.size();)
+    {
+        const std::uint32_t id = moving_[i];
+        if (steer(slots_[id], dt))
+        {
+            slots_[id].state = State::Ready;
+            ready_.push_back(id);
+            moving_[i] = moving_.back();
+            moving_.pop_back();
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    while (!timers_.empty() && timers_.front().tick <= tick)
+    {
+        const Timer timer = timers_.front();
+        std::pop_heap(timers_.begin(), timers_.end(), later);
+        timers_.pop_back();
+        Slot &s = slots_[timer.slot];
+        if (s.serial != timer.serial || s.state != State::Sleeping) continue;
+        --sleeping_;
+        s.state = State::Ready;
+        ready_.push_back(timer.slot);
+    }
+
+    // Scripts spawned or woken while these run wait for the next tick
+    resuming_.swap(ready_);
+    for (std::uint32_t id : resuming_)
+    {
+        if (slots_[id].state != State::Ready) continue; // stopped meanwhile
+        slots_[id].state = State::Running;
+        const std::coroutine_handle<> handle = slots_[id].handle;
+        handle.resume();
+        ++resumes_;
+        if (handle.done())
+        {
+            release(id);
+        }
+        else if (slots_[id].state == State::Running)
+        {
+            // Suspended on something other than our awaitables: treat it as a one-tick yield
+            slots_[id].state = State::Ready;
+            ready_.push_back(id);
+        }
+    }
+    resuming_.clear();
+    runNS_ += metrics::nowNS() - start;
+}
+
+namespace {
+
+const sim::Real kPatrolSpeed(60);
+constexpr float kPatrolDistance = 32.0f;
+
+// Out, pause, back, pause, for ever
+Task patrol(Actor self, sim::Real left, sim::Real right, int phase, int pause)
+{
+    co_await self.wait(phase);
+    for (;;)
+    {
+        co_await self.moveTo(right, self.entity().getY(), kPatrolSpeed);
+        co_await self.wait(pause);
+        co_await self.moveTo(left, self.entity().getY(), kPatrolSpeed);
+        co_await self.wait(pause);
+    }
+}
+
+// Free-flying, non-colliding actors on a grid, each with its own phase and pause
+void populatePatrol(World &world, int actors, bool scripted)
+{
+    const float dt = sim::toFloat(world.getPhysics().getDeltaTime());
+    const int travel = static_cast<int>(std::lround(kPatrolDistance / (sim::toFloat(kPatrolSpeed) * dt)));
+    for (int i = 0; i < actors; ++i)
+    {
+        const float x = 32.0f + static_cast<float>(i % 200) * 48.0f;
+        const float y = 32.0f + static_cast<float>(i / 200) * 24.0f;
+        const int pause = 240 + (i * 37) % 240;
+        const int phase = (i * 53) % 480;
+        Entity actor(std::string("Actor"), x, y, 12.0f, 12.0f, 0.0f, 0.0f, 0.0f, 0.0f, true, false, false, false, false, nullptr, 0, 0, 0, 1.0f,
+                     false, nullptr);
+        if (!scripted)
+        {
+            const float speed = sim::toFloat(kPatrolSpeed);
+            actor.setPathVectors({Entity::PathVector{speed, 0.0f, travel}, Entity::PathVector{0.0f, 0.0f, pause},
+                                  Entity::PathVector{-speed, 0.0f, travel}, Entity::PathVector{0.0f, 0.0f, pause}});
+            actor.setPathVectorUpdatesRemaining(phase);
+        }
+        const Entity *added = world.addEntity(actor);
+        if (scripted)
+        {
+            const std::uint32_t index = static_cast<std::uint32_t>(added - world.getEntities().data());
+            world.getScripts().spawn(index, patrol, sim::Real(x), sim::Real(x + kPatrolDistance), phase, pause);
+        }
+    }
+}
+
+} // namespace
+
+ScriptBenchmarkResult benchmarkScripts(int actors, int ticks)
+{
+    using Clock = std::chrono::steady_clock;
+    ScriptBenchmarkResult result{};
+    result.actors = actors;
+    result.ticks = ticks;
+
+    World scripted;
+    populatePatrol(scripted, actors, true);
+    const Scheduler &scheduler = scripted.getScripts();
+    double moving = 0.0;
+    double sleeping = 0.0;
+    Clock::time_point start = Clock::now();
+    for (int t = 0; t < ticks; ++t)
+    {
+        scripted.step();
+        moving += static_cast<double>(scheduler.moving());
+        sleeping += static_cast<double>(scheduler.sleeping());
+    }
+    const double n = static_cast<double>(std::max(ticks, 1));
+    result.scriptTickMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / n;
+    result.runNsPerTick = static_cast<double>(scheduler.runNS()) / n;
+    result.resumesPerTick = static_cast<double>(scheduler.resumes()) / n;
+    result.movingPerTick = moving / n;
+    result.sleepingShare = actors > 0 ? sleeping / n / static_cast<double>(actors) : 0.0;
+
+    World paths;
+    populatePatrol(paths, actors, false);
+    start = Clock::now();
+    for (int t = 0; t < ticks; ++t)
+        paths.step();
+    result.pathTickMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / n;
+    return result;
+}
+
+} // namespace script
@@ -0,0 +1,222 @@
+// Coroutine behaviour scripts: suspend for ticks, a contact or an arrival; resumed by a timer queue
+#ifndef SCRIPT_H
+#define SCRIPT_H
+
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <utility>
+#include <vector>
+
+#include "entity.h"
+
+namespace script {
+
+class Scheduler;
+
+// Return type of every script. A script starts suspended; spawning hands its frame to the
+// scheduler, which destroys it when the script returns or is stopped.
+class Task
+{
+public:
+    struct promise_type
+    {
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    Task(Task &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+    Task &operator=(Task &&) = delete;
+    ~Task()
+    {
+        if (handle_) handle_.destroy();
+    }
+
+private:
+    friend class Scheduler;
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+    std::coroutine_handle<promise_type> release() { return std::exchange(handle_, nullptr); }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+// A script's view of its entity and the things it can wait for; the first parameter of every
+// script. Fetch entity() again after each co_await: the entity list may have grown meanwhile.
+class Actor
+{
+public:
+    struct Wait
+    {
+        Scheduler *scheduler;
+        std::uint32_t slot;
+        int ticks;
+        bool await_ready() const noexcept { return ticks <= 0; }
+        void await_suspend(std::coroutine_handle<>) const;
+        void await_resume() const noexcept {}
+    };
+
+    struct Contact
+    {
+        Scheduler *scheduler;
+        std::uint32_t slot;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<>) const;
+        std::uint32_t await_resume() const; // the entity touched
+    };
+
+    struct MoveTo
+    {
+        Scheduler *scheduler;
+        std::uint32_t slot;
+        sim::Real x, y, speed;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<>) const;
+        void await_resume() const noexcept {}
+    };
+
+    Entity &entity() const;
+    std::uint32_t index() const { return entity_; }
+    unsigned long long tick() const;
+
+    // Resume ticks ticks from now (0 or less continues at once)
+    Wait wait(int ticks) const { return Wait{scheduler_, slot_, ticks}; }
+    // Resume on the tick after the entity touches, or is touched by, another entity
+    Contact contact() const { return Contact{scheduler_, slot_}; }
+    // Steer toward (x, y) at speed units per second and resume on arrival. Entities under gravity
+    // only steer horizontally and arrive when x is reached. A blocked mover keeps trying.
+    MoveTo moveTo(sim::Real x, sim::Real y, sim::Real speed) const { return MoveTo{scheduler_, slot_, x, y, speed}; }
+
+private:
+    friend class Scheduler;
+    Actor(Scheduler *scheduler, std::uint32_t slot, std::uint32_t entity) : scheduler_(scheduler), slot_(slot), entity_(entity) {}
+
+    Scheduler *scheduler_;
+    std::uint32_t slot_;
+    std::uint32_t entity_;
+};
+
+// Runs the scripts of one world. A suspended script costs nothing per tick: sleepers sit in a
+// min-heap keyed by wake tick, contact waiters in a per-entity list, and only scripts in the middle
+// of a moveTo are looked at every tick. Resumption order is fixed (contacts, arrivals, then timers
+// by tick and script id), so every peer runs scripts identically. Coroutine frames are not part of
+// Entity::SimState: rollback or lock-step worlds should drive their entities some other way.
+class Scheduler
+{
+public:
+    static constexpr std::uint32_t kNone = 0xffffffffu;
+
+    Scheduler() = default;
+    ~Scheduler();
+    Scheduler(const Scheduler &) = delete;
+    Scheduler &operator=(const Scheduler &) = delete;
+
+    // Create script(actor, args...) for entity; it first runs on the next run(). Arguments are
+    // copied into the coroutine frame, so pass values, and use a free function or a captureless
+    // lambda as the script. Returns an id for stop().
+    template <typename Script, typename... Args>
+    std::uint32_t spawn(std::uint32_t entity, Script &&script, Args &&...args)
+    {
+        const std::uint32_t slot = acquire(entity);
+        Task task = script(Actor(this, slot, entity), std::forward<Args>(args)...);
+        start(slot, task.release());
+        return slot;
+    }
+    // Destroy a script wherever it is suspended; not from inside that script
+    void stop(std::uint32_t id);
+    // Destroy every script (world reset)
+    void clear();
+
+    // Once per tick on the simulation thread: steer the movers, then resume every script whose
+    // wait is over. dt is the world's timestep.
+    void run(std::vector<Entity> &entities, unsigned long long tick, sim::Real dt);
+    // entity touched other this tick; its contact() waiters resume on the next run()
+    void notifyContact(std::uint32_t entity, std::uint32_t other);
+
+    std::size_t running() const { return slots_.size() - free_.size(); }
+    std::size_t sleeping() const { return sleeping_; }
+    std::size_t moving() const { return moving_.size(); }
+    std::uint64_t resumes() const { return resumes_; }
+    std::uint64_t runNS() const { return runNS_; }
+
+private:
+    friend class Actor;
+    friend struct Actor::Wait;
+    friend struct Actor::Contact;
+    friend struct Actor::MoveTo;
+
+    enum class State : std::uint8_t
+    {
+        Free,
+        Ready,    // resumes on the next run()
+        Sleeping, // in timers_
+        Moving,   // in moving_
+        Waiting,  // in the contact list of its entity
+        Running,
+    };
+
+    struct Slot
+    {
+        std::coroutine_handle<> handle;
+        std::uint32_t entity;
+        std::uint32_t serial; // bumped on reuse, so stale timers are skipped
+        State state;
+        std::uint32_t nextWaiter; // contact list
+        std::uint32_t touched;    // what the last contact was with
+        sim::Real targetX, targetY, speed;
+    };
+
+    struct Timer
+    {
+        unsigned long long tick;
+        std::uint32_t slot;
+        std::uint32_t serial;
+    };
+
+    static bool later(const Timer &a, const Timer &b); // heap order: earliest tick, then lowest id
+
+    std::uint32_t acquire(std::uint32_t entity);
+    void start(std::uint32_t slot, std::coroutine_handle<> handle);
+    void release(std::uint32_t slot);
+    void sleep(std::uint32_t slot, int ticks);
+    void waitForContact(std::uint32_t slot);
+    void moveTo(std::uint32_t slot, sim::Real x, sim::Real y, sim::Real speed);
+    bool steer(Slot &slot, sim::Real dt);
+    void unlink(std::uint32_t slot);
+
+    std::vector<Slot> slots_;
+    std::vector<std::uint32_t> free_;
+    std::vector<Timer> timers_; // min-heap by (tick, slot)
+    std::vector<std::uint32_t> moving_;
+    std::vector<std::uint32_t> ready_;
+    std::vector<std::uint32_t> resuming_;
+    std::vector<std::uint32_t> contactHead_; // first contact waiter by entity
+    std::vector<Entity> *entities_ = nullptr;
+    unsigned long long tick_ = 0;
+    std::size_t sleeping_ = 0;
+    std::uint64_t resumes_ = 0;
+    std::uint64_t runNS_ = 0;
+};
+
+struct ScriptBenchmarkResult
+{
+    int actors;
+    int ticks;
+    double scriptTickMs;    // whole world step with every actor scripted
+    double pathTickMs;      // the same patrol as PathVector lists
+    double runNsPerTick;    // scheduler time per tick
+    double resumesPerTick;
+    double movingPerTick;   // scripts in a moveTo, on average
+    double sleepingShare;   // fraction of scripts asleep on a timer, on average
+};
+
+// Actors patrolling back and forth with long pauses, scripted and as path followers
+ScriptBenchmarkResult benchmarkScripts(int actors, int ticks);
+
+} // namespace script
+
+#endif
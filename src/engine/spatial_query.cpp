@@ -0,0 +1,381 @@
+// Uniform-grid collision queries
+#include "spatial_query.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "frame_arena.h"
+#include "tilemap.h"
+#include "worker_pool.h"
+
+namespace collision {
+
+namespace {
+
+// Grids wider than this per axis grow their cells instead, bounding memory for sparse worlds
+constexpr int kMaxCellsPerAxis = 512;
+// Below this many queries per thread the hand-off cost outweighs the work
+constexpr std::size_t kMinQueriesPerThread = 64;
+
+// Queries cost about the same, so each thread of the shared pool takes one contiguous chunk
+template <typename Fn>
+void parallelFor(std::size_t count, int threads, Fn &&fn)
+{
+    WorkerPool &pool = WorkerPool::shared();
+    if (threads <= 0) threads = pool.threadCount();
+    const std::size_t useful = std::max<std::size_t>(1, count / kMinQueriesPerThread);
+    const std::size_t chunks = std::min<std::size_t>(static_cast<std::size_t>(threads), useful);
+    const std::size_t chunk = (count + chunks - 1) / chunks;
+    auto runChunk = [&fn, count, chunk](std::size_t c) {
+        const std::size_t begin = std::min(count, c * chunk);
+        fn(begin, std::min(count, begin + chunk));
+    };
+    pool.forEach(chunks, runChunk, static_cast<int>(chunks));
+}
+
+double toDouble(sim::Real v) { return static_cast<double>(v); }
+
+// Slab test of the segment o + t * d, t in [0, 1], against a half-open box
+bool segmentHitsBox(double ox, double oy, double dx, double dy, double x0, double y0, double x1, double y1,
+                    double &tHit, int &nx, int &ny)
+{
+    double tEnter = 0.0, tExit = 1.0;
+    nx = ny = 0;
+
+    if (dx == 0.0)
+    {
+        if (ox < x0 || ox >= x1) return false;
+    }
+    else
+    {
+        double ta = (x0 - ox) / dx, tb = (x1 - ox) / dx;
+        int n = -1;
+        if (ta > tb)
+        {
+            std::swap(ta, tb);
+            n = 1;
+        }
+        if (ta > tEnter)
+        {
+            tEnter = ta;
+            nx = n;
+        }
+        tExit = std::min(tExit, tb);
+        if (tEnter > tExit) return false;
+    }
+
+    if (dy == 0.0)
+    {
+        if (oy < y0 || oy >= y1) return false;
+    }
+    else
+    {
+        double ta = (y0 - oy) / dy, tb = (y1 - oy) / dy;
+        int n = -1;
+        if (ta > tb)
+        {
+            std::swap(ta, tb);
+            n = 1;
+        }
+        if (ta > tEnter)
+        {
+            tEnter = ta;
+            nx = 0;
+            ny = n;
+        }
+        tExit = std::min(tExit, tb);
+        if (tEnter > tExit) return false;
+    }
+
+    tHit = tEnter;
+    return true;
+}
+
+} // namespace
+
+SpatialGrid::SpatialGrid(float cellSize) : cellSize_(cellSize > 1.0f ? cellSize : 1.0f) {}
+
+void SpatialGrid::build(const ColliderSet &colliders, TileLayer *terrain, mem::FrameArena &scratch)
+{
+    items_.clear();
+    for (std::uint32_t i = 0; i < colliders.size(); ++i)
+    {
+        if ((colliders.flags(i) & (ColliderTarget | ColliderTrigger)) != ColliderTarget) continue;
+        const Box<sim::Real> &b = colliders.box(i);
+        const double x = toDouble(b.x), y = toDouble(b.y);
+        items_.push_back(Item{x, y, x + toDouble(b.w), y + toDouble(b.h), colliders.layer(i), i});
+    }
+    if (terrain)
+    {
+        terrain->forEachSolidRect([this](const SDL_FRect &r) {
+            items_.push_back(Item{r.x, r.y, static_cast<double>(r.x) + r.w, static_cast<double>(r.y) + r.h, LayerTerrain, kTerrainEntity});
+        });
+    }
+
+    columns_ = rows_ = 0;
+    cellStart_.clear();
+    cellItems_.clear();
+    if (items_.empty()) return;
+
+    double minX = items_[0].x0, minY = items_[0].y0, maxX = items_[0].x1, maxY = items_[0].y1;
+    for (const Item &it : items_)
+    {
+        minX = std::min(minX, it.x0);
+        minY = std::min(minY, it.y0);
+        maxX = std::max(maxX, it.x1);
+        maxY = std::max(maxY, it.y1);
+    }
+
+    double cell = cellSize_;
+    cell = std::max(cell, (maxX - minX) / kMaxCellsPerAxis);
+    cell = std::max(cell, (maxY - minY) / kMaxCellsPerAxis);
+    inverseCell_ = 1.0 / cell;
+    originX_ = minX;
+    originY_ = minY;
+    columns_ = std::max(1, static_cast<int>(std::ceil((maxX - minX) * inverseCell_)));
+    rows_ = std::max(1, static_cast<int>(std::ceil((maxY - minY) * inverseCell_)));
+
+    // Count, prefix-sum, then fill: one contiguous list for all cells
+    cellStart_.assign(static_cast<std::size_t>(columns_) * rows_ + 1, 0);
+    int cx0, cy0, cx1, cy1;
+    for (const Item &it : items_)
+    {
+        cellRange(it.x0, it.y0, it.x1, it.y1, cx0, cy0, cx1, cy1);
+        for (int cy = cy0; cy <= cy1; ++cy)
+            for (int cx = cx0; cx <= cx1; ++cx)
+                ++cellStart_[static_cast<std::size_t>(cy) * columns_ + cx + 1];
+    }
+    for (std::size_t c = 1; c < cellStart_.size(); ++c)
+        cellStart_[c] += cellStart_[c - 1];
+
+    cellItems_.resize(cellStart_.back());
+    std::uint32_t *cursor = scratch.allocateArray<std::uint32_t>(cellStart_.size() - 1);
+    std::copy(cellStart_.begin(), cellStart_.end() - 1, cursor);
+    for (std::uint32_t i = 0; i < items_.size(); ++i)
+    {
+        const Item &it = items_[i];
+        cellRange(it.x0, it.y0, it.x1, it.y1, cx0, cy0, cx1, cy1);
+        for (int cy = cy0; cy <= cy1; ++cy)
+            for (int cx = cx0; cx <= cx1; ++cx)
+                cellItems_[cursor[static_cast<std::size_t>(cy) * columns_ + cx]++] = i;
+    }
+}
+
+int SpatialGrid::cellX(double x) const
+{
+    return std::clamp(static_cast<int>(std::floor((x - originX_) * inverseCell_)), 0, columns_ - 1);
+}
+
+int SpatialGrid::cellY(double y) const
+{
+    return std::clamp(static_cast<int>(std::floor((y - originY_) * inverseCell_)), 0, rows_ - 1);
+}
+
+bool SpatialGrid::cellRange(double x0, double y0, double x1, double y1, int &cx0, int &cy0, int &cx1, int &cy1) const
+{
+    if (columns_ == 0) return false;
+    const double gridX1 = originX_ + columns_ / inverseCell_;
+    const double gridY1 = originY_ + rows_ / inverseCell_;
+    if (x1 < originX_ || y1 < originY_ || x0 > gridX1 || y0 > gridY1) return false;
+    cx0 = cellX(x0);
+    cy0 = cellY(y0);
+    cx1 = cellX(x1);
+    cy1 = cellY(y1);
+    return true;
+}
+
+bool SpatialGrid::raycast(const RayQuery &ray, RayHit &hit) const
+{
+    hit = RayHit{};
+    if (columns_ == 0) return false;
+
+    const double ox = toDouble(ray.x), oy = toDouble(ray.y);
+    const double dx = toDouble(ray.dx), dy = toDouble(ray.dy);
+    const double cell = 1.0 / inverseCell_;
+
+    // Clip the segment to the grid so the walk starts in a valid cell
+    double tStart, tEnd = 1.0;
+    int unusedX, unusedY;
+    if (!segmentHitsBox(ox, oy, dx, dy, originX_, originY_, originX_ + columns_ * cell, originY_ + rows_ * cell, tStart, unusedX, unusedY))
+        return false;
+    {
+        // Exit parameter of the grid box along the segment
+        const double txExit = dx > 0.0 ? (originX_ + columns_ * cell - ox) / dx : dx < 0.0 ? (originX_ - ox) / dx : 1.0;
+        const double tyExit = dy > 0.0 ? (originY_ + rows_ * cell - oy) / dy : dy < 0.0 ? (originY_ - oy) / dy : 1.0;
+        tEnd = std::min(tEnd, std::min(txExit, tyExit));
+    }
+
+    int cx = cellX(ox + dx * tStart);
+    int cy = cellY(oy + dy * tStart);
+    const int stepX = dx > 0.0 ? 1 : (dx < 0.0 ? -1 : 0);
+    const int stepY = dy > 0.0 ? 1 : (dy < 0.0 ? -1 : 0);
+    const double inf = std::numeric_limits<double>::infinity();
+    double tMaxX = stepX != 0 ? (originX_ + (cx + (stepX > 0 ? 1 : 0)) * cell - ox) / dx : inf;
+    double tMaxY = stepY != 0 ? (originY_ + (cy + (stepY > 0 ? 1 : 0)) * cell - oy) / dy : inf;
+    const double tDeltaX = stepX != 0 ? cell / std::fabs(dx) : inf;
+    const double tDeltaY = stepY != 0 ? cell / std::fabs(dy) : inf;
+
+    double bestT = inf;
+    const Item *best = nullptr;
+    int bestNx = 0, bestNy = 0;
+    for (;;)
+    {
+        const std::size_t c = static_cast<std::size_t>(cy) * columns_ + cx;
+        for (std::uint32_t k = cellStart_[c]; k < cellStart_[c + 1]; ++k)
+        {
+            const Item &it = items_[cellItems_[k]];
+            if ((it.layer & ray.mask) == 0 || it.entity == ray.ignore) continue;
+            double t;
+            int nx, ny;
+            // Ties keep the lower item index so the result does not depend on walk order
+            if (segmentHitsBox(ox, oy, dx, dy, it.x0, it.y0, it.x1, it.y1, t, nx, ny) &&
+                (t < bestT || (t == bestT && &it < best)))
+            {
+                bestT = t;
+                best = &it;
+                bestNx = nx;
+                bestNy = ny;
+            }
+        }
+
+        // Anything in later cells starts beyond the current cell's far edge
+        const double tNext = std::min(tMaxX, tMaxY);
+        if (bestT <= tNext || tNext > tEnd) break;
+        // On an exact corner step one axis at a time so neither neighbour is skipped
+        if (tMaxX <= tMaxY)
+        {
+            cx += stepX;
+            tMaxX += tDeltaX;
+        }
+        else
+        {
+            cy += stepY;
+            tMaxY += tDeltaY;
+        }
+        if (cx < 0 || cy < 0 || cx >= columns_ || cy >= rows_) break;
+    }
+
+    if (!best) return false;
+    hit.hit = true;
+    hit.entity = best->entity;
+    hit.fraction = sim::Real(bestT);
+    hit.x = sim::Real(ox + dx * bestT);
+    hit.y = sim::Real(oy + dy * bestT);
+    hit.normalX = bestNx;
+    hit.normalY = bestNy;
+    return true;
+}
+
+void SpatialGrid::overlapBox(const Box<sim::Real> &box, LayerMask mask, std::vector<std::uint32_t> &out) const
+{
+    out.clear();
+    const double qx0 = toDouble(box.x), qy0 = toDouble(box.y);
+    const double qx1 = qx0 + toDouble(box.w), qy1 = qy0 + toDouble(box.h);
+    int cx0, cy0, cx1, cy1;
+    if (!cellRange(qx0, qy0, qx1, qy1, cx0, cy0, cx1, cy1)) return;
+
+    bool terrainReported = false;
+    for (int cy = cy0; cy <= cy1; ++cy)
+    {
+        for (int cx = cx0; cx <= cx1; ++cx)
+        {
+            const std::size_t c = static_cast<std::size_t>(cy) * columns_ + cx;
+            for (std::uint32_t k = cellStart_[c]; k < cellStart_[c + 1]; ++k)
+            {
+                const Item &it = items_[cellItems_[k]];
+                if ((it.layer & mask) == 0) continue;
+                if (!(qx0 < it.x1 && qx1 > it.x0 && qy0 < it.y1 && qy1 > it.y0)) continue;
+                // An item spanning several cells is reported only from the cell holding the
+                // overlap's top-left corner; no shared visited set, so queries stay thread-safe
+                if (cellX(std::max(qx0, it.x0)) != cx || cellY(std::max(qy0, it.y0)) != cy) continue;
+                if (it.entity == kTerrainEntity)
+                {
+                    if (terrainReported) continue;
+                    terrainReported = true;
+                }
+                out.push_back(it.entity);
+            }
+        }
+    }
+}
+
+bool SpatialGrid::nearest(const NearestQuery &query, NearestHit &hit) const
+{
+    hit = NearestHit{};
+    if (columns_ == 0) return false;
+
+    const double px = toDouble(query.x), py = toDouble(query.y);
+    const double maxDistance = toDouble(query.maxDistance);
+    const double cell = 1.0 / inverseCell_;
+    const int cx = cellX(px), cy = cellY(py);
+
+    double bestSq = maxDistance * maxDistance;
+    const Item *best = nullptr;
+    auto visit = [&](int x, int y) {
+        if (x < 0 || y < 0 || x >= columns_ || y >= rows_) return;
+        const std::size_t c = static_cast<std::size_t>(y) * columns_ + x;
+        for (std::uint32_t k = cellStart_[c]; k < cellStart_[c + 1]; ++k)
+        {
+            const Item &it = items_[cellItems_[k]];
+            if ((it.layer & query.mask) == 0 || it.entity == query.ignore || it.entity == kTerrainEntity) continue;
+            const double ex = std::max(std::max(it.x0 - px, 0.0), px - it.x1);
+            const double ey = std::max(std::max(it.y0 - py, 0.0), py - it.y1);
+            const double sq = ex * ex + ey * ey;
+            if (best ? (sq < bestSq || (sq == bestSq && &it < best)) : sq <= bestSq)
+            {
+                bestSq = sq;
+                best = &it;
+            }
+        }
+    };
+
+    // Rings of cells around the query point; ring r + 1 is at least r cells away
+    const int maxRing = std::max(columns_, rows_);
+    for (int r = 0; r <= maxRing; ++r)
+    {
+        if (r == 0)
+            visit(cx, cy);
+        else
+        {
+            for (int x = cx - r; x <= cx + r; ++x)
+            {
+                visit(x, cy - r);
+                visit(x, cy + r);
+            }
+            for (int y = cy - r + 1; y <= cy + r - 1; ++y)
+            {
+                visit(cx - r, y);
+                visit(cx + r, y);
+            }
+        }
+        const double reach = r * cell;
+        if (reach * reach > bestSq) break;
+    }
+
+    if (!best) return false;
+    hit.hit = true;
+    hit.entity = best->entity;
+    hit.distance = sim::Real(std::sqrt(bestSq));
+    return true;
+}
+
+void SpatialGrid::raycastBatch(const std::vector<RayQuery> &rays, std::vector<RayHit> &hits, int threads) const
+{
+    hits.resize(rays.size());
+    parallelFor(rays.size(), threads, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+            raycast(rays[i], hits[i]);
+    });
+}
+
+void SpatialGrid::nearestBatch(const std::vector<NearestQuery> &queries, std::vector<NearestHit> &hits, int threads) const
+{
+    hits.resize(queries.size());
+    parallelFor(queries.size(), threads, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+            nearest(queries[i], hits[i]);
+    });
+}
+
+} // namespace collision
@@ -0,0 +1,102 @@
+// Ray, box and nearest-entity queries over the collision world
+#ifndef SPATIAL_QUERY_H
+#define SPATIAL_QUERY_H
+
+#include <cstdint>
+#include <vector>
+
+#include "collision.h"
+
+class TileLayer;
+
+namespace mem {
+class FrameArena;
+}
+
+namespace collision {
+
+// Entity index reported for hits on the terrain layer
+constexpr std::uint32_t kTerrainEntity = 0xffffffffu;
+constexpr std::uint32_t kNoEntity = 0xfffffffeu;
+
+// Segment from (x, y) to (x + dx, y + dy)
+struct RayQuery
+{
+    sim::Real x, y, dx, dy;
+    LayerMask mask = LayerAll;
+    std::uint32_t ignore = kNoEntity; // usually the caster itself
+};
+
+struct RayHit
+{
+    bool hit = false;
+    std::uint32_t entity = kNoEntity;
+    sim::Real fraction = sim::Real(0); // 0..1 along the segment
+    sim::Real x = sim::Real(0), y = sim::Real(0);
+    int normalX = 0, normalY = 0; // face that was hit
+};
+
+struct NearestQuery
+{
+    sim::Real x, y;
+    sim::Real maxDistance;
+    LayerMask mask = LayerAll;
+    std::uint32_t ignore = kNoEntity;
+};
+
+struct NearestHit
+{
+    bool hit = false;
+    std::uint32_t entity = kNoEntity;
+    sim::Real distance = sim::Real(0); // to the closest point of the box, 0 when inside
+};
+
+// Uniform grid over every collider and terrain rect. Built once per tick on the simulation
+// thread; afterwards it is read-only, so any number of threads may query it until the next build.
+// Triggers are not included. Geometry is evaluated in double, which is exact for every
+// sim::Real input range the game uses and deterministic under -ffp-contract=off.
+class SpatialGrid
+{
+public:
+    explicit SpatialGrid(float cellSize = 128.0f);
+
+    // Temporary fill cursors come from scratch; the grid itself reuses its own storage
+    void build(const ColliderSet &colliders, TileLayer *terrain, mem::FrameArena &scratch);
+
+    // Closest hit along the segment; false when nothing in mask is crossed
+    bool raycast(const RayQuery &ray, RayHit &hit) const;
+    // Every entity in mask whose box overlaps the query (terrain reported once as kTerrainEntity)
+    void overlapBox(const Box<sim::Real> &box, LayerMask mask, std::vector<std::uint32_t> &out) const;
+    // Closest entity in mask within maxDistance (terrain excluded)
+    bool nearest(const NearestQuery &query, NearestHit &hit) const;
+
+    // Run many queries split across threads (0 = hardware concurrency); results match the inputs' order
+    void raycastBatch(const std::vector<RayQuery> &rays, std::vector<RayHit> &hits, int threads = 0) const;
+    void nearestBatch(const std::vector<NearestQuery> &queries, std::vector<NearestHit> &hits, int threads = 0) const;
+
+private:
+    struct Item
+    {
+        double x0, y0, x1, y1;
+        LayerMask layer;
+        std::uint32_t entity;
+    };
+
+    int cellX(double x) const;
+    int cellY(double y) const;
+    // Cell ranges clamped to the grid; false when the rect misses the grid entirely
+    bool cellRange(double x0, double y0, double x1, double y1, int &cx0, int &cy0, int &cx1, int &cy1) const;
+
+    float cellSize_;
+    double inverseCell_ = 0.0;
+    double originX_ = 0.0, originY_ = 0.0;
+    int columns_ = 0, rows_ = 0;
+    std::vector<Item> items_;
+    // Cell lists in compressed rows: cellStart_[c]..cellStart_[c + 1] index into cellItems_
+    std::vector<std::uint32_t> cellStart_;
+    std::vector<std::uint32_t> cellItems_;
+};
+
+} // namespace collision
+
+#endif
@@ -0,0 +1,242 @@
+// Tile layer implementation
+#include "tilemap.h"
+
+namespace {
+// Upper bound for a cached chunk texture edge, in pixels
+constexpr int kMaxChunkPixels = 2048;
+constexpr int kMaxChunkTiles = 32;
+}
+
+TileLayer::TileLayer(int tileWidth, int tileHeight, int columns, int rows, float originX, float originY)
+    : tileWidth_(SDL_max(tileWidth, 1)),
+      tileHeight_(SDL_max(tileHeight, 1)),
+      columns_(SDL_max(columns, 0)),
+      rows_(SDL_max(rows, 0)),
+      originX_(originX),
+      originY_(originY),
+      solidRevision_(~0ull)
+{
+    bounds_ = SDL_FRect{originX_, originY_, static_cast<float>(columns_ * tileWidth_), static_cast<float>(rows_ * tileHeight_)};
+    chunkColumns_ = SDL_clamp(kMaxChunkPixels / tileWidth_, 1, kMaxChunkTiles);
+    chunkRows_ = SDL_clamp(kMaxChunkPixels / tileHeight_, 1, kMaxChunkTiles);
+    chunksAcross_ = (columns_ + chunkColumns_ - 1) / chunkColumns_;
+    chunksDown_ = (rows_ + chunkRows_ - 1) / chunkRows_;
+    tiles_.resize(static_cast<std::size_t>(columns_) * rows_);
+    chunks_.resize(static_cast<std::size_t>(chunksAcross_) * chunksDown_);
+}
+
+TileLayer::~TileLayer()
+{
+    releaseTextures();
+}
+
+int TileLayer::addTileset(SDL_Texture *texture)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    tilesets_.push_back(texture);
+    return static_cast<int>(tilesets_.size() - 1);
+}
+
+void TileLayer::setTile(int column, int row, int tileset, const SDL_FRect &src, bool solid)
+{
+    if (column < 0 || row < 0 || column >= columns_ || row >= rows_) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    Tile &t = tiles_[static_cast<std::size_t>(row) * columns_ + column];
+    t.tileset = static_cast<std::int16_t>(tileset);
+    t.src = src;
+    t.solid = solid;
+    markDirty(column, row);
+}
+
+void TileLayer::clearTile(int column, int row)
+{
+    if (column < 0 || row < 0 || column >= columns_ || row >= rows_) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    tiles_[static_cast<std::size_t>(row) * columns_ + column] = Tile{};
+    markDirty(column, row);
+}
+
+void TileLayer::fill(int column, int row, int columns, int rows, int tileset, const SDL_FRect &src, bool solid)
+{
+    for (int r = row; r < row + rows; ++r)
+    {
+        for (int c = column; c < column + columns; ++c)
+        {
+            setTile(c, r, tileset, src, solid);
+        }
+    }
+}
+
+int TileLayer::chunkIndexFor(int column, int row) const
+{
+    return (row / chunkRows_) * chunksAcross_ + (column / chunkColumns_);
+}
+
+void TileLayer::markDirty(int column, int row)
+{
+    chunks_[chunkIndexFor(column, row)].dirty = true;
+    revision_.fetch_add(1, std::memory_order_release);
+}
+
+int TileLayer::render(SDL_Renderer *renderer)
+{
+    if (!renderer) return 0;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    int draws = 0;
+    for (int cy = 0; cy < chunksDown_; ++cy)
+    {
+        for (int cx = 0; cx < chunksAcross_; ++cx)
+        {
+            const int index = cy * chunksAcross_ + cx;
+            if (chunks_[index].dirty)
+            {
+                rebuildChunk(renderer, index);
+            }
+
+            const Chunk &chunk = chunks_[index];
+            if (chunk.empty || !chunk.texture) continue;
+
+            const SDL_FRect dst{originX_ + static_cast<float>(cx * chunkColumns_ * tileWidth_),
+                                originY_ + static_cast<float>(cy * chunkRows_ * tileHeight_),
+                                static_cast<float>(chunk.texture->w), static_cast<float>(chunk.texture->h)};
+            SDL_RenderTexture(renderer, chunk.texture, nullptr, &dst);
+            ++draws;
+        }
+    }
+    return draws;
+}
+
+void TileLayer::rebuildChunk(SDL_Renderer *renderer, int chunkIndex)
+{
+    Chunk &chunk = chunks_[chunkIndex];
+    chunk.dirty = false;
+
+    const int firstColumn = (chunkIndex % chunksAcross_) * chunkColumns_;
+    const int firstRow = (chunkIndex / chunksAcross_) * chunkRows_;
+    const int columns = SDL_min(chunkColumns_, columns_ - firstColumn);
+    const int rows = SDL_min(chunkRows_, rows_ - firstRow);
+
+    chunk.empty = true;
+    for (int r = firstRow; r < firstRow + rows && chunk.empty; ++r)
+    {
+        for (int c = firstColumn; c < firstColumn + columns; ++c)
+        {
+            if (tiles_[static_cast<std::size_t>(r) * columns_ + c].tileset >= 0)
+            {
+                chunk.empty = false;
+                break;
+            }
+        }
+    }
+    if (chunk.empty) return;
+
+    if (!chunk.texture)
+    {
+        chunk.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET,
+                                          columns * tileWidth_, rows * tileHeight_);
+        if (!chunk.texture)
+        {
+            SDL_Log("Couldn't create terrain chunk texture: %s", SDL_GetError());
+            return;
+        }
+        SDL_SetTextureBlendMode(chunk.texture, SDL_BLENDMODE_BLEND);
+    }
+
+    // Bake every tile of the chunk into its texture, then restore the caller's target
+    SDL_Texture *previousTarget = SDL_GetRenderTarget(renderer);
+    SDL_SetRenderTarget(renderer, chunk.texture);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+    for (int r = 0; r < rows; ++r)
+    {
+        for (int c = 0; c < columns; ++c)
+        {
+            const Tile &t = tiles_[static_cast<std::size_t>(firstRow + r) * columns_ + firstColumn + c];
+            if (t.tileset < 0 || t.tileset >= static_cast<int>(tilesets_.size())) continue;
+            const SDL_FRect dst{static_cast<float>(c * tileWidth_), static_cast<float>(r * tileHeight_),
+                                static_cast<float>(tileWidth_), static_cast<float>(tileHeight_)};
+            SDL_RenderTexture(renderer, tilesets_[t.tileset], &t.src, &dst);
+        }
+    }
+    SDL_SetRenderTarget(renderer, previousTarget);
+}
+
+void TileLayer::syncSolidRects()
+{
+    if (revision_.load(std::memory_order_acquire) == solidRevision_) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    solidRevision_ = revision_.load(std::memory_order_relaxed);
+    rebuildSolidRects();
+}
+
+// Greedy merge: horizontal runs of solid tiles, extended downwards while the run below matches
+void TileLayer::rebuildSolidRects()
+{
+    solidRects_.clear();
+
+    struct Run
+    {
+        int begin;
+        int end;
+        std::size_t rect;
+    };
+    std::vector<Run> open;
+    std::vector<Run> next;
+
+    const float tw = static_cast<float>(tileWidth_);
+    const float th = static_cast<float>(tileHeight_);
+    for (int r = 0; r < rows_; ++r)
+    {
+        next.clear();
+        int c = 0;
+        while (c < columns_)
+        {
+            if (!tiles_[static_cast<std::size_t>(r) * columns_ + c].solid)
+            {
+                ++c;
+                continue;
+            }
+            const int begin = c;
+            while (c < columns_ && tiles_[static_cast<std::size_t>(r) * columns_ + c].solid)
+                ++c;
+
+            // Extend the rect from the row above if it spans exactly the same columns
+            std::size_t rect = solidRects_.size();
+            for (const Run &run : open)
+            {
+                if (run.begin == begin && run.end == c)
+                {
+                    rect = run.rect;
+                    break;
+                }
+            }
+            if (rect == solidRects_.size())
+            {
+                solidRects_.push_back(SDL_FRect{originX_ + begin * tw, originY_ + r * th, (c - begin) * tw, 0.0f});
+            }
+            solidRects_[rect].h += th;
+            next.push_back(Run{begin, c, rect});
+        }
+        open.swap(next);
+    }
+}
+
+void TileLayer::releaseTextures()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Chunk &chunk : chunks_)
+    {
+        if (chunk.texture)
+        {
+            SDL_DestroyTexture(chunk.texture);
+            chunk.texture = nullptr;
+        }
+        chunk.dirty = true;
+    }
+    for (SDL_Texture *tex : tilesets_)
+    {
+        if (tex) SDL_DestroyTexture(tex);
+    }
+    tilesets_.clear();
+}
@@ -0,0 +1,120 @@
+// Static terrain tile layer with cached chunk textures and merged collision rects
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include <SDL3/SDL.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+class TileLayer
+{
+public:
+    // Grid of columns x rows tiles of tileWidth x tileHeight pixels, top-left at (originX, originY)
+    TileLayer(int tileWidth, int tileHeight, int columns, int rows, float originX, float originY);
+    ~TileLayer();
+
+    TileLayer(const TileLayer &) = delete;
+    TileLayer &operator=(const TileLayer &) = delete;
+
+    // Register a tileset texture; the layer takes ownership and destroys it in releaseTextures()
+    int addTileset(SDL_Texture *texture);
+
+    // Place a tile cut from a tileset; marks its chunk and the collision rects for rebuild
+    void setTile(int column, int row, int tileset, const SDL_FRect &src, bool solid);
+    void clearTile(int column, int row);
+
+    // Fill a block of cells with the same tile
+    void fill(int column, int row, int columns, int rows, int tileset, const SDL_FRect &src, bool solid);
+
+    // Draw cached chunks, re-rendering only the ones that changed (render thread); returns the
+    // number of chunk draws
+    int render(SDL_Renderer *renderer);
+
+    // Visit merged solid rects overlapping the query rect. Collision reads the simulation thread's
+    // own copy of the rects, so probes never wait for the render thread baking chunks; the copy is
+    // rebuilt (under the lock) only after an edit. Simulation thread only.
+    template <typename Fn>
+    void forEachSolidOverlapping(const SDL_FRect &query, Fn &&fn)
+    {
+        syncSolidRects();
+        if (!overlaps(query, bounds_))
+            return;
+        for (const SDL_FRect &r : solidRects_)
+        {
+            if (overlaps(query, r))
+                fn(r);
+        }
+    }
+
+    // Visit every merged solid rect in world space, without copying the list. Simulation thread only.
+    template <typename Fn>
+    void forEachSolidRect(Fn &&fn)
+    {
+        syncSolidRects();
+        for (const SDL_FRect &r : solidRects_)
+            fn(r);
+    }
+
+    // Destroy chunk caches and tileset textures
+    void releaseTextures();
+
+    // Bumped by every tile edit, so derived grids know when to restamp
+    std::uint64_t revision() const { return revision_.load(std::memory_order_relaxed); }
+
+    static bool overlaps(const SDL_FRect &a, const SDL_FRect &b)
+    {
+        return (a.x < b.x + b.w) && (a.x + a.w > b.x) && (a.y < b.y + b.h) && (a.y + a.h > b.y);
+    }
+
+private:
+    struct Tile
+    {
+        std::int16_t tileset = -1; // -1 means empty
+        bool solid = false;
+        SDL_FRect src{0.0f, 0.0f, 0.0f, 0.0f};
+    };
+
+    struct Chunk
+    {
+        SDL_Texture *texture = nullptr;
+        bool dirty = true;
+        bool empty = true;
+    };
+
+    int chunkIndexFor(int column, int row) const;
+    void markDirty(int column, int row);
+    void rebuildChunk(SDL_Renderer *renderer, int chunkIndex);
+    void syncSolidRects();
+    void rebuildSolidRects();
+
+    int tileWidth_;
+    int tileHeight_;
+    int columns_;
+    int rows_;
+    float originX_;
+    float originY_;
+    SDL_FRect bounds_;
+
+    // Chunks are sized so their cached texture stays within common GPU limits
+    int chunkColumns_;
+    int chunkRows_;
+    int chunksAcross_;
+    int chunksDown_;
+
+    std::vector<Tile> tiles_;
+    std::vector<SDL_Texture *> tilesets_;
+    std::vector<Chunk> chunks_;
+    std::atomic<std::uint64_t> revision_{0};
+
+    // Edits can come from the simulation thread while the render thread draws; the lock covers
+    // tiles, tilesets and chunks, never the probe path
+    std::mutex mutex_;
+
+    // Simulation thread's merged rects and the tile revision they were built from
+    std::vector<SDL_FRect> solidRects_;
+    std::uint64_t solidRevision_;
+};
+
+#endif
@@ -0,0 +1,34 @@
+// Loopback transport implementation
+#include "transport.h"
+
+namespace net {
+
+LoopbackTransport::LoopbackTransport(int endpoints)
+{
+    for (int i = 0; i < endpoints; ++i)
+        mailboxes_.push_back(std::make_unique<Mailbox>());
+}
+
+void LoopbackTransport::send(int from, int to, const std::vector<std::uint8_t> &bytes)
+{
+    if (to < 0 || to >= endpointCount()) return;
+    Mailbox &box = *mailboxes_[to];
+    std::lock_guard<std::mutex> lock(box.mutex);
+    box.packets.push_back(Packet{from, bytes});
+    bytesSent_ += bytes.size();
+}
+
+bool LoopbackTransport::receive(int at, std::vector<std::uint8_t> &out, int &from)
+{
+    if (at < 0 || at >= endpointCount()) return false;
+    Mailbox &box = *mailboxes_[at];
+    std::lock_guard<std::mutex> lock(box.mutex);
+    if (box.packets.empty()) return false;
+    Packet &p = box.packets.front();
+    from = p.from;
+    out.swap(p.bytes);
+    box.packets.pop_front();
+    return true;
+}
+
+} // namespace net
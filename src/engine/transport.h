@@ -0,0 +1,60 @@
+// Message transports between lock-step server and clients
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace net {
+
+// Endpoint 0 is the server; clients are 1..N
+constexpr int kServerEndpoint = 0;
+
+class Transport
+{
+public:
+    virtual ~Transport() = default;
+
+    // Queue bytes from one endpoint to another; delivery is reliable and ordered per pair
+    virtual void send(int from, int to, const std::vector<std::uint8_t> &bytes) = 0;
+
+    // Pop the next message addressed to endpoint at; out's capacity is reused
+    virtual bool receive(int at, std::vector<std::uint8_t> &out, int &from) = 0;
+};
+
+// In-process transport for tests and benchmarks: one locked mailbox per endpoint
+class LoopbackTransport : public Transport
+{
+public:
+    explicit LoopbackTransport(int endpoints);
+
+    void send(int from, int to, const std::vector<std::uint8_t> &bytes) override;
+    bool receive(int at, std::vector<std::uint8_t> &out, int &from) override;
+
+    int endpointCount() const { return static_cast<int>(mailboxes_.size()); }
+    std::uint64_t bytesSent() const { return bytesSent_.load(); }
+
+private:
+    struct Packet
+    {
+        int from;
+        std::vector<std::uint8_t> bytes;
+    };
+
+    struct Mailbox
+    {
+        std::mutex mutex;
+        std::deque<Packet> packets;
+    };
+
+    std::vector<std::unique_ptr<Mailbox>> mailboxes_;
+    std::atomic<std::uint64_t> bytesSent_{0};
+};
+
+} // namespace net
+
+#endif
@@ -0,0 +1,104 @@
+// Thread pool shared by the parallel loops
+#include "worker_pool.h"
+
+#include <algorithm>
+
+namespace {
+
+// Set on pool workers for good and on a caller while it works on its own batch
+thread_local bool tInBatch = false;
+
+} // namespace
+
+WorkerPool::WorkerPool(int threads)
+{
+    if (threads <= 0)
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    workers_.reserve(static_cast<std::size_t>(threads - 1));
+    for (int i = 1; i < threads; ++i)
+        workers_.emplace_back(&WorkerPool::workerLoop, this, i - 1);
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread &t : workers_)
+        t.join();
+}
+
+WorkerPool &WorkerPool::shared()
+{
+    static WorkerPool pool;
+    return pool;
+}
+
+void WorkerPool::run(std::size_t count, Task task, void *context, int maxThreads)
+{
+    if (count == 0) return;
+    std::size_t threads = static_cast<std::size_t>(maxThreads > 0 ? std::min(maxThreads, threadCount()) : threadCount());
+    threads = std::min(threads, count);
+    // Waking workers for one item, or from a thread that is already a worker, only adds latency
+    if (threads <= 1 || tInBatch)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            task(context, i);
+        return;
+    }
+
+    std::lock_guard<std::mutex> batch(batchMutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = task;
+        context_ = context;
+        count_ = count;
+        next_.store(0, std::memory_order_relaxed);
+        active_ = static_cast<int>(threads) - 1;
+        busy_ = active_;
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    tInBatch = true;
+    drain();
+    tInBatch = false;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return busy_ == 0; });
+    task_ = nullptr;
+    context_ = nullptr;
+}
+
+void WorkerPool::workerLoop(int index)
+{
+    tInBatch = true;
+    std::uint64_t seen = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+            if (stopping_) return;
+            seen = generation_;
+            if (index >= active_) continue;
+        }
+
+        drain();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--busy_ == 0) done_.notify_one();
+    }
+}
+
+void WorkerPool::drain()
+{
+    for (;;)
+    {
+        const std::size_t i = next_.fetch_add(1, std::memory_order_relaxed);
+        if (i >= count_) return;
+        task_(context_, i);
+    }
+}
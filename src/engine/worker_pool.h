@@ -0,0 +1,62 @@
+// Persistent worker threads for the engine's parallel loops
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Workers are started once and park between batches. A batch hands out indices through an atomic
+// cursor, one at a time, so uneven items balance themselves. Batches started from different
+// threads take turns; a batch started from inside a batch (of any pool) runs inline on its thread.
+class WorkerPool
+{
+public:
+    using Task = void (*)(void *context, std::size_t index);
+
+    // threads <= 0 uses every hardware thread; the calling thread works too
+    explicit WorkerPool(int threads = 0);
+    ~WorkerPool();
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    // Call task(context, i) for every i in [0, count) on at most maxThreads threads (<= 0: all of
+    // them); returns when every call is done
+    void run(std::size_t count, Task task, void *context, int maxThreads = 0);
+
+    template <typename Fn>
+    void forEach(std::size_t count, Fn &fn, int maxThreads = 0)
+    {
+        run(count, [](void *context, std::size_t i) { (*static_cast<Fn *>(context))(i); }, &fn, maxThreads);
+    }
+
+    int threadCount() const { return static_cast<int>(workers_.size()) + 1; }
+
+    // One pool for the whole process, sized to the hardware
+    static WorkerPool &shared();
+
+private:
+    void workerLoop(int index);
+    void drain();
+
+    std::vector<std::thread> workers_;
+    std::mutex batchMutex_; // one batch at a time
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::uint64_t generation_ = 0; // bumped for every batch
+    int active_ = 0;               // workers taking part in the current batch
+    int busy_ = 0;                 // of those, still inside it
+    bool stopping_ = false;
+
+    Task task_ = nullptr;
+    void *context_ = nullptr;
+    std::size_t count_ = 0;
+    std::atomic<std::size_t> next_{0};
+};
+
+#endif
@@ -0,0 +1,358 @@
+// Simulation tick for one world
+#include "world.h"
+
+#include <algorithm>
+#include <utility>
+
+World::World() : view_{0.0f, 0.0f, 0.0f, 0.0f}, metrics_{}, eventOverflows_(0), frame_(0ULL) {}
+
+World::~World() = default;
+
+// Runs over Animated entities only
+static void handleSpriteSheetAnimation(Entity &e, unsigned long long frame)
+{
+    const int frameRowCount = e.getFrameRowCount();
+    const int frameColumnCount = e.getFrameColumnCount();
+    const int animationDelay = e.getAnimationDelay();
+
+    if (frameColumnCount > 0 && animationDelay > 0 && frame % animationDelay == 0)
+    {
+        int currentFrameColumn = e.getCurrentFrameColumn();
+        int currentFrameRow = e.getCurrentFrameRow();
+
+        if (currentFrameColumn + 1 >= frameColumnCount)
+        {
+            currentFrameColumn = 0;
+            currentFrameRow++;
+            if (currentFrameRow >= frameRowCount)
+            {
+                currentFrameRow = 0;
+            }
+        }
+        else
+        {
+            currentFrameColumn++;
+        }
+
+        e.setCurrentFrameColumn(currentFrameColumn);
+        e.setCurrentFrameRow(currentFrameRow);
+    }
+}
+
+// Runs over Movable|PathFollower entities that are not Controllable; steps is how many
+// base ticks this update covers (ticks since the entity last stepped)
+static void handleAutoMovingEntityUpdate(Entity &e, int steps)
+{
+    int updatesRemaining = e.getPathVectorUpdatesRemaining();
+    if (updatesRemaining <= 0)
+    {
+        int nextIndex = e.getNextPathVectorIndex();
+        const std::vector<Entity::PathVector> &pathVectors = e.getPathVectors();
+        const Entity::PathVector &pv = pathVectors[nextIndex];
+        e.setVelocityX(pv.vx);
+        e.setVelocityY(pv.vy);
+        e.setNextPathVectorIndex((nextIndex + 1) % pathVectors.size());
+        e.setPathVectorUpdatesRemaining(pv.updates);
+    }
+    else
+    {
+        e.setPathVectorUpdatesRemaining(updatesRemaining - steps);
+    }
+}
+
+void World::step()
+{
+    ++frame_;
+    const unsigned long long frame = frame_;
+    frameArena_.reset(); // scratch from the previous tick is dead
+
+    // Stage times: a clock read between stages, written into the record, nothing else
+    const std::uint64_t allocationsBefore = mem::allocationCount();
+    const std::uint64_t startNS = metrics::nowNS();
+    std::uint64_t stageStartNS = startNS;
+    metrics_ = metrics::Frame{};
+    metrics_.tick = frame;
+    auto endStage = [&](metrics::Stage stage) {
+        const std::uint64_t now = metrics::nowNS();
+        metrics_.stageNS[stage] = static_cast<std::uint32_t>(now - stageStartNS);
+        stageStartNS = now;
+    };
+
+    archetypes_.sync(entities_);
+
+    if (controls_.isPaused())
+    {
+        finishMetrics(startNS, allocationsBefore);
+        return;
+    }
+
+    // Re-tier periodically; culling flips the Culled component, so sync the tables after
+    if (lodConfig_.reassignInterval > 0 && frame % static_cast<unsigned long long>(lodConfig_.reassignInterval) == 1)
+    {
+        lod::assignTiers(entities_, controls_.getControlledEntity(), view_, lodConfig_);
+        archetypes_.sync(entities_);
+    }
+    endStage(metrics::StageLod);
+
+    // Each system walks only the archetype tables carrying its components
+    // Off-screen entities keep simulating but don't animate
+    archetypes_.forEach(entities_, ecs::Animated, ecs::Disabled | ecs::Culled, [frame](Entity &e) {
+        handleSpriteSheetAnimation(e, frame);
+    });
+
+    // Entities with a tick divisor N (fixed or from their LOD tier) step on every Nth tick,
+    // staggered by index. A step covers the ticks since the entity last stepped, at most N (paused
+    // ticks are not made up): right after the LOD pass changes N that is not N itself, and
+    // integrating N ticks would gain or lose time. A new N only applies from the next step on, so
+    // the ticks since the last step never exceed the N they are clamped to.
+    const sim::Real dt = physics_.getDeltaTime();
+    auto dueThisTick = [this, frame](const Entity &e) {
+        const int divisor = e.getTickDivisor();
+        return divisor == 1 || (frame + static_cast<unsigned long long>(&e - entities_.data())) % divisor == 0;
+    };
+    auto stepSpan = [frame](const Entity &e) {
+        const unsigned long long last = e.getLastStepTick();
+        const unsigned long long since = frame > last ? frame - last : 1ULL;
+        return static_cast<int>(std::min<unsigned long long>(since, static_cast<unsigned long long>(e.getTickDivisor())));
+    };
+
+    archetypes_.forEach(entities_, ecs::Movable | ecs::PathFollower, ecs::Controllable | ecs::Disabled | ecs::Navigator, [&](Entity &e) {
+        if (dueThisTick(e))
+            handleAutoMovingEntityUpdate(e, stepSpan(e));
+    });
+
+    // Navigators look up the shared flow field instead; behaviours below can still override them
+    const Entity *controlled = controls_.getControlledEntity();
+    navigation_.update(entities_, archetypes_, terrain_.get(), controlled ? static_cast<int>(controlled - entities_.data()) : -1, frame);
+
+    // Scripts whose wait ended pick up where they left off; sleeping ones cost nothing
+    scripts_.run(entities_, frame, dt);
+
+    // Custom per-entity logic: one batch per behaviour id, so each callback target runs back to back
+    behaviours_.build(entities_, frameArena_);
+    behaviours_.run();
+    endStage(metrics::StageSystems);
+
+    // Broadphase: refit proxies, grow each due mover's proxy over its predicted path, then find
+    // every candidate pair for the tick in one pass instead of probing the world per entity.
+    // A rider's path also includes the displacement its support is about to carry it by.
+    // Movers go in entity-index order, not table order: collision results depend on who moves
+    // first, and table rows follow the history of component changes, which a restored state
+    // doesn't carry.
+    movers_.clear();
+    archetypes_.forEach(entities_, ecs::Movable, ecs::Disabled, [&](Entity &e) {
+        if (dueThisTick(e)) movers_.push_back(static_cast<std::uint32_t>(&e - entities_.data()));
+    });
+    std::sort(movers_.begin(), movers_.end());
+    colliders_.sync(entities_);
+    motion_.assign(entities_.size(), Physics::Vector{});
+    for (std::uint32_t index : movers_)
+    {
+        Entity &e = entities_[index];
+        const std::pair<Physics::Vector, Physics::Vector> predicted = physics_.applyPhysics(e, dt * stepSpan(e));
+        motion_[index] = Physics::Vector{predicted.first.first - e.getX(), predicted.first.second - e.getY()};
+    }
+    for (std::uint32_t index : movers_)
+    {
+        const Entity &e = entities_[index];
+        sim::Real dx = motion_[index].first;
+        sim::Real dy = motion_[index].second;
+        const int support = e.getSupport();
+        if (support >= 0 && static_cast<std::size_t>(support) < motion_.size())
+        {
+            dx += motion_[support].first;
+            dy += motion_[support].second;
+        }
+        colliders_.sweep(index, e.getX() + dx, e.getY() + dy);
+    }
+    colliders_.findPairs();
+    // A step probes both axes (or rests on its support instead of the second probe), and a rider
+    // is stepped twice: once carried by its support, then on its own. That is at most four probes
+    // and two resting checks per mover. A probe posts one contact per candidate and at most one
+    // landing and one hit; a resting check one contact and one landing. Sized for that, the
+    // queues only fill if a handler posts more, which handleEvents reports.
+    const std::size_t movers = archetypes_.count(ecs::Movable, ecs::Disabled);
+    events_.reserve<events::Contact>(4 * colliders_.pairCount() + 2 * movers);
+    events_.reserve<events::Landed>(4 * movers);
+    events_.reserve<events::PlayerHit>(4 * movers);
+    endStage(metrics::StageBroadphase);
+
+    // Apply physics (velocity, acceleration, collisions); static entities never move.
+    // Movers update their collider box as they go so later movers see the new position.
+    // Riders go after everything else so their supports have already moved this tick.
+    auto stepMover = [&](Entity &e) {
+        const int span = stepSpan(e);
+        e.beginStep(frame, span);
+        carry_with_support(*this, e, frame);
+        std::pair<Physics::Vector, Physics::Vector> targetVectors = physics_.applyPhysics(e, dt * span);
+
+        handle_collision(*this, e, targetVectors.first.first, targetVectors.first.second, targetVectors.second.first, targetVectors.second.second);
+        colliders_.update(static_cast<std::uint32_t>(&e - entities_.data()), e);
+    };
+    riders_.clear();
+    for (std::uint32_t index : movers_)
+    {
+        if (entities_[index].getSupport() >= 0)
+            riders_.push_back(index);
+        else
+            stepMover(entities_[index]);
+    }
+    for (std::uint32_t index : riders_)
+        stepMover(entities_[index]);
+    handleEvents();
+    endStage(metrics::StageMovers);
+
+    // Triggers never block; they only report who is inside them after everything moved
+    colliders_.collectTriggerContacts();
+    endStage(metrics::StageTriggers);
+    queries_.build(colliders_, terrain_.get(), frameArena_);
+    endStage(metrics::StageQueries);
+
+    // Particles start from where their emitters ended up
+    particles_.update(entities_, sim::toFloat(dt), sim::toFloat(physics_.getGravity()));
+    endStage(metrics::StageParticles);
+
+    finishMetrics(startNS, allocationsBefore);
+}
+
+// Apply what collision reported this tick. Nothing carries over to the next tick, so saved
+// states never need the queues. Each handler only touches the entity named in its event.
+void World::handleEvents()
+{
+    // On-collision callbacks of the entities that were touched
+    events_.drain<events::Contact>([this](const events::Contact &c) {
+        Entity &e = entities_[c.entity];
+        behaviour::invoke(e.getBehaviour(), e);
+        scripts_.notifyContact(c.entity, c.mover);
+        scripts_.notifyContact(c.mover, c.entity);
+    });
+    events_.drain<events::Landed>([this](const events::Landed &l) {
+        entities_[l.entity].setJumping(false);
+    });
+    // Touching an enemy respawns the player; its collider follows so triggers and queries see it
+    events_.drain<events::PlayerHit>([this](const events::PlayerHit &h) {
+        scripts_.notifyContact(h.enemy, h.entity);
+        Entity &e = entities_[h.entity];
+        e.setX(500);
+        e.setY(-100);
+        e.setVelocityX(0);
+        e.setVelocityY(0);
+        e.setSupport(-1);
+        colliders_.update(h.entity, e);
+    });
+
+    const std::uint64_t overflows = events_.overflows();
+    if (overflows != eventOverflows_)
+    {
+        SDL_Log("Tick %llu: %llu gameplay events dropped on full queues", frame_,
+                static_cast<unsigned long long>(overflows - eventOverflows_));
+        eventOverflows_ = overflows;
+    }
+}
+
+void World::finishMetrics(std::uint64_t startNS, std::uint64_t allocationsBefore)
+{
+    metrics_.entities = static_cast<std::uint32_t>(entities_.size());
+    metrics_.movable = static_cast<std::uint32_t>(archetypes_.count(ecs::Movable, ecs::Disabled));
+    metrics_.controllable = static_cast<std::uint32_t>(archetypes_.count(ecs::Controllable, ecs::Disabled));
+    metrics_.collidable = static_cast<std::uint32_t>(archetypes_.count(ecs::Collidable, ecs::Disabled));
+    metrics_.triggers = static_cast<std::uint32_t>(archetypes_.count(ecs::Trigger, ecs::Disabled));
+    metrics_.culled = static_cast<std::uint32_t>(archetypes_.count(ecs::Culled, ecs::Disabled));
+    metrics_.disabled = static_cast<std::uint32_t>(archetypes_.count(ecs::Disabled, 0));
+    metrics_.collisionPairs = static_cast<std::uint32_t>(colliders_.pairCount());
+    metrics_.particles = static_cast<std::uint32_t>(particles_.size());
+    metrics_.allocations = static_cast<std::uint32_t>(mem::allocationCount() - allocationsBefore);
+    metrics_.arenaBytes = static_cast<std::uint32_t>(frameArena_.used());
+    const std::uint64_t now = metrics::nowNS();
+    metrics_.stepNS = static_cast<std::uint32_t>(now - startNS);
+    metrics_.timeNS = now;
+}
+
+void World::saveState(std::vector<Entity::SimState> &out, unsigned long long &tick) const
+{
+    out.resize(entities_.size());
+    for (std::size_t i = 0; i < entities_.size(); ++i)
+    {
+        out[i] = entities_[i].saveState();
+    }
+    tick = frame_;
+}
+
+void World::loadState(const std::vector<Entity::SimState> &states, unsigned long long tick)
+{
+    const std::size_t n = states.size() < entities_.size() ? states.size() : entities_.size();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        entities_[i].loadState(states[i]);
+    }
+    frame_ = tick;
+    // Restored component bits may differ from the live ones
+    archetypes_.sync(entities_);
+    navigation_.restore(entities_, terrain_.get(), tick);
+}
+
+void World::reset()
+{
+    for (auto &e : entities_)
+    {
+        if (SDL_Texture *tex = e.getTexture())
+        {
+            SDL_DestroyTexture(tex);
+        }
+    }
+    entities_.clear();
+    cold_.clear();
+    archetypes_.clear();
+    colliders_.clear();
+    terrain_.reset();
+    frameArena_.reset();
+    queries_.build(colliders_, nullptr, frameArena_);
+    particles_.clear();
+    navigation_.clear();
+    events_.clear();
+    scripts_.clear();
+    controls_ = input_handler::Controls(); // drop pointers into the old entities
+    frame_ = 0ULL;
+}
+
+void World::releaseTextures()
+{
+    if (terrain_)
+    {
+        terrain_->releaseTextures();
+    }
+
+    for (auto &e : entities_)
+    {
+        if (SDL_Texture *tex = e.getTexture())
+        {
+            SDL_DestroyTexture(tex);
+            e.setTexture(nullptr); // cleanup() runs again from ~Engine
+        }
+    }
+}
+
+TileLayer *World::createTerrain(int tileWidth, int tileHeight, int columns, int rows, float originX, float originY)
+{
+    terrain_ = std::make_unique<TileLayer>(tileWidth, tileHeight, columns, rows, originX, originY);
+    return terrain_.get();
+}
+
+void World::setViewSize(int width, int height)
+{
+    view_ = SDL_FRect{0.0f, 0.0f, static_cast<float>(width), static_cast<float>(height)};
+}
+
+Entity *World::addEntity(const Entity &entity)
+{
+    // Growing the list moves every entity; the controlled one is followed by index
+    const Entity *controlled = controls_.getControlledEntity();
+    const std::size_t controlledIndex = controlled ? static_cast<std::size_t>(controlled - entities_.data()) : 0;
+    cold_.push_back(*entity.cold_);
+    entities_.push_back(Entity(entity, &cold_.back(), false));
+    if (controlled) controls_.setControlledEntity(&entities_[controlledIndex]);
+    // Its first step covers the ticks since it was added, not a whole divisor's worth
+    entities_.back().beginStep(frame_, 1);
+    archetypes_.append(entities_);
+    return &entities_.back();
+}
@@ -0,0 +1,123 @@
+// One self-contained simulation: entities, physics settings, input state and per-tick systems
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <SDL3/SDL.h>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "entity.h"
+#include "archetype.h"
+#include "tilemap.h"
+#include "lod.h"
+#include "collision.h"
+#include "spatial_query.h"
+#include "physics.h"
+#include "frame_arena.h"
+#include "particles.h"
+#include "metrics.h"
+#include "navigation.h"
+#include "events.h"
+#include "script.h"
+#include "../input_handler.h"
+
+// Owns everything a tick reads or writes, so any number of worlds can live in one process and
+// step on different threads. Nothing here touches SDL video or the keyboard; the windowed Engine
+// wraps one World and adds rendering around it.
+class World
+{
+public:
+    World();
+    ~World();
+    World(const World &) = delete;
+    World &operator=(const World &) = delete;
+
+    // Advance the simulation by exactly one tick on the calling thread
+    void step();
+
+    // Copy / restore every entity's simulation state and the tick counter (rollback, replays).
+    // Terrain and entity definitions (textures, paths, callbacks) are not part of the state.
+    void saveState(std::vector<Entity::SimState> &out, unsigned long long &tick) const;
+    void loadState(const std::vector<Entity::SimState> &states, unsigned long long tick);
+
+    // Remove all entities and terrain and restart the tick count
+    void reset();
+    // Destroy entity and terrain textures (renderer teardown); the entities stay
+    void releaseTextures();
+
+    Entity *addEntity(const Entity &entity);
+    Entity *getEntity(std::size_t index) { return index < entities_.size() ? &entities_[index] : nullptr; }
+    const std::vector<Entity> &getEntities() const { return entities_; }
+
+    // Create (or replace) the static terrain layer; tiles are added through the returned layer
+    TileLayer *createTerrain(int tileWidth, int tileHeight, int columns, int rows, float originX, float originY);
+    TileLayer *getTerrain() const { return terrain_.get(); }
+
+    // Distance tiers for reduced update rates, measured against a view of the given size
+    void setLodConfig(const lod::Config &config) { lodConfig_ = config; }
+    void setViewSize(int width, int height);
+
+    Physics &getPhysics() { return physics_; }
+    const Physics &getPhysics() const { return physics_; }
+    // Cosmetic effects stepped at the end of every tick; set a capacity before emitting
+    fx::ParticleSystem &getParticles() { return particles_; }
+    const fx::ParticleSystem &getParticles() const { return particles_; }
+    // Flow-field steering for Navigator entities; configure a grid to turn it on
+    nav::Navigation &getNavigation() { return navigation_; }
+    const nav::Navigation &getNavigation() const { return navigation_; }
+    // Coroutine scripts, resumed after navigation and before behaviours each tick
+    script::Scheduler &getScripts() { return scripts_; }
+    const script::Scheduler &getScripts() const { return scripts_; }
+    // Gameplay events posted during the movers stage (any thread) and handled before triggers
+    events::GameplayBus &getEvents() { return events_; }
+    input_handler::Controls &getControls() { return controls_; }
+    const input_handler::Controls &getControls() const { return controls_; }
+    unsigned long long getTick() const { return frame_; }
+
+    // Archetype tables for systems that only need entities with given components
+    const ecs::ArchetypeRegistry &getArchetypes() const { return archetypes_; }
+    // Colliders as of the current physics pass; query with a layer mask
+    const collision::ColliderSet &getColliders() const { return colliders_; }
+    // Trigger overlaps found at the end of the last tick
+    const std::vector<collision::TriggerContact> &getTriggerContacts() const { return colliders_.getTriggerContacts(); }
+    // Ray casts, box overlaps and nearest-entity queries against the world as of the last tick.
+    // Safe to query from several threads between ticks.
+    const collision::SpatialGrid &getQueries() const { return queries_; }
+    // Per-tick scratch; anything allocated here is gone at the next step()
+    mem::FrameArena &getFrameArena() { return frameArena_; }
+    // Stage times and counters of the last step(); StageInput, renderNS and drawCalls are left
+    // for the caller to fill in
+    const metrics::Frame &getFrameMetrics() const { return metrics_; }
+    // Narrow-phase collision tests, counted by the collision pass
+    void countProbes(std::uint32_t probes) { metrics_.collisionProbes += probes; }
+
+private:
+    void handleEvents();
+    void finishMetrics(std::uint64_t startNS, std::uint64_t allocationsBefore);
+
+    std::vector<Entity> entities_;
+    std::deque<Entity::Cold> cold_;        // Side table: each entity's cold row, same index (rows never move)
+    ecs::ArchetypeRegistry archetypes_;    // Entities grouped by role signature
+    std::unique_ptr<TileLayer> terrain_;   // Static geometry, drawn and collided as merged tiles
+    collision::ColliderSet colliders_;     // Static and dynamic AABB trees with layer/mask bits
+    collision::SpatialGrid queries_;       // End-of-tick world for ray/box/nearest queries
+    behaviour::Dispatcher behaviours_;     // Entities grouped by behaviour for batched updates
+    std::vector<Physics::Vector> motion_;  // Predicted displacement of each due mover this tick
+    std::vector<std::uint32_t> movers_;    // Movers due this tick, by entity index
+    std::vector<std::uint32_t> riders_;    // Movers stepped after their supports
+    mem::FrameArena frameArena_;           // Scratch for one tick, reset at the start of step()
+    Physics physics_;                      // Gravity and timestep
+    fx::ParticleSystem particles_;         // Dust, sparks and explosions, pooled
+    nav::Navigation navigation_;           // Shared flow field toward the player, built in the background
+    events::GameplayBus events_;           // Collision results for other entities, drained every tick
+    script::Scheduler scripts_;            // Suspended entity scripts, woken by timers, contacts and arrivals
+    input_handler::Controls controls_;     // Controlled entity, key maps, pause
+    lod::Config lodConfig_;                // Update-rate tiers by distance from the controlled entity
+    SDL_FRect view_;                       // Area used for LOD culling
+    metrics::Frame metrics_;               // Counters of the last tick
+    std::uint64_t eventOverflows_;         // events_.overflows() as last reported
+    unsigned long long frame_;
+};
+
+#endif
@@ -0,0 +1,64 @@
+// Steps independent worlds on a worker pool
+#include "world_runner.h"
+
+#include <chrono>
+#include <memory>
+
+#include "world.h"
+
+WorldRunner::WorldRunner(int threads) : pool_(threads) {}
+
+namespace {
+
+struct Batch
+{
+    const std::vector<World *> *worlds;
+    int ticks;
+};
+
+// A world runs all its ticks on one thread so its caches stay warm
+void stepWorld(void *context, std::size_t i)
+{
+    const Batch &batch = *static_cast<const Batch *>(context);
+    World *world = (*batch.worlds)[i];
+    for (int t = 0; t < batch.ticks; ++t)
+        world->step();
+}
+
+} // namespace
+
+void WorldRunner::run(const std::vector<World *> &worlds, int ticks)
+{
+    if (ticks <= 0) return;
+    Batch batch{&worlds, ticks};
+    pool_.run(worlds.size(), stepWorld, &batch);
+}
+
+WorldsBenchmarkResult benchmarkWorlds(void (*populate)(World &), int worlds, int ticks, int threads)
+{
+    std::vector<std::unique_ptr<World>> owned;
+    std::vector<World *> batch;
+    owned.reserve(static_cast<std::size_t>(worlds));
+    batch.reserve(static_cast<std::size_t>(worlds));
+    for (int i = 0; i < worlds; ++i)
+    {
+        owned.push_back(std::make_unique<World>());
+        populate(*owned.back());
+        batch.push_back(owned.back().get());
+    }
+
+    WorldRunner runner(threads);
+    runner.run(batch, 1); // warm up: first sync builds every tree and archetype table
+
+    const auto start = std::chrono::steady_clock::now();
+    runner.run(batch, ticks);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    WorldsBenchmarkResult r;
+    r.worlds = worlds;
+    r.ticks = ticks;
+    r.threads = runner.threadCount();
+    r.seconds = seconds;
+    r.worldTicksPerSecond = seconds > 0.0 ? static_cast<double>(worlds) * ticks / seconds : 0.0;
+    return r;
+}
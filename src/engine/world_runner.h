@@ -0,0 +1,42 @@
+// Steps many independent worlds across a fixed pool of threads
+#ifndef WORLD_RUNNER_H
+#define WORLD_RUNNER_H
+
+#include <vector>
+
+#include "worker_pool.h"
+
+class World;
+
+// Hands out whole worlds to a WorkerPool, so a world is only ever stepped by one thread and needs
+// no locking. Its own pool, so the thread count can be chosen; parallel queries made while
+// stepping run inline on the world's thread.
+class WorldRunner
+{
+public:
+    // threads <= 0 uses every hardware thread; the calling thread works too
+    explicit WorldRunner(int threads = 0);
+
+    // Advance every world by ticks ticks; returns when all of them are done
+    void run(const std::vector<World *> &worlds, int ticks);
+
+    int threadCount() const { return pool_.threadCount(); }
+
+private:
+    WorkerPool pool_;
+};
+
+struct WorldsBenchmarkResult
+{
+    int worlds;
+    int ticks;
+    int threads;
+    double seconds;
+    double worldTicksPerSecond;
+};
+
+// Step copies of a populated world in parallel. Every copy is rebuilt by populate(World&) so the
+// scene is owned by the benchmark; ticks is per world.
+WorldsBenchmarkResult benchmarkWorlds(void (*populate)(World &), int worlds, int ticks, int threads);
+
+#endif
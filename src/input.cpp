@@ -2,18 +2,51 @@
 #include "input.h"
 
 #include <bitset>
+#include <mutex>
 
 namespace input {
 
 static std::bitset<SDL_SCANCODE_COUNT> gPrev;
 static std::bitset<SDL_SCANCODE_COUNT> gCurr;
-static std::vector<SDL_Scancode> gDownList;
+static SDL_Scancode gDownList[SDL_SCANCODE_COUNT];
+static std::size_t gDownCount = 0;
+
+// Keyboard state latched by the event thread, consumed by the simulation thread. gDownSince
+// also remembers keys seen down at any capture since the last detect, so a tap that starts and
+// ends between two ticks still reaches the simulation as one tick down.
+static std::mutex gLatchMutex;
+static bool gLatched[SDL_SCANCODE_COUNT];
+static bool gDownSince[SDL_SCANCODE_COUNT];
+
+void capture()
+{
+    const bool* sdlState = SDL_GetKeyboardState(nullptr);
+    std::lock_guard<std::mutex> lock(gLatchMutex);
+    for (int i = 0; i < SDL_SCANCODE_COUNT; ++i) {
+        gLatched[i] = sdlState[i];
+        gDownSince[i] = gDownSince[i] || sdlState[i];
+    }
+}
+
+void keyDown(SDL_Scancode sc)
+{
+    if (sc <= SDL_SCANCODE_UNKNOWN || sc >= SDL_SCANCODE_COUNT) return;
+    std::lock_guard<std::mutex> lock(gLatchMutex);
+    gDownSince[sc] = true;
+}
 
 void detect()
 {
     gPrev = gCurr;
-    const bool* state = SDL_GetKeyboardState(nullptr);
-    gDownList.clear();
+    bool state[SDL_SCANCODE_COUNT];
+    {
+        std::lock_guard<std::mutex> lock(gLatchMutex);
+        for (int i = 0; i < SDL_SCANCODE_COUNT; ++i) {
+            state[i] = gLatched[i] || gDownSince[i];
+            gDownSince[i] = false;
+        }
+    }
+    gDownCount = 0;
     // SDL scancode space is small; iterate directly for cache-friendly update
     for (int i = 0; i < SDL_SCANCODE_COUNT; ++i) {
         bool v = state[i];
@@ -22,7 +55,7 @@ void detect()
             // SDL_Log("Key pressed: %s", (name && *name) ? name : "Unknown");
         }
         gCurr.set(i, v);
-        if (v) gDownList.push_back(static_cast<SDL_Scancode>(i));
+        if (v) gDownList[gDownCount++] = static_cast<SDL_Scancode>(i);
     }
 }
 
@@ -30,6 +63,6 @@ bool down(SDL_Scancode sc)      { return gCurr.test(static_cast<size_t>(sc)); }
 bool pressed(SDL_Scancode sc)   { size_t i = static_cast<size_t>(sc); return gCurr.test(i) && !gPrev.test(i); }
 bool released(SDL_Scancode sc)  { size_t i = static_cast<size_t>(sc); return !gCurr.test(i) && gPrev.test(i); }
 
-const std::vector<SDL_Scancode>& downKeys() { return gDownList; }
+KeyList downKeys() { return KeyList{ gDownList, gDownList + gDownCount }; }
 
 } // namespace input
@@ -2,11 +2,18 @@
 #pragma once
 
 #include <SDL3/SDL.h>
-#include <vector>
+#include <cstddef>
 
 namespace input {
 
-// Capture current keyboard state; call once per frame
+// Latch SDL's keyboard state, keeping any key seen down since the last detect(); call on the
+// thread that pumps events, after polling
+void capture();
+
+// Note a key-down event, so a press and release within one batch of events is not lost either
+void keyDown(SDL_Scancode sc);
+
+// Take the latched keyboard state as this tick's snapshot; call once per simulation tick
 void detect();
 
 // Query functions
@@ -14,7 +21,14 @@ bool down(SDL_Scancode sc);
 bool pressed(SDL_Scancode sc);
 bool released(SDL_Scancode sc);
 
-// List of keys currently down this frame (scancodes)
-const std::vector<SDL_Scancode>& downKeys();
+// View of keys currently down this frame (scancodes); valid until the next detect()
+struct KeyList {
+    const SDL_Scancode* first;
+    const SDL_Scancode* last;
+    const SDL_Scancode* begin() const { return first; }
+    const SDL_Scancode* end() const { return last; }
+    std::size_t size() const { return static_cast<std::size_t>(last - first); }
+};
+KeyList downKeys();
 
 }
\ No newline at end of file
@@ -2,123 +2,124 @@
 #include "input_handler.h"
 #include "input.h"
 
-#include <unordered_map>
-
 namespace input_handler {
 
-// Internal state
-static Entity* gControlledEntity = nullptr;
-static bool gPaused = false;
-
-// Optional scaling control
-static scaling::Controller* gScaler = nullptr;
-static SDL_Renderer* gRenderer = nullptr;
-static std::vector<Entity>* gEntities = nullptr;
-
-
-// Tunables
-static float gMoveSpeed = 300.0f;   // px/s
-static float gJumpImpulse = 800.0f; // px/s
+Controls::Controls()
+    : controlled_(nullptr),
+      paused_(false),
+      defaultMap_{ SDL_SCANCODE_W, SDL_SCANCODE_S, SDL_SCANCODE_A, SDL_SCANCODE_D, SDL_SCANCODE_SPACE },
+      moveSpeed_(300.0f),
+      jumpImpulse_(800.0f) {}
 
-void setControlledEntity(Entity* e) { gControlledEntity = e; }
-
-// Key mapping storage
-static input_handler::KeyMap gDefaultMap{ SDL_SCANCODE_W, SDL_SCANCODE_S, SDL_SCANCODE_A, SDL_SCANCODE_D, SDL_SCANCODE_SPACE };
-static std::unordered_map<const Entity*, input_handler::KeyMap> gEntityKeymaps;
-
-void setKeyMapFor(Entity* e, const input_handler::KeyMap& map) {
-    if (e) gEntityKeymaps[e] = map;
-}
-void clearKeyMapFor(Entity* e) {
-    if (e) gEntityKeymaps.erase(e);
+void Controls::setKeyMapFor(Entity* e, const input_handler::KeyMap& map) {
+    if (e) keymaps_[e] = map;
 }
-void setDefaultKeyMap(const input_handler::KeyMap& map) {
-    gDefaultMap = map;
+void Controls::clearKeyMapFor(Entity* e) {
+    if (e) keymaps_.erase(e);
 }
 
-void setScalingController(scaling::Controller* controller, SDL_Renderer* renderer, std::vector<Entity>* entities) {
-    gScaler = controller;
-    gRenderer = renderer;
-    gEntities = entities;
+const input_handler::KeyMap& Controls::keymapFor(const Entity* e) const {
+    auto it = keymaps_.find(e);
+    if (it != keymaps_.end()) return it->second;
+    return defaultMap_;
 }
 
-static const input_handler::KeyMap& keymapFor(const Entity* e) {
-    auto it = gEntityKeymaps.find(e);
-    if (it != gEntityKeymaps.end()) return it->second;
-    return gDefaultMap;
+std::uint8_t sampleButtons(const input_handler::KeyMap& km)
+{
+    std::uint8_t held = 0;
+    if (input::down(km.up))    held |= ButtonUp;
+    if (input::down(km.down))  held |= ButtonDown;
+    if (input::down(km.left))  held |= ButtonLeft;
+    if (input::down(km.right)) held |= ButtonRight;
+    if (input::down(km.jump))  held |= ButtonJump;
+    return held;
 }
 
-static void applyMovement(Entity* ent, const input_handler::KeyMap& km)
+void Controls::applyButtons(Entity* ent, std::uint8_t held, std::uint8_t pressed) const
 {
     if (!ent) return;
 
-    const bool up = input::down(km.up);
-    const bool down = input::down(km.down);
-    const bool left = input::down(km.left);
-    const bool right = input::down(km.right);
+    const bool up = (held & ButtonUp) != 0;
+    const bool down = (held & ButtonDown) != 0;
+    const bool left = (held & ButtonLeft) != 0;
+    const bool right = (held & ButtonRight) != 0;
 
     // Horizontal velocity
     float vx = 0.0f;
-    if (left && !right)  vx = -gMoveSpeed;
-    if (right && !left)  vx =  gMoveSpeed;
+    if (left && !right)  vx = -moveSpeed_;
+    if (right && !left)  vx =  moveSpeed_;
     ent->setVelocityX(vx);
 
     // Vertical for top-down; jump edge for platformer
     if (!ent->getisAffectedByGravity()) {
         float vy = 0.0f;
-        if (up && !down)    vy = -gMoveSpeed;
-        if (down && !up)    vy =  gMoveSpeed;
+        if (up && !down)    vy = -moveSpeed_;
+        if (down && !up)    vy =  moveSpeed_;
         ent->setVelocityY(vy);
     } else {
-        if (input::pressed(km.jump) && ent->isJumping() == false) {
-            ent->setVelocityY(-gJumpImpulse);
+        if ((pressed & ButtonJump) && ent->isJumping() == false) {
+            ent->setVelocityY(-jumpImpulse_);
             ent->setJumping(true);
         }
     }
 }
 
-void handleInput()
+void Controls::applyMovement(Entity* ent, const input_handler::KeyMap& km) const
+{
+    const std::uint8_t pressed = input::pressed(km.jump) ? ButtonJump : 0;
+    applyButtons(ent, sampleButtons(km), pressed);
+}
+
+void Controls::handleInput()
 {
     // Toggle pause on Escape (edge)
     if (input::pressed(SDL_SCANCODE_ESCAPE)) {
-        gPaused = !gPaused;
-        SDL_Log("%s", gPaused ? "Paused" : "Resumed");
-    }
-
-    // Toggle render scaling modes with Ctrl+N / Ctrl+M
-    const bool ctrlDown = input::down(SDL_SCANCODE_LCTRL) || input::down(SDL_SCANCODE_RCTRL);
-    if (gScaler && gRenderer && gEntities) {
-        if (ctrlDown && input::pressed(SDL_SCANCODE_N)) {
-            if (gScaler->mode != scaling::ScalingMode::ProportionalLogical) {
-                gScaler->setMode(scaling::ScalingMode::ProportionalLogical, gRenderer, *gEntities);
-                SDL_Log("Scaling mode: Proportional (logical letterbox)");
-            }
-        }
-        if (ctrlDown && input::pressed(SDL_SCANCODE_M)) {
-            if (gScaler->mode != scaling::ScalingMode::ConstantPixels) {
-                gScaler->setMode(scaling::ScalingMode::ConstantPixels, gRenderer, *gEntities);
-                SDL_Log("Scaling mode: Constant pixel size");
-            }
-        }
+        paused_ = !paused_;
+        SDL_Log("%s", paused_ ? "Paused" : "Resumed");
     }
 
     // If explicit controlled entity is set, drive it with its map.
-    if (gControlledEntity) {
-        applyMovement(gControlledEntity, keymapFor(gControlledEntity));
+    if (controlled_) {
+        applyMovement(controlled_, keymapFor(controlled_));
     }
 
     // Also support driving any additionally registered entities (e.g., second player)
-    for (auto& kv : gEntityKeymaps) {
+    for (auto& kv : keymaps_) {
         const Entity* entKey = kv.first;
-        if (entKey != gControlledEntity) {
+        if (entKey != controlled_) {
             // cast away const: our API stores const key only for map key stability
             applyMovement(const_cast<Entity*>(entKey), kv.second);
         }
     }
 }
 
-void handleEvent(const SDL_Event& e)
+// Render scaling touches the renderer, so it is toggled from events on the render thread
+static void handleScalingToggle(const SDL_KeyboardEvent& key, scaling::Controller& scaler, SDL_Renderer* renderer,
+                                const render::Snapshot& snapshot)
 {
+    const bool ctrlDown = (key.mod & SDL_KMOD_CTRL) != 0;
+    if (!ctrlDown || key.repeat || !renderer) return;
+
+    // Toggle render scaling modes with Ctrl+N / Ctrl+M
+    if (key.scancode == SDL_SCANCODE_N) {
+        if (scaler.mode != scaling::ScalingMode::ProportionalLogical) {
+            scaler.setMode(scaling::ScalingMode::ProportionalLogical, renderer, snapshot);
+            SDL_Log("Scaling mode: Proportional (logical letterbox)");
+        }
+    }
+    if (key.scancode == SDL_SCANCODE_M) {
+        if (scaler.mode != scaling::ScalingMode::ConstantPixels) {
+            scaler.setMode(scaling::ScalingMode::ConstantPixels, renderer, snapshot);
+            SDL_Log("Scaling mode: Constant pixel size");
+        }
+    }
+}
+
+void handleEvent(const SDL_Event& e, scaling::Controller& scaler, SDL_Renderer* renderer, const render::Snapshot& snapshot)
+{
+    if (e.type == SDL_EVENT_KEY_DOWN) {
+        handleScalingToggle(e.key, scaler, renderer, snapshot);
+    }
     if (e.type == SDL_EVENT_MOUSE_BUTTON_DOWN) {
         float mx = 0.0f, my = 0.0f;
         SDL_GetMouseState(&mx, &my);
@@ -132,6 +133,4 @@ void handleEvent(const SDL_Event& e)
     }
 }
 
-bool isPaused() { return gPaused; }
-
 }
@@ -2,6 +2,9 @@
 #pragma once
 
 #include <SDL3/SDL.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
 #include "engine/entity.h"
 #include "engine/scaling.h"
 
@@ -16,25 +19,59 @@ struct KeyMap {
     SDL_Scancode jump;
 };
 
-void setControlledEntity(Entity* e);
+// Movement intent as button bits; lets inputs that don't come from the local keyboard
+// (network, replays) drive entities through the same rules
+enum Button : std::uint8_t {
+    ButtonUp = 1u << 0,
+    ButtonDown = 1u << 1,
+    ButtonLeft = 1u << 2,
+    ButtonRight = 1u << 3,
+    ButtonJump = 1u << 4,
+};
+
+// Buttons held this frame under a key map (from input::state)
+std::uint8_t sampleButtons(const KeyMap& map);
+
+// Gameplay input state of one world: which entities the keyboard drives, their key maps,
+// movement tunables and pause. The keyboard itself (input::state) is shared by the process.
+class Controls {
+public:
+    Controls();
+
+    void setControlledEntity(Entity* e) { controlled_ = e; }
+    Entity* getControlledEntity() const { return controlled_; }
 
-// Configure keys for a specific entity (overrides defaults)
-void setKeyMapFor(Entity* e, const KeyMap& map);
-void clearKeyMapFor(Entity* e);
+    // Configure keys for a specific entity (overrides defaults)
+    void setKeyMapFor(Entity* e, const KeyMap& map);
+    void clearKeyMapFor(Entity* e);
 
-// Set global default mapping used when an entity has no override
-void setDefaultKeyMap(const KeyMap& map);
+    // Set the default mapping used when an entity has no override
+    void setDefaultKeyMap(const KeyMap& map) { defaultMap_ = map; }
 
-// Performs movement/jump/pause handling based on input::state
-void handleInput();
+    // Apply held buttons to an entity; pressed holds the buttons that went down this tick
+    void applyButtons(Entity* e, std::uint8_t held, std::uint8_t pressed) const;
 
-// Pass-through for discrete SDL events (mouse etc.)
-void handleEvent(const SDL_Event& e);
+    // Performs movement/jump/pause handling based on input::state (simulation thread)
+    void handleInput();
 
-// Paused state (toggled with Escape)
-bool isPaused();
+    // Paused state (toggled with Escape)
+    bool isPaused() const { return paused_; }
+    void setPaused(bool paused) { paused_ = paused; }
+
+private:
+    const KeyMap& keymapFor(const Entity* e) const;
+    void applyMovement(Entity* e, const KeyMap& map) const;
+
+    Entity* controlled_;
+    bool paused_;
+    KeyMap defaultMap_;
+    std::unordered_map<const Entity*, KeyMap> keymaps_;
+    float moveSpeed_;   // px/s
+    float jumpImpulse_; // px/s
+};
 
-// Optional: register scaling controller for render-scale toggles
-void setScalingController(scaling::Controller* controller, SDL_Renderer* renderer, std::vector<Entity>* entities);
+// Pass-through for discrete SDL events: mouse, render-scale toggles (event/render thread). Scale
+// toggles re-filter the textures of snapshot, never the live entities the simulation is stepping.
+void handleEvent(const SDL_Event& e, scaling::Controller& scaler, SDL_Renderer* renderer, const render::Snapshot& snapshot);
 
 }
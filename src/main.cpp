@@ -1,7 +1,24 @@
 // Use Engine and Entity to create a window with three entities
 #include "engine/engine.h"
+#include "engine/asset_cache.h"
 #include "engine/entity.h"
-#include <SDL3_image/SDL_image.h>
+#include "engine/frame_arena.h"
+#include "engine/golden.h"
+#include "engine/jobs.h"
+#include "engine/lockstep.h"
+#include "engine/lod.h"
+#include "engine/metrics.h"
+#include "engine/navigation.h"
+#include "engine/particles.h"
+#include "engine/rollback.h"
+#include "engine/script.h"
+#include "engine/world_runner.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <thread>
 #include "input_handler.h"
 
 const int gameWindowWidth = 1200;
@@ -12,24 +29,87 @@ const static char* gameWindowTitle = "Feeling Loopy";
 Engine engine;
 SDL_Renderer* renderer;
 
-static SDL_Texture* loadTexture(SDL_Renderer* renderer, const char* path) {
-    SDL_Texture* tex = IMG_LoadTexture(renderer, path);
-    if (!tex) {
-        SDL_Log("Failed to load %s: %s", path, SDL_GetError());
+// Every image the game uses, decoded once at startup (see assets::ImageSet)
+static const std::vector<std::string> imagePaths = {
+    "media/wilderkin_platform_basicground_idle.png",
+    "media/cyberpunk_enemy_drone_move.png",
+    "media/darkworld_character_cainhurst_right.png",
+};
+const static char* imageCachePath = "media/images.cache";
+static assets::ImageSet images;
+
+static void loadImages(bool deferCacheWrite) {
+    assets::LoadOptions options;
+    options.deferCacheWrite = deferCacheWrite;
+    images.load(imagePaths, imageCachePath, options);
+    const assets::LoadStats& s = images.stats();
+    SDL_Log("Loaded %d images (%d cached, %d decoded, %d failed) in %.1f ms", s.cached + s.decoded, s.cached, s.decoded,
+            s.failed, s.seconds * 1e3);
+}
+
+// Loaded on first use so modes that never draw or measure sprites skip it
+static const assets::ImageSet& startupImages() {
+    if (images.images().empty()) {
+        loadImages(false);
     }
-    return tex;
+    return images;
 }
 
-void initialiseEntities() {
-    //Initialise Static Platform
-    SDL_Texture* platformTexture = loadTexture(renderer, "media/wilderkin_platform_basicground_idle.png");
-    Entity platform(std::string("Platform"), -20.0f, gameWindowHeight - 0.20f * platformTexture->h, static_cast<float>(gameWindowWidth*2.0), static_cast<float>(platformTexture->h), platformTexture, 1, 1, 0, false, false, true, [](Entity&){});
-    engine.addEntity(platform);
+// A loaded image: a texture when there is a renderer, otherwise only its pixel size (headless)
+struct Sprite {
+    SDL_Texture* texture;
+    int w;
+    int h;
+};
+
+static Sprite loadSprite(SDL_Renderer* renderer, const char* path) {
+    Sprite sprite{nullptr, 0, 0};
+    const assets::Image* image = startupImages().find(path);
+    if (!image) {
+        SDL_Log("Failed to load %s", path);
+        return sprite;
+    }
+    // Each sprite owns its texture (entities destroy theirs), so upload per call
+    if (renderer && !(sprite.texture = assets::createTexture(renderer, *image))) {
+        return sprite;
+    }
+    sprite.w = image->width;
+    sprite.h = image->height;
+    return sprite;
+}
+
+// Ground, drone and moving platforms; everything except the player
+bool initialiseWorld(World& world) {
+    //Initialise Static Ground as a terrain tile layer (drawn from cached chunks, collided as merged rects)
+    Sprite platformSprite = loadSprite(renderer, "media/wilderkin_platform_basicground_idle.png");
+    Sprite droneSprite = loadSprite(renderer, "media/cyberpunk_enemy_drone_move.png");
+    Sprite movingPlatformSprite = loadSprite(renderer, "media/wilderkin_platform_basicground_idle.png");
+    Sprite movingPlatformSprite1 = loadSprite(renderer, "media/wilderkin_platform_basicground_idle.png");
+
+    if (!platformSprite.w || !droneSprite.w || !movingPlatformSprite.w || !movingPlatformSprite1.w) {
+        if (platformSprite.texture) SDL_DestroyTexture(platformSprite.texture);
+        if (droneSprite.texture) SDL_DestroyTexture(droneSprite.texture);
+        if (movingPlatformSprite.texture) SDL_DestroyTexture(movingPlatformSprite.texture);
+        if (movingPlatformSprite1.texture) SDL_DestroyTexture(movingPlatformSprite1.texture);
+        SDL_Log("Failed to load one or more textures: %s", SDL_GetError());
+        return false;
+    }
+
+    // One texture stretched over 2400 px, as a run of cells each showing its slice of the texture
+    const int groundWidth = gameWindowWidth * 2;
+    const int groundColumns = (groundWidth + platformSprite.w - 1) / platformSprite.w;
+    TileLayer* terrain = world.createTerrain(groundWidth / groundColumns, platformSprite.h, groundColumns, 1,
+        -20.0f, gameWindowHeight - 0.20f * platformSprite.h);
+    const int groundTiles = terrain->addTileset(platformSprite.texture);
+    const float sliceWidth = static_cast<float>(platformSprite.w) / groundColumns;
+    for (int c = 0; c < groundColumns; ++c) {
+        const SDL_FRect slice{c * sliceWidth, 0.0f, sliceWidth, static_cast<float>(platformSprite.h)};
+        terrain->setTile(c, 0, groundTiles, slice, true);
+    }
 
     // Initialise Automoving entity
-    SDL_Texture* droneTexture = loadTexture(renderer, "media/cyberpunk_enemy_drone_move.png");
-    Entity drone(std::string("Drone"), 30, 30, droneTexture->w/8, droneTexture->h/8, 
-        0, 0, 0, 0, true, false, true, false, droneTexture, 8, 8, 10, 0.3, false,  [](Entity&){});
+    Entity drone(std::string("Drone"), 30, 30, droneSprite.w/8, droneSprite.h/8,
+        0, 0, 0, 0, true, false, true, false, true, droneSprite.texture, 8, 8, 10, 0.3, false,  [](Entity&){});
     // Define velocity vectors (vx, vy) with number of updates for the drone
     std::vector<Entity::PathVector> pathVectors = {
         Entity::PathVector{25.0f, 0.0f, 1000},   // move right
@@ -37,59 +117,865 @@ void initialiseEntities() {
         Entity::PathVector{25.0f, -25.0f, 700}   // move up-left diagonally
     };
     drone.setPathVectors(pathVectors);
-    engine.addEntity(drone);
+    world.addEntity(drone);
 
-    SDL_Texture* movingPlatformTexture = loadTexture(renderer, "media/wilderkin_platform_basicground_idle.png");
-    Entity movingPlatform = Entity(std::string("movingPlatform"), 10, 250, movingPlatformTexture->w, movingPlatformTexture->h, 
-        0, 0, 0, 0, true, false, false, true, movingPlatformTexture, 1, 0, 0, 0.075, false,  [](Entity&){});
+    Entity movingPlatform = Entity(std::string("movingPlatform"), 10, 250, movingPlatformSprite.w, movingPlatformSprite.h,
+        0, 0, 0, 0, true, false, false, true, true, movingPlatformSprite.texture, 1, 0, 0, 0.075, false,  [](Entity&){});
     std::vector<Entity::PathVector> pathVectorsPlatform = {
         Entity::PathVector{25.0f, 0.0f, 2000},   // move right
         Entity::PathVector{-25.0f, 0.0f, 2000},    // move left
     };
     movingPlatform.setPathVectors(pathVectorsPlatform);
-    engine.addEntity(movingPlatform);
+    world.addEntity(movingPlatform);
 
-    SDL_Texture* movingPlatformTexture1 = loadTexture(renderer, "media/wilderkin_platform_basicground_idle.png");
-    Entity movingPlatform1 = Entity(std::string("movingPlatform1"), gameWindowWidth-10, 450, movingPlatformTexture1->w, movingPlatformTexture1->h, 
-        0, 0, 0, 0, true, false, false, true, movingPlatformTexture1, 1, 0, 0, 0.075, false,  [](Entity&){});
+    Entity movingPlatform1 = Entity(std::string("movingPlatform1"), gameWindowWidth-10, 450, movingPlatformSprite1.w, movingPlatformSprite1.h,
+        0, 0, 0, 0, true, false, false, true, true, movingPlatformSprite1.texture, 1, 0, 0, 0.075, false,  [](Entity&){});
     std::vector<Entity::PathVector> pathVectorsPlatform1 = {
         Entity::PathVector{-25.0f, 0.0f, 2000},   // move right
         Entity::PathVector{25.0f, 0.0f, 2000},    // move left
     };
     movingPlatform1.setPathVectors(pathVectorsPlatform1);
-    engine.addEntity(movingPlatform1);
+    world.addEntity(movingPlatform1);
+    return true;
+}
+
+// Controllable player template; headless runs leave the texture empty
+std::optional<Entity> makePlayer() {
+    Sprite playerSprite = loadSprite(renderer, "media/darkworld_character_cainhurst_right.png");
+    if (!playerSprite.w) {
+        return std::nullopt;
+    }
+    return Entity(std::string("Player"), 2*gameWindowWidth/3, gameWindowHeight/3, playerSprite.w/4, playerSprite.h,
+        0, 0, 0, 0, true, true, false, false, true, playerSprite.texture, 4, 1, 20, 1.5, true, [](Entity&){});
+}
+
+void addDemoEmitters(World& world, const Entity& player);
+
+void initialiseEntities() {
+    World& world = engine.getWorld();
+    if (!initialiseWorld(world)) {
+        return;
+    }
 
     //Initialise Controllable Player Entity
-    SDL_Texture* playerTexture = loadTexture(renderer, "media/darkworld_character_cainhurst_right.png");
-    Entity player(std::string("Player"), 2*gameWindowWidth/3, gameWindowHeight/3, playerTexture->w/4, playerTexture->h, 
-        0, 0, 0, 0, true, true, false, false, playerTexture, 4, 1, 20, 1.5, true, [](Entity&){});
+    std::optional<Entity> player = makePlayer();
+    if (!player) {
+        SDL_Log("Failed to load one or more textures: %s", SDL_GetError());
+        return;
+    }
 
-    Entity* playerPtr = engine.addEntity(player);
-    input_handler::setControlledEntity(playerPtr);
+    Entity* playerPtr = world.addEntity(*player);
 
     //setControlledEntity(playerPtr);            // legacy keyboard input module
 
-    input_handler::setControlledEntity(playerPtr); // new input handler module
-    //input_handler::setKeyMapFor(playerPtr, input_handler::KeyMap{ SDL_SCANCODE_UP, SDL_SCANCODE_DOWN, SDL_SCANCODE_LEFT, SDL_SCANCODE_RIGHT, SDL_SCANCODE_LSHIFT });
+    world.getControls().setControlledEntity(playerPtr); // new input handler module
+    addDemoEmitters(world, *playerPtr);
+    //world.getControls().setKeyMapFor(playerPtr, input_handler::KeyMap{ SDL_SCANCODE_UP, SDL_SCANCODE_DOWN, SDL_SCANCODE_LEFT, SDL_SCANCODE_RIGHT, SDL_SCANCODE_LSHIFT });
+}
+
+// Dust kicked up at the player's feet and sparks trailing the drone (entity 0)
+void addDemoEmitters(World& world, const Entity& player) {
+    fx::ParticleSystem& particles = world.getParticles();
+    particles.setCapacity(16384);
+    fx::EmitterConfig dust;
+    dust.rate = 30.0f;
+    dust.offsetX = player.getWidth() * player.getScale() * 0.5f;
+    dust.offsetY = player.getHeight() * player.getScale();
+    dust.spread = 1.2f;
+    dust.speedMin = 10.0f;
+    dust.speedMax = 40.0f;
+    dust.lifeMin = 0.3f;
+    dust.lifeMax = 0.7f;
+    dust.size = 3.0f;
+    dust.gravityScale = 0.1f;
+    dust.color = SDL_Color{200, 180, 150, 180};
+    particles.addEmitter(static_cast<std::uint32_t>(&player - world.getEntities().data()), dust);
 
-    if (!platformTexture || !droneTexture || !playerTexture || !movingPlatformTexture) {
-        if (platformTexture) SDL_DestroyTexture(platformTexture);
-        if (droneTexture) SDL_DestroyTexture(droneTexture);
-        if (playerTexture) SDL_DestroyTexture(playerTexture);
-        if( movingPlatformTexture) SDL_DestroyTexture(movingPlatformTexture);
-        if( movingPlatformTexture) SDL_DestroyTexture(movingPlatformTexture);
-        SDL_Log("Failed to load one or more textures: %s", SDL_GetError());
+    const Entity* drone = world.getEntity(0);
+    fx::EmitterConfig sparks;
+    sparks.rate = 40.0f;
+    sparks.offsetX = drone->getWidth() * drone->getScale() * 0.5f;
+    sparks.offsetY = drone->getHeight() * drone->getScale() * 0.5f;
+    sparks.spread = 6.2831853f;
+    sparks.speedMin = 60.0f;
+    sparks.speedMax = 160.0f;
+    sparks.lifeMin = 0.2f;
+    sparks.lifeMax = 0.5f;
+    sparks.gravityScale = 0.5f;
+    sparks.color = SDL_Color{255, 220, 90, 255};
+    particles.addEmitter(0, sparks);
+}
+
+// Headless lock-step server over the loopback transport, swept over client counts.
+// Usage: main --bench-server [maxClients] [ticks]
+static int runServerBenchmark(int maxClients, int ticks) {
+    if (!engine.initHeadless(gameWindowWidth, gameWindowHeight)) {
+        return 1;
+    }
+
+    SDL_Log("clients  us/tick  bytes/tick  clients@60Hz/core  desync");
+    for (int clients = 1; clients <= maxClients; clients *= 2) {
+        engine.reset();
+        std::optional<Entity> avatar;
+        if (!initialiseWorld(engine.getWorld()) || !(avatar = makePlayer())) {
+            return 1;
+        }
+
+        const net::ServerBenchmarkResult r = net::benchmarkServer(engine.getWorld(), *avatar, clients, ticks);
+        // Linear extrapolation of how many such clients fit in one 60 Hz tick budget
+        const double perClient = r.secondsPerTick / clients;
+        const double capacity = perClient > 0.0 ? (1.0 / 60.0) / perClient : 0.0;
+        SDL_Log("%7d  %7.1f  %10.0f  %17.0f  %s", clients, r.secondsPerTick * 1e6, r.bytesPerTick, capacity, r.desynced ? "YES" : "no");
+    }
+
+    engine.cleanup();
+    return 0;
+}
+
+// Rollback resimulation throughput with every frame rewinding the full prediction window.
+// Usage: main --bench-rollback [players] [renderFrames]
+static int runRollbackBenchmark(int players, int renderFrames) {
+    if (!engine.initHeadless(gameWindowWidth, gameWindowHeight)) {
+        return 1;
+    }
+
+    std::optional<Entity> avatar;
+    if (!initialiseWorld(engine.getWorld()) || !(avatar = makePlayer())) {
+        return 1;
+    }
+
+    const net::RollbackBenchmarkResult r = net::benchmarkRollback(engine.getWorld(), *avatar, players, renderFrames);
+    SDL_Log("players %d: %llu resimulated ticks, %.1f ticks/ms", r.players, static_cast<unsigned long long>(r.frames), r.framesPerMs);
+
+    engine.cleanup();
+    return 0;
+}
+
+// Run the simulation thread's per-tick work headless and fail if the steady state allocates.
+// Needs a build with -DFEELINGLOOPY_COUNT_ALLOCS=ON. Usage: main --check-allocs [warmupTicks] [ticks]
+static int runAllocationCheck(int warmupTicks, int ticks) {
+    if (!mem::countingAllocations()) {
+        SDL_Log("Allocation counting is not compiled in; configure with -DFEELINGLOOPY_COUNT_ALLOCS=ON");
+        return 1;
+    }
+    if (!engine.initHeadless(gameWindowWidth, gameWindowHeight)) {
+        return 1;
+    }
+
+    World& world = engine.getWorld();
+    std::optional<Entity> player;
+    if (!initialiseWorld(world) || !(player = makePlayer())) {
+        return 1;
+    }
+    world.getControls().setControlledEntity(world.addEntity(*player));
+
+    // Warm-up grows every reused buffer (and the frame arena) to its working size
+    for (int t = 0; t < warmupTicks; ++t) {
+        engine.simulateTick();
+    }
+    const std::uint64_t before = mem::allocationCount();
+    for (int t = 0; t < ticks; ++t) {
+        engine.simulateTick();
+    }
+    const std::uint64_t allocations = mem::allocationCount() - before;
+
+    const mem::FrameArena& arena = world.getFrameArena();
+    SDL_Log("%d ticks: %llu allocations; frame arena high water %zu of %zu bytes",
+            ticks, static_cast<unsigned long long>(allocations), arena.highWater(), arena.capacity());
+    engine.cleanup();
+    if (allocations != 0) {
+        SDL_Log("FAIL: the steady-state frame loop allocated");
+        return 1;
+    }
+    return 0;
+}
+
+// Button sequence of the "demo-input" scene, repeating every 600 ticks: walk right with two
+// jumps, walk back left with a jump, then stand still
+static std::uint8_t demoInput(unsigned long long tick) {
+    const unsigned long long t = tick % 600;
+    std::uint8_t held = 0;
+    if (t < 220) held |= input_handler::ButtonRight;
+    else if (t < 440) held |= input_handler::ButtonLeft;
+    if ((t >= 60 && t < 70) || (t >= 160 && t < 170) || (t >= 300 && t < 310)) held |= input_handler::ButtonJump;
+    return held;
+}
+
+struct GoldenScene;
+using PlayScene = bool (*)(const GoldenScene& scene, int ticks, golden::Trace& trace);
+
+struct GoldenScene {
+    const char* name;
+    golden::InputScript input; // the local player's buttons, or null
+    PlayScene play;            // builds a fresh world and records ticks ticks of it
+};
+
+// The demo scene as the game builds it, player included; false if its images are missing
+static bool buildDemoScene(World& world) {
+    world.setViewSize(gameWindowWidth, gameWindowHeight);
+    std::optional<Entity> player;
+    if (!initialiseWorld(world) || !(player = makePlayer())) {
+        return false;
+    }
+    Entity* playerPtr = world.addEntity(*player);
+    world.getControls().setControlledEntity(playerPtr);
+    addDemoEmitters(world, *playerPtr);
+    return true;
+}
+
+static bool playDemo(const GoldenScene& scene, int ticks, golden::Trace& trace) {
+    World world;
+    if (!buildDemoScene(world)) {
+        return false;
+    }
+    trace = golden::run(world, scene.name, ticks, scene.input);
+    return true;
+}
+
+// Tall trigger columns across the player's walk and the drone's flight, so contacts start and end
+static bool playTriggers(const GoldenScene& scene, int ticks, golden::Trace& trace) {
+    World world;
+    if (!buildDemoScene(world)) {
+        return false;
+    }
+    for (const float x : {300.0f, 560.0f, 960.0f, 1120.0f}) {
+        Entity zone(std::string("Zone"), x, 0.0f, 48.0f, static_cast<float>(gameWindowHeight), nullptr, 0, 0, 0, false, false, false, nullptr);
+        zone.setTrigger(true);
+        world.addEntity(zone);
+    }
+    trace = golden::run(world, scene.name, ticks, scene.input);
+    return true;
+}
+
+// Back and forth between left and right, pausing at each end
+static script::Task patrolScript(script::Actor self, sim::Real left, sim::Real right, int pause) {
+    for (;;) {
+        co_await self.moveTo(right, self.entity().getY(), sim::Real(80));
+        co_await self.wait(pause);
+        co_await self.moveTo(left, self.entity().getY(), sim::Real(80));
+        co_await self.wait(pause);
+    }
+}
+
+// Stands still until something bumps into it, then steps aside and comes back
+static script::Task guardScript(script::Actor self, sim::Real home, sim::Real aside) {
+    for (;;) {
+        co_await self.contact();
+        co_await self.moveTo(aside, self.entity().getY(), sim::Real(120));
+        co_await self.wait(90);
+        co_await self.moveTo(home, self.entity().getY(), sim::Real(120));
+    }
+}
+
+// Scripted fliers on patrol overhead and a guard in the player's way that steps aside when bumped
+static bool playScripts(const GoldenScene& scene, int ticks, golden::Trace& trace) {
+    World world;
+    if (!buildDemoScene(world)) {
+        return false;
+    }
+    script::Scheduler& scripts = world.getScripts();
+    for (int i = 0; i < 6; ++i) {
+        const float x = 100.0f + static_cast<float>(i) * 320.0f;
+        const float y = 120.0f + static_cast<float>(i % 3) * 40.0f;
+        world.addEntity(Entity(std::string("Patrol"), x, y, 16.0f, 16.0f, 0.0f, 0.0f, 0.0f, 0.0f, true, false, false, false, false, nullptr,
+            0, 0, 0, 1.0f, false, nullptr));
+        scripts.spawn(static_cast<std::uint32_t>(world.getEntities().size() - 1), patrolScript, sim::Real(x), sim::Real(x + 160.0f), 30 + i * 20);
+    }
+    world.addEntity(Entity(std::string("Guard"), 1000.0f, 300.0f, 40.0f, 64.0f, 0.0f, 0.0f, 0.0f, 0.0f, true, false, false, false, true, nullptr,
+        0, 0, 0, 1.0f, true, nullptr));
+    scripts.spawn(static_cast<std::uint32_t>(world.getEntities().size() - 1), guardScript, sim::Real(1000.0f), sim::Real(1240.0f));
+    trace = golden::run(world, scene.name, ticks, scene.input);
+    return true;
+}
+
+// Fliers chasing the player along a shared flow field over the demo level, built on the worker
+// thread; the ground is the obstacle
+static bool playNavigation(const GoldenScene& scene, int ticks, golden::Trace& trace) {
+    World world;
+    if (!buildDemoScene(world)) {
+        return false;
+    }
+    nav::Config config;
+    config.originX = -20.0f;
+    config.columns = 2 * gameWindowWidth / 32;
+    config.rows = gameWindowHeight / 32;
+    config.cellSize = 32.0f;
+    config.clearance = 6.0f;
+    world.getNavigation().configure(config);
+    for (int i = 0; i < 24; ++i) {
+        Entity seeker(std::string("Seeker"), 100.0f + static_cast<float>(i % 12) * 180.0f, 60.0f + static_cast<float>(i / 12) * 40.0f, 12.0f, 12.0f,
+            0.0f, 0.0f, 0.0f, 0.0f, true, false, false, false, true, nullptr, 0, 0, 0, 1.0f, false, nullptr);
+        seeker.setCollisionMask(collision::LayerAll & ~collision::LayerEnemy);
+        seeker.setNavigationSpeed(sim::Real(70 + (i % 5) * 10));
+        world.addEntity(seeker);
+    }
+    trace = golden::run(world, scene.name, ticks, scene.input);
+    return true;
+}
+
+// Avatars for the netcode scenes, in a row left of the demo player
+static std::optional<Entity> makeRemoteAvatar() {
+    std::optional<Entity> avatar = makePlayer();
+    if (avatar) {
+        avatar->setX(sim::Real(150.0f));
+    }
+    return avatar;
+}
+
+struct RollbackScene {
+    net::RollbackSession* session;
+    golden::InputScript input;
+    int players;
+    std::uint32_t delivered;
+};
+
+// Remote input lands in bursts one tick short of the prediction limit
+const std::uint32_t rollbackBurst = 7;
+
+static void advanceRollback(void* context, World&) {
+    RollbackScene& s = *static_cast<RollbackScene*>(context);
+    const std::uint32_t next = s.session->getTick() + 1;
+    s.session->addInput(0, next, s.input(next));
+    if (next % rollbackBurst == 0) {
+        for (int p = 1; p < s.players; ++p) {
+            for (std::uint32_t t = s.delivered + 1; t <= next; ++t) {
+                s.session->addInput(p, t, net::scriptedButtons(p, t));
+            }
+        }
+        s.delivered = next;
+    }
+    s.session->advance();
+    s.session->reconcile();
+}
+
+// A rollback session over the demo level: the local player follows the scene's input, three
+// remote players' input arrives late, so most ticks are predicted, rewound and resimulated
+static bool playRollback(const GoldenScene& scene, int ticks, golden::Trace& trace) {
+    World world;
+    if (!buildDemoScene(world)) {
+        return false;
+    }
+    const std::optional<Entity> avatar = makeRemoteAvatar();
+    if (!avatar) {
+        return false;
+    }
+    std::vector<std::uint32_t> players{static_cast<std::uint32_t>(world.getEntities().size() - 1)};
+    for (std::uint32_t remote : net::addAvatars(world, *avatar, 3)) {
+        players.push_back(remote);
+    }
+    net::RollbackSession session(world, players, 16, static_cast<int>(rollbackBurst) + 1);
+    RollbackScene s{&session, scene.input, static_cast<int>(players.size()), 0};
+    trace = golden::run(world, scene.name, ticks, advanceRollback, &s);
+    return true;
+}
+
+struct LockstepScene {
+    net::LockstepServer* server;
+    std::vector<net::LockstepClient>* clients;
+    std::uint32_t tick;
+    bool desynced;
+};
+
+static void advanceLockstep(void* context, World&) {
+    LockstepScene& s = *static_cast<LockstepScene*>(context);
+    ++s.tick;
+    for (std::size_t c = 0; c < s.clients->size(); ++c) {
+        (*s.clients)[c].sendInput(net::scriptedButtons(static_cast<int>(c), s.tick));
+    }
+    s.server->pump(1);
+    for (net::LockstepClient& c : *s.clients) {
+        c.poll();
+        s.desynced = s.desynced || c.isDesynced();
+    }
+}
+
+// An authoritative lock-step server over the loopback transport with four clients on scripted
+// input; a client whose replica drifts from the server fails the scene
+static bool playLockstep(const GoldenScene& scene, int ticks, golden::Trace& trace) {
+    World world;
+    if (!buildDemoScene(world)) {
+        return false;
+    }
+    const std::optional<Entity> avatar = makeRemoteAvatar();
+    if (!avatar) {
+        return false;
+    }
+    const int clients = 4;
+    net::LoopbackTransport transport(clients + 1);
+    net::LockstepServer server(world, transport);
+    std::vector<net::LockstepClient> peers;
+    peers.reserve(clients);
+    const float stepX = avatar->getWidth() * avatar->getScale() + 8.0f;
+    for (int i = 0; i < clients; ++i) {
+        Entity a = *avatar;
+        a.setX(avatar->getX() + static_cast<float>(i) * stepX);
+        peers.emplace_back(transport, server.addPlayer(a));
+    }
+    LockstepScene s{&server, &peers, 0, false};
+    trace = golden::run(world, scene.name, ticks, advanceLockstep, &s);
+    if (s.desynced) {
+        SDL_Log("%s: a client's replica desynced from the server", scene.name);
+        return false;
+    }
+    return true;
+}
+
+// The demo scene idle and played by a fixed input sequence, then the same level with each of the
+// systems that have their own way of stepping or deciding where things go
+static const GoldenScene goldenScenes[] = {
+    {"demo", nullptr, playDemo},
+    {"demo-input", demoInput, playDemo},
+    {"triggers", demoInput, playTriggers},
+    {"scripts", demoInput, playScripts},
+    {"navigation", demoInput, playNavigation},
+    {"rollback", demoInput, playRollback},
+    {"lockstep", nullptr, playLockstep},
+};
+
+// Run a scene on a freshly built world
+static bool runGoldenScene(const GoldenScene& scene, int ticks, golden::Trace& trace) {
+    return scene.play(scene, ticks, trace);
+}
+
+// Record a scene's trajectory on a known-good build, then verify later builds reproduce every
+// tick exactly (exit code 1 if not). Stage time budgets live in a file of their own: "budget"
+// writes the median of several runs times slack along with this machine's golden::referenceNS(),
+// and verify checks them as well when given that file, taking the median over the same number of
+// runs with the limits scaled to the verifying machine's reference time.
+// Usage: main --golden record <scene> <file> [ticks]
+//        main --golden verify <scene> <file> [budgetFile]
+//        main --golden budget <scene> <budgetFile> [runs] [ticks] [slack]
+static int runGolden(int argc, char** argv) {
+    const char* mode = argc > 4 ? argv[2] : "";
+    const bool recording = std::strcmp(mode, "record") == 0;
+    const bool budgeting = std::strcmp(mode, "budget") == 0;
+    if (!recording && !budgeting && std::strcmp(mode, "verify") != 0) {
+        SDL_Log("Usage: main --golden record|verify|budget <scene> <file> [...]");
+        return 2;
+    }
+    const GoldenScene* scene = nullptr;
+    for (const GoldenScene& s : goldenScenes) {
+        if (std::strcmp(s.name, argv[3]) == 0) scene = &s;
+    }
+    if (!scene) {
+        SDL_Log("Unknown scene '%s'", argv[3]);
+        return 2;
+    }
+    const std::string path = argv[4];
+
+    if (recording) {
+        golden::Trace trace;
+        if (!runGoldenScene(*scene, argc > 5 ? std::atoi(argv[5]) : 1200, trace)) {
+            return 1;
+        }
+        if (!golden::save(trace, path)) {
+            SDL_Log("Couldn't write golden file %s", path.c_str());
+            return 1;
+        }
+        SDL_Log("Recorded %s: %d ticks (%s)", scene->name, trace.ticks, trace.scalar.c_str());
+        return 0;
+    }
+
+    if (budgeting) {
+        const int runs = argc > 5 ? std::max(std::atoi(argv[5]), 1) : 5;
+        const int ticks = argc > 6 ? std::atoi(argv[6]) : 1200;
+        const double slack = argc > 7 ? std::atof(argv[7]) : 1.5;
+        std::vector<golden::Budget> measured;
+        for (int r = 0; r < runs; ++r) {
+            golden::Trace trace;
+            if (!runGoldenScene(*scene, ticks, trace)) {
+                return 1;
+            }
+            measured.push_back(trace.budget);
+        }
+        const golden::Budget median = golden::median(measured);
+        if (!golden::saveLimits(median, runs, golden::referenceNS(), path, slack)) {
+            SDL_Log("Couldn't write budget file %s", path.c_str());
+            return 1;
+        }
+        SDL_Log("Budgets for %s: median step %.1f us over %d runs", scene->name, median.stepNS / 1e3, runs);
+        return 0;
+    }
+
+    golden::Trace expected;
+    if (!golden::load(path, expected)) {
+        SDL_Log("Couldn't read golden file %s", path.c_str());
+        return 1;
+    }
+    golden::Limits limits;
+    const bool budgeted = argc > 5;
+    if (budgeted && !golden::loadLimits(argv[5], limits)) {
+        SDL_Log("Couldn't read budget file %s", argv[5]);
+        return 1;
+    }
+
+    // Every run has to reproduce the trajectory; only the budget check needs more than one
+    golden::Report report;
+    std::vector<golden::Budget> measured;
+    for (int r = 0; r < (budgeted ? limits.runs : 1) && report.trajectoryMatches; ++r) {
+        golden::Trace actual;
+        if (!runGoldenScene(*scene, expected.ticks, actual)) {
+            return 1;
+        }
+        report = golden::verify(expected, actual);
+        measured.push_back(actual.budget);
+    }
+    if (budgeted && report.trajectoryMatches) {
+        // Measured after the runs, as when recording, so the machine is equally warmed up
+        golden::Budget budget = limits.budget;
+        if (limits.referenceNS > 0) {
+            const std::uint64_t reference = golden::referenceNS();
+            const double factor = static_cast<double>(reference) / static_cast<double>(limits.referenceNS);
+            budget = golden::scaled(limits.budget, factor);
+            SDL_Log("%s: budgets scaled by %.2f (reference %.1f us here, %.1f us where recorded)", scene->name, factor,
+                    reference / 1e3, limits.referenceNS / 1e3);
+        }
+        golden::checkBudget(budget, golden::median(measured), report);
+    }
+    SDL_Log("%s: trajectory %s", scene->name, report.trajectoryMatches ? "matches" : report.trajectory.c_str());
+    for (const std::string& line : report.overBudget) {
+        SDL_Log("over budget: %s", line.c_str());
+    }
+    SDL_Log("%s", report.passed() ? "PASS" : "FAIL");
+    return report.passed() ? 0 : 1;
+}
+
+// Offscreen rendering with SDL's software renderer, so no window or GPU is needed: the demo scene
+// plus extra sprites drawn through Engine's own draw path at twice the logical size, in each
+// scaling mode, then a textured full-screen fill. Every dumpEvery-th frame can be written as BMP
+// to dumpDir for image diffs (frames are reproducible: the clock is pinned to the tick).
+// Usage: main --bench-render [frames] [extraSprites] [dumpDir] [dumpEvery]
+static int runRenderBenchmark(int frames, int extraSprites, const char* dumpDir, int dumpEvery) {
+    const int outputScale = 2;
+    if (!engine.initOffscreen(gameWindowWidth, gameWindowHeight, outputScale)) {
+        return 1;
+    }
+    renderer = engine.getRenderer();
+
+    World& world = engine.getWorld();
+    std::optional<Entity> player;
+    if (!initialiseWorld(world) || !(player = makePlayer())) {
+        return 1;
+    }
+    const std::size_t playerIndex = world.getEntities().size();
+    addDemoEmitters(world, *world.addEntity(*player));
+
+    // Decoration sharing one texture: drawn every frame, never collided with
+    const Sprite decor = loadSprite(renderer, "media/cyberpunk_enemy_drone_move.png");
+    const std::size_t firstDecor = world.getEntities().size();
+    for (int i = 0; i < extraSprites && decor.texture; ++i) {
+        Entity e(std::string("Decor"), static_cast<float>((i * 97) % gameWindowWidth), static_cast<float>((i * 61) % (gameWindowHeight - 64)),
+                 decor.w / 8.0f, decor.h / 8.0f, decor.texture, 8, 8, 0, false, false, false, [](Entity&){});
+        e.isCollidable(false);
+        world.addEntity(e);
+    }
+    // Only now: adding the decoration moves the entities
+    world.getControls().setControlledEntity(world.getEntity(playerIndex));
+    // A crowded scene, so it runs with distance tiers like a big level would
+    lod::Config lod;
+    lod.reassignInterval = 15;
+    world.setLodConfig(lod);
+
+    SDL_Surface* surface = engine.getOffscreenSurface();
+    const double outputPixels = static_cast<double>(surface->w) * surface->h;
+    struct ModeRun {
+        scaling::ScalingMode mode;
+        const char* name;
+    };
+    const ModeRun modes[] = {
+        {scaling::ScalingMode::ConstantPixels, "pixels"},
+        {scaling::ScalingMode::ProportionalLogical, "logical"},
+    };
+
+    SDL_Log("%dx%d output, %zu entities and their particles, %d frames per mode", surface->w, surface->h,
+            world.getEntities().size(), frames);
+    SDL_Log("mode      ms/frame  draws/frame  sprites/s  fill Mpix/s");
+    for (const ModeRun& m : modes) {
+        engine.setScalingMode(m.mode);
+        std::uint64_t renderNS = 0;
+        std::uint64_t draws = 0;
+        for (int f = 0; f < frames; ++f) {
+            engine.simulateTick();
+            engine.renderOffscreen(0.5);
+            renderNS += engine.getLastRenderNS();
+            draws += engine.getLastDrawCalls();
+            if (dumpDir && dumpEvery > 0 && f % dumpEvery == 0) {
+                char path[512];
+                std::snprintf(path, sizeof(path), "%s/%s-%05d.bmp", dumpDir, m.name, f);
+                if (!SDL_SaveBMP(surface, path)) {
+                    SDL_Log("Couldn't write %s: %s", path, SDL_GetError());
+                }
+            }
+        }
+
+        // Fill: the decoration texture stretched over the whole output, as the mode scales it
+        const int fills = 60;
+        const bool logical = m.mode == scaling::ScalingMode::ProportionalLogical;
+        const SDL_FRect full{0.0f, 0.0f, static_cast<float>(logical ? gameWindowWidth : surface->w),
+                             static_cast<float>(logical ? gameWindowHeight : surface->h)};
+        const std::uint64_t fillStart = metrics::nowNS();
+        for (int i = 0; i < fills && decor.texture; ++i) {
+            SDL_RenderTexture(renderer, decor.texture, nullptr, &full);
+            SDL_RenderPresent(renderer);
+        }
+        const double fillSeconds = static_cast<double>(metrics::nowNS() - fillStart) / 1e9;
+
+        const double seconds = static_cast<double>(renderNS) / 1e9;
+        SDL_Log("%-8s  %8.3f  %11.1f  %9.0f  %11.1f", m.name, seconds * 1e3 / std::max(frames, 1),
+                static_cast<double>(draws) / std::max(frames, 1), seconds > 0.0 ? static_cast<double>(draws) / seconds : 0.0,
+                fillSeconds > 0.0 ? outputPixels * fills / fillSeconds / 1e6 : 0.0);
+    }
+
+    // The decoration shares one texture; only the first entity keeps it to destroy
+    for (std::size_t i = firstDecor + 1; i < world.getEntities().size(); ++i) {
+        world.getEntity(i)->setTexture(nullptr);
+    }
+    if (world.getEntities().size() == firstDecor && decor.texture) {
+        SDL_DestroyTexture(decor.texture);
+    }
+    engine.cleanup();
+    return 0;
+}
+
+// Physics pass over many movers, current Entity layout against a hand-built replica of the
+// previous interleaved one.
+// Usage: main --bench-entities [count] [passes]
+static int runLayoutBenchmark(int count, int passes) {
+    const LayoutBenchmarkResult r = benchmarkEntityLayout(static_cast<std::size_t>(count), passes);
+    SDL_Log("%zu movers, %d passes", r.entities, r.passes);
+    SDL_Log("layout       bytes/entity  ns/entity");
+    SDL_Log("interleaved  %12zu  %9.2f", r.interleavedBytes, r.interleavedNsPerEntity);
+    SDL_Log("hot/cold     %12zu  %9.2f", r.entityBytes, r.entityNsPerEntity);
+    SDL_Log("(interleaved is a hand-built replica of the pre-split field order, not the baseline Entity)");
+    return 0;
+}
+
+// Cold start (decode everything, write the cache) against warm start (map the cache), using a
+// cache file of its own. Usage: main --bench-assets [threads]
+static int runAssetBenchmark(int threads) {
+    const std::string cachePath = std::string(imageCachePath) + ".bench";
+    std::remove(cachePath.c_str());
+    assets::LoadOptions options;
+    options.threads = threads;
+
+    SDL_Log("start  images  cached  decoded       ms");
+    for (const char* label : {"cold", "warm"}) {
+        assets::ImageSet set;
+        const bool ok = set.load(imagePaths, cachePath, options);
+        const assets::LoadStats& s = set.stats();
+        SDL_Log("%-5s  %6zu  %6d  %7d  %7.2f%s", label, set.images().size(), s.cached, s.decoded, s.seconds * 1e3, ok ? "" : "  (failures)");
+    }
+    std::remove(cachePath.c_str());
+    return 0;
+}
+
+// Particle update, snapshot capture and quad expansion for a steady population.
+// Usage: main --bench-particles [count] [ticks]
+static int runParticleBenchmark(int count, int ticks) {
+    const fx::ParticleBenchmarkResult r = fx::benchmarkParticles(static_cast<std::size_t>(count), ticks);
+    const double total = r.updateMs + r.captureMs + r.buildMs;
+    SDL_Log("%zu live particles, %d ticks, %s kernel, %llu dropped", r.live, r.ticks, fx::kernelName(),
+            static_cast<unsigned long long>(r.dropped));
+    SDL_Log("stage    ms/tick");
+    SDL_Log("update   %7.3f", r.updateMs);
+    SDL_Log("capture  %7.3f", r.captureMs);
+    SDL_Log("quads    %7.3f", r.buildMs);
+    SDL_Log("total    %7.3f  (%.0f%% of a 60 Hz tick)", total, total / (1000.0 / 60.0) * 100.0);
+    return 0;
+}
+
+// Agents chasing a moving goal through a walled arena along a shared flow field.
+// Usage: main --bench-nav [agents] [ticks]
+static int runNavigationBenchmark(int agents, int ticks) {
+    const nav::NavigationBenchmarkResult r = nav::benchmarkNavigation(agents, ticks);
+    SDL_Log("%d agents chasing one goal for %d ticks on a %d-cell grid", r.agents, r.ticks, r.cells);
+    SDL_Log("tick             %8.3f ms", r.tickMs);
+    SDL_Log("steer            %8.1f ns/agent", r.steerNsPerAgent);
+    SDL_Log("field builds     %8llu  (%.3f ms each, background; %.3f ms waited)", static_cast<unsigned long long>(r.fieldBuilds),
+            r.fieldBuildMs, r.waitMs);
+    SDL_Log("per-agent A*     %8.3f ms for one search each", r.perAgentSearchMs);
+    SDL_Log("distance to goal %8.0f -> %.0f px", r.startDistance, r.endDistance);
+    SDL_Log("same as inline builds: %s (worker), %s (time-sliced)", r.matchesForeground ? "yes" : "NO", r.matchesSliced ? "yes" : "NO");
+    return r.matchesForeground && r.matchesSliced ? 0 : 1;
+}
+
+// Patrolling actors driven by coroutine scripts vs. the same patrol as PathVector lists.
+// Usage: main --bench-scripts [actors] [ticks]
+static int runScriptBenchmark(int actors, int ticks) {
+    const script::ScriptBenchmarkResult r = script::benchmarkScripts(actors, ticks);
+    SDL_Log("%d patrolling actors for %d ticks", r.actors, r.ticks);
+    SDL_Log("tick, scripted   %8.3f ms", r.scriptTickMs);
+    SDL_Log("tick, paths      %8.3f ms", r.pathTickMs);
+    SDL_Log("scheduler        %8.1f us/tick (%.1f resumes, %.0f moving)", r.runNsPerTick / 1e3, r.resumesPerTick, r.movingPerTick);
+    SDL_Log("asleep on timers %8.1f %%", r.sleepingShare * 100.0);
+    return 0;
+}
+
+// Bursty flow-field rebuilds built the frame they arrive vs. time-sliced under a budget.
+// Usage: main --bench-jobs [frames] [budgetMs] [frameMs]
+static int runSlicingBenchmark(int frames, double budgetMs, double frameMs) {
+    const jobs::SlicingBenchmarkResult r = jobs::benchmarkTimeSlicing(frames, budgetMs, frameMs);
+    SDL_Log("%d frames, %d field rebuilds of %.3f ms, budget %.2f ms", r.frames, r.fields, r.fieldMs, budgetMs);
+    SDL_Log("added per frame   p50 ms  p99 ms  max ms");
+    SDL_Log("immediate        %7.3f %7.3f %7.3f", r.immediateP50Ms, r.immediateP99Ms, r.immediateMaxMs);
+    SDL_Log("time-sliced      %7.3f %7.3f %7.3f", r.slicedP50Ms, r.slicedP99Ms, r.slicedMaxMs);
+    SDL_Log("latency          %7.2f frames mean, %d max", r.meanLatencyFrames, r.maxLatencyFrames);
+    SDL_Log("background       %7.1f builds/frame in spare time", r.backgroundBuildsPerFrame);
+    return 0;
+}
+
+// The demo scene with an idle player, built into a world of its own (no renderer)
+static void populateHeadlessWorld(World& world) {
+    world.setViewSize(gameWindowWidth, gameWindowHeight);
+    std::optional<Entity> player;
+    if (!initialiseWorld(world) || !(player = makePlayer())) {
         return;
     }
+    world.getControls().setControlledEntity(world.addEntity(*player));
+}
+
+// Rollback resimulation must land on exactly the states of a plain run. A crowd of avatars in
+// the demo scene stands on each other, so who moves first matters, and culling runs every few
+// ticks with the view's edge through the crowd, so components flip inside the rollback window.
+// Usage: main --check-rollback [players] [ticks]
+static int runRollbackCheck(int players, int ticks) {
+    World plain;
+    World rolled;
+    lod::Config lod;
+    lod.reassignInterval = 3;
+    lod.cullMargin = 0.0f;
+    for (World* world : {&plain, &rolled}) {
+        if (!initialiseWorld(*world)) {
+            return 1;
+        }
+        world->setViewSize(gameWindowWidth, gameWindowHeight);
+        world->setLodConfig(lod);
+    }
+    const std::optional<Entity> avatar = makePlayer();
+    if (!avatar) {
+        return 1;
+    }
+
+    const net::RollbackCheckResult r = net::checkRollback(plain, rolled, *avatar, players, ticks);
+    SDL_Log("%d ticks, %d players: %llu resimulated, %d compared", r.ticks, players,
+            static_cast<unsigned long long>(r.resimulated), r.compared);
+    plain.releaseTextures();
+    rolled.releaseTextures();
+    if (r.compared == 0) {
+        SDL_Log("FAIL: the session never caught up with its input");
+        return 1;
+    }
+    if (r.firstMismatch >= 0) {
+        SDL_Log("FAIL: resimulated state differs from the plain run at tick %lld", r.firstMismatch);
+        return 1;
+    }
+    SDL_Log("PASS");
+    return 0;
+}
+
+// Many independent headless worlds stepped on a thread pool, swept over thread counts up to
+// threads (0 = every hardware thread). Usage: main --bench-worlds [worlds] [ticks] [threads]
+static int runWorldsBenchmark(int worlds, int ticks, int threads) {
+    const int maxThreads = threads > 0 ? threads : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    SDL_Log("worlds  threads  world-ticks/s  speedup");
+    double baseline = 0.0;
+    for (int t = 1; ; t = std::min(t * 2, maxThreads)) {
+        const WorldsBenchmarkResult r = benchmarkWorlds(populateHeadlessWorld, worlds, ticks, t);
+        if (t == 1) baseline = r.worldTicksPerSecond;
+        SDL_Log("%6d  %7d  %13.0f  %7.2f", r.worlds, r.threads, r.worldTicksPerSecond,
+                baseline > 0.0 ? r.worldTicksPerSecond / baseline : 0.0);
+        if (t == maxThreads) break;
+    }
+    return 0;
 }
 
-int main(int, char**) {
+int main(int argc, char** argv) {
+    if (argc > 1 && std::strcmp(argv[1], "--bench-server") == 0) {
+        const int maxClients = argc > 2 ? std::atoi(argv[2]) : 256;
+        const int ticks = argc > 3 ? std::atoi(argv[3]) : 600;
+        return runServerBenchmark(maxClients, ticks);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--bench-rollback") == 0) {
+        const int players = argc > 2 ? std::atoi(argv[2]) : 2;
+        const int renderFrames = argc > 3 ? std::atoi(argv[3]) : 600;
+        return runRollbackBenchmark(players, renderFrames);
+    }
+
+    if (argc > 1 && std::strcmp(argv[1], "--bench-entities") == 0) {
+        const int count = argc > 2 ? std::atoi(argv[2]) : 1000000;
+        const int passes = argc > 3 ? std::atoi(argv[3]) : 20;
+        return runLayoutBenchmark(count, passes);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--bench-assets") == 0) {
+        return runAssetBenchmark(argc > 2 ? std::atoi(argv[2]) : 0);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--bench-particles") == 0) {
+        const int count = argc > 2 ? std::atoi(argv[2]) : 200000;
+        const int ticks = argc > 3 ? std::atoi(argv[3]) : 600;
+        return runParticleBenchmark(count, ticks);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--bench-nav") == 0) {
+        const int agents = argc > 2 ? std::atoi(argv[2]) : 1000;
+        const int ticks = argc > 3 ? std::atoi(argv[3]) : 1200;
+        return runNavigationBenchmark(agents, ticks);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--bench-scripts") == 0) {
+        const int actors = argc > 2 ? std::atoi(argv[2]) : 20000;
+        const int ticks = argc > 3 ? std::atoi(argv[3]) : 1200;
+        return runScriptBenchmark(actors, ticks);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--bench-jobs") == 0) {
+        const int frames = argc > 2 ? std::atoi(argv[2]) : 600;
+        const double budgetMs = argc > 3 ? std::atof(argv[3]) : 1.0;
+        const double frameMs = argc > 4 ? std::atof(argv[4]) : 1000.0 / 60.0;
+        return runSlicingBenchmark(frames, budgetMs, frameMs);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--bench-worlds") == 0) {
+        const int worlds = argc > 2 ? std::atoi(argv[2]) : 256;
+        const int ticks = argc > 3 ? std::atoi(argv[3]) : 600;
+        const int threads = argc > 4 ? std::atoi(argv[4]) : 0;
+        return runWorldsBenchmark(worlds, ticks, threads);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--bench-render") == 0) {
+        const int frames = argc > 2 ? std::atoi(argv[2]) : 300;
+        const int sprites = argc > 3 ? std::atoi(argv[3]) : 2000;
+        const char* dumpDir = argc > 4 ? argv[4] : nullptr;
+        const int dumpEvery = argc > 5 ? std::atoi(argv[5]) : 60;
+        return runRenderBenchmark(frames, sprites, dumpDir, dumpEvery);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--golden") == 0) {
+        return runGolden(argc, argv);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--check-rollback") == 0) {
+        const int players = argc > 2 ? std::atoi(argv[2]) : 48;
+        const int ticks = argc > 3 ? std::atoi(argv[3]) : 1200;
+        return runRollbackCheck(players, ticks);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--check-allocs") == 0) {
+        const int warmupTicks = argc > 2 ? std::atoi(argv[2]) : 300;
+        const int ticks = argc > 3 ? std::atoi(argv[3]) : 600;
+        return runAllocationCheck(warmupTicks, ticks);
+    }
+
     if (!engine.init(gameWindowTitle, gameWindowWidth, gameWindowHeight)) {
         return 1;
     }
     renderer = engine.getRenderer();
 
+    // Per-tick counters for tools/loopy_metrics; FEELINGLOOPY_METRICS names the ring, empty turns it off
+    const char* metricsName = std::getenv("FEELINGLOOPY_METRICS");
+    const std::string ring = metricsName ? metricsName : metrics::defaultName(metrics::processId());
+    if (!ring.empty() && engine.enableMetrics(ring)) {
+        SDL_Log("Publishing metrics as '%s'", ring.c_str());
+    }
+
+    // After a fresh decode the game starts at once and writes the image cache in spare tick time.
+    // Sprites are uploaded by then, and nothing simulated depends on where the pixels live.
+    loadImages(true);
     initialiseEntities();
+    if (images.cacheWritePending()) {
+        engine.getJobs().post(jobs::Priority::Background, assets::ImageSet::writeCacheSlice, &images);
+    }
 
     engine.run();
 
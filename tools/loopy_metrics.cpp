@@ -0,0 +1,184 @@
+// Read a running game's per-tick metrics ring: print interval averages and optionally record every
+// tick to CSV. Only reads the shared memory, so it cannot slow the game down.
+//
+//   loopy_metrics <ring name | pid> [--interval ms] [--record file.csv]
+#include "../src/engine/metrics.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+namespace {
+
+bool isNumber(const char *s)
+{
+    if (!*s) return false;
+    for (; *s; ++s)
+    {
+        if (!std::isdigit(static_cast<unsigned char>(*s))) return false;
+    }
+    return true;
+}
+
+void writeCsvHeader(std::FILE *out)
+{
+    std::fprintf(out, "tick,time_ns");
+    for (int s = 0; s < metrics::StageCount; ++s)
+        std::fprintf(out, ",%s_ns", metrics::stageName(s));
+    std::fprintf(out, ",step_ns,render_ns,draw_calls,entities,movable,controllable,collidable,triggers,culled,disabled,"
+                      "collision_pairs,collision_probes,particles,allocations,arena_bytes\n");
+}
+
+void writeCsvRow(std::FILE *out, const metrics::Frame &f)
+{
+    std::fprintf(out, "%llu,%llu", static_cast<unsigned long long>(f.tick), static_cast<unsigned long long>(f.timeNS));
+    for (int s = 0; s < metrics::StageCount; ++s)
+        std::fprintf(out, ",%u", f.stageNS[s]);
+    std::fprintf(out, ",%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n", f.stepNS, f.renderNS, f.drawCalls, f.entities, f.movable, f.controllable,
+                 f.collidable, f.triggers, f.culled, f.disabled, f.collisionPairs, f.collisionProbes, f.particles, f.allocations, f.arenaBytes);
+}
+
+// Sums over one print interval
+struct Interval
+{
+    std::uint64_t frames = 0;
+    std::uint64_t stageNS[metrics::StageCount] = {};
+    std::uint64_t stepNS = 0;
+    std::uint32_t maxStepNS = 0;
+    std::uint64_t renderNS = 0;
+    std::uint64_t drawCalls = 0;
+    std::uint64_t probes = 0;
+    std::uint64_t allocations = 0;
+    metrics::Frame last{};
+
+    void add(const metrics::Frame &f)
+    {
+        ++frames;
+        for (int s = 0; s < metrics::StageCount; ++s)
+            stageNS[s] += f.stageNS[s];
+        stepNS += f.stepNS;
+        maxStepNS = std::max(maxStepNS, f.stepNS);
+        renderNS += f.renderNS;
+        drawCalls += f.drawCalls;
+        probes += f.collisionProbes;
+        allocations += f.allocations;
+        last = f;
+    }
+};
+
+void printInterval(const Interval &in, std::uint64_t dropped)
+{
+    if (in.frames == 0) return;
+    const double n = static_cast<double>(in.frames);
+    auto us = [n](std::uint64_t ns) { return static_cast<double>(ns) / n / 1000.0; };
+    std::printf("tick %llu  ticks %llu  step %.1f us (max %.1f)  render %.1f us  draws %.0f\n", static_cast<unsigned long long>(in.last.tick),
+                static_cast<unsigned long long>(in.frames), us(in.stepNS), in.maxStepNS / 1000.0, us(in.renderNS), static_cast<double>(in.drawCalls) / n);
+    std::printf("  ");
+    for (int s = 0; s < metrics::StageCount; ++s)
+        std::printf(" %s %.1f", metrics::stageName(s), us(in.stageNS[s]));
+    std::printf(" us\n");
+    const metrics::Frame &f = in.last;
+    std::printf("   entities %u (movable %u, controllable %u, collidable %u, triggers %u, culled %u, disabled %u)\n", f.entities, f.movable,
+                f.controllable, f.collidable, f.triggers, f.culled, f.disabled);
+    std::printf("   pairs %u  probes %.0f  particles %u  allocs %.1f  arena %u B", f.collisionPairs, static_cast<double>(in.probes) / n, f.particles,
+                static_cast<double>(in.allocations) / n, f.arenaBytes);
+    if (dropped > 0) std::printf("  dropped %llu", static_cast<unsigned long long>(dropped));
+    std::printf("\n");
+    std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "usage: %s <ring name | pid> [--interval ms] [--record file.csv]\n", argv[0]);
+        return 2;
+    }
+    const std::string name = isNumber(argv[1]) ? metrics::defaultName(std::strtoull(argv[1], nullptr, 10)) : argv[1];
+    int intervalMs = 1000;
+    const char *recordPath = nullptr;
+    for (int i = 2; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--interval") == 0 && i + 1 < argc)
+            intervalMs = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            recordPath = argv[++i];
+        else
+        {
+            std::fprintf(stderr, "unknown argument '%s'\n", argv[i]);
+            return 2;
+        }
+    }
+
+    metrics::Reader reader;
+    if (!reader.open(name))
+    {
+        std::fprintf(stderr, "no metrics ring named '%s' (is the game running?)\n", name.c_str());
+        return 1;
+    }
+
+    std::FILE *record = nullptr;
+    if (recordPath)
+    {
+        record = std::fopen(recordPath, "w");
+        if (!record)
+        {
+            std::fprintf(stderr, "couldn't open '%s' for writing\n", recordPath);
+            return 1;
+        }
+        writeCsvHeader(record);
+    }
+    std::printf("reading '%s' (pid %llu, %u records)\n", name.c_str(), static_cast<unsigned long long>(reader.pid()), reader.capacity());
+
+    // Start from the newest record; poll often enough that the writer rarely laps us
+    std::uint64_t next = reader.published();
+    const auto pollPeriod = std::chrono::milliseconds(std::min(intervalMs, 50));
+    auto intervalEnd = std::chrono::steady_clock::now() + std::chrono::milliseconds(intervalMs);
+    Interval interval;
+    std::uint64_t dropped = 0;
+    for (;;)
+    {
+        const bool live = reader.isLive();
+        const std::uint64_t published = reader.published();
+        if (published - next > reader.capacity())
+        {
+            dropped += published - next - reader.capacity();
+            next = published - reader.capacity();
+        }
+        metrics::Frame frame;
+        for (; next < published; ++next)
+        {
+            if (!reader.read(next, frame))
+            {
+                ++dropped; // overwritten while we copied it
+                continue;
+            }
+            interval.add(frame);
+            if (record) writeCsvRow(record, frame);
+        }
+
+        if (!live || std::chrono::steady_clock::now() >= intervalEnd)
+        {
+            printInterval(interval, dropped);
+            interval = Interval();
+            dropped = 0;
+            intervalEnd += std::chrono::milliseconds(intervalMs);
+        }
+        if (!live)
+        {
+            std::printf("writer closed the ring\n");
+            break;
+        }
+        std::this_thread::sleep_for(pollPeriod);
+    }
+
+    if (record) std::fclose(record);
+    return 0;
+}